@@ -0,0 +1,81 @@
+/**
+ * @file main.cpp
+ * @brief Accuracy of the fixed point path (Q15) of GaussianFilter compared to the float path
+ * @date 2026-10-18
+ *
+ * @details
+ * Filters the same 12 bit values once with the float path and once with the fixed point path
+ * and prints the max absolute deviation for every cached kernel size. Both paths are selected
+ * with GaussianFilter::setFixedPoint, so the runtime library does not need a comparison function.
+ */
+
+#include <Arduino.h>
+#include "SMART_WI_Libs/gaussian_filter.h"
+#include "SMART_WI_Libs/SerialMon.h"
+
+const uint8_t KERNEL_WIDTHS[] = {3, 5, 9, 15, 21, 39};
+const float SIGMA = {1.5F};
+
+GaussianFilter filter;
+int16_t input[MAX_SENSOR_ARRAY_SIZE];
+int16_t outputFloat[MAX_SENSOR_ARRAY_SIZE];
+int16_t outputQ15[MAX_SENSOR_ARRAY_SIZE];
+
+/**
+ * @brief Max absolute deviation of the fixed point path to the float path for the current kernel
+ *
+ * @return NaN if the kernel can not be represented in Q15
+ */
+float compareFixedPoint(uint8_t input_width) {
+    filter.setFixedPoint(false);
+    if (!filter.calcGausianFilter1D(input, outputFloat, input_width))
+    {
+        return NAN;
+    }
+    if (!filter.setFixedPoint(true) || !filter.calcGausianFilter1D(input, outputQ15, input_width))
+    {
+        return NAN;
+    }
+    float max_deviation = 0.0F;
+    for (uint8_t i = 0; i < input_width; i++)
+    {
+        float deviation = abs(outputFloat[i] - outputQ15[i]);
+        if (deviation > max_deviation)
+        {
+            max_deviation = deviation;
+        }
+    }
+    return max_deviation;
+}
+
+void setup() {
+    SerialMon.begin(115200);
+    delay(1000);
+
+    //Noisy 12 bit values like the ones of the RS485 sensors
+    for (uint8_t i = 0; i < MAX_SENSOR_ARRAY_SIZE; i++)
+    {
+        input[i] = 2048 + (int16_t)(1000.0F * sin(i * 0.2F)) + random(-50, 50);
+    }
+
+    for (uint8_t k = 0; k < sizeof(KERNEL_WIDTHS); k++)
+    {
+        if (!filter.getCachedKernel(SIGMA, KERNEL_WIDTHS[k]))
+        {
+            continue;
+        }
+        unsigned long start = micros();
+        float deviation = compareFixedPoint(MAX_SENSOR_ARRAY_SIZE);
+        unsigned long duration = micros() - start;
+        SerialMon.print(F("Kernel width "));
+        SerialMon.print(KERNEL_WIDTHS[k]);
+        SerialMon.print(F(": max deviation "));
+        SerialMon.print(deviation, 2);
+        SerialMon.print(F(" LSB, both paths in "));
+        SerialMon.print(duration);
+        SerialMon.println(F(" us"));
+    }
+}
+
+void loop() {
+}
@@ -0,0 +1,183 @@
+/**
+ * @file ATResponseParser.cpp
+ * @brief ATResponseParser member function definitions
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ATResponseParser.h"
+#include <stdarg.h>
+
+static bool isLineEnd(char c){
+  return c == '\0' || c == '\r' || c == '\n';
+}
+
+bool ATResponseParser::formatCommand(char *command, size_t size, const char *format, ...){
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(command, size, format, args);
+  va_end(args);
+  return length >= 0 && (size_t)length < size;
+}
+
+const char *ATResponseParser::findResult(const char *response, const char *name){
+  if (response == nullptr)
+  {
+    return nullptr;
+  }
+  const char *values = response;
+  if (name != nullptr)
+  {
+    size_t nameLength = strlen(name);
+    values = nullptr;
+    for (const char *match = strstr(response, name); match != nullptr; match = strstr(match + 1, name))
+    {
+      if (match > response && match[-1] == '+' && match[nameLength] == ':')
+      {
+        values = match + nameLength + 1;
+        break;
+      }
+    }
+    if (values == nullptr)
+    {
+      return nullptr;
+    }
+  }
+  while (*values == ' ')
+  {
+    values++;
+  }
+  return values;
+}
+
+bool ATResponseParser::getValue(const char *response, const char *name, uint8_t index, char *value, size_t size){
+  const char *position = findResult(response, name);
+  if (position == nullptr || size == 0)
+  {
+    return false;
+  }
+  for (uint8_t i = 0; ; i++)
+  {
+    while (*position == ' ')
+    {
+      position++;
+    }
+    const char *start = position;
+    const char *end;
+    if (*position == '"')
+    {
+      //Quoted values may contain commas, they end at the closing quote
+      start = ++position;
+      while (*position != '"' && !isLineEnd(*position))
+      {
+        position++;
+      }
+      end = position;
+      if (*position == '"')
+      {
+        position++;
+      }
+      while (*position == ' ')
+      {
+        position++;
+      }
+    }else{
+      while (*position != ',' && !isLineEnd(*position))
+      {
+        position++;
+      }
+      end = position;
+      while (end > start && end[-1] == ' ')
+      {
+        end--;
+      }
+    }
+    if (i == index)
+    {
+      size_t length = end - start;
+      if (length >= size)
+      {
+        return false;
+      }
+      memcpy(value, start, length);
+      value[length] = '\0';
+      return true;
+    }
+    if (*position != ',')
+    {
+      return false;
+    }
+    position++;
+  }
+}
+
+bool ATResponseParser::getInt(const char *response, const char *name, uint8_t index, int32_t &value){
+  char buffer[12];
+  if (!getValue(response, name, index, buffer, sizeof(buffer)) || buffer[0] == '\0')
+  {
+    return false;
+  }
+  char *end;
+  long number = strtol(buffer, &end, 10);
+  if (*end != '\0')
+  {
+    return false;
+  }
+  value = number;
+  return true;
+}
+
+size_t ATResponseParser::getText(const char *response, char *text, size_t size){
+  if (size == 0)
+  {
+    return 0;
+  }
+  text[0] = '\0';
+  if (response == nullptr)
+  {
+    return 0;
+  }
+  const char *start = response;
+  const char *end = response + strlen(response);
+  //Cut off the final OK line and the surrounding line breaks and spaces
+  while (end > start && isspace((unsigned char)end[-1]))
+  {
+    end--;
+  }
+  if (end - start >= 2 && end[-2] == 'O' && end[-1] == 'K' && (end - start == 2 || isspace((unsigned char)end[-3])))
+  {
+    end -= 2;
+    while (end > start && isspace((unsigned char)end[-1]))
+    {
+      end--;
+    }
+  }
+  while (start < end && isspace((unsigned char)*start))
+  {
+    start++;
+  }
+  size_t length = {0};
+  for (const char *c = start; c < end && length < size - 1; c++)
+  {
+    if (*c == '\r' || *c == '\n')
+    {
+      //\r\n or \r is one line break and becomes one space
+      if (*c == '\n' && c > start && c[-1] == '\r')
+      {
+        continue;
+      }
+      text[length++] = ' ';
+    }else{
+      text[length++] = *c;
+    }
+  }
+  text[length] = '\0';
+  return length;
+}
+
+bool ATResponseParser::isError(const char *response){
+  return response != nullptr && strstr(response, "ERROR") != nullptr;
+}
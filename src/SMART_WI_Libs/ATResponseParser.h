@@ -0,0 +1,83 @@
+/**
+ * @file ATResponseParser.h
+ * @brief Allocation-free formatting of AT commands and parsing of their responses in fixed buffers
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * A result line of the modem has the form +NAME: value,"quoted, value",value followed by OK.
+ * Values are addressed by their index, quoted values are returned without the quotes and
+ * may contain commas. Nothing is allocated on the heap, so the functions can be called
+ * repeatedly, e.g. while reconnecting, without fragmenting it.
+ *
+ */
+
+#ifndef ATResponseParser_h
+#define ATResponseParser_h
+
+    #include <Arduino.h>
+
+    /**
+     * @brief Static helpers for AT commands and their +NAME: result lines
+     *
+     */
+    class ATResponseParser
+    {
+    public:
+        /**
+         * @brief Formats an AT command like snprintf, e.g. formatCommand(cmd, sizeof(cmd), "AT+CPIN=\"%s\"", pin)
+         *
+         * @param command[out] buffer for the command
+         * @param size size of the buffer
+         * @param format printf format string
+         * @return true if the whole command fits into the buffer
+         */
+        static bool formatCommand(char *command, size_t size, const char *format, ...);
+
+        /**
+         * @brief Finds the values of the result line +NAME:
+         *
+         * @param response response of the modem
+         * @param name name of the result without '+' and ':', e.g. "CEREG", nullptr for the begining of the response
+         * @return pointer to the first value of the line, nullptr if there is no such line
+         */
+        static const char *findResult(const char *response, const char *name);
+
+        /**
+         * @brief Copies one value of a result line into a buffer, without quotes and surrounding spaces
+         *
+         * @param response response of the modem
+         * @param name name of the result, see findResult()
+         * @param index index of the value, counting from 0
+         * @param value[out] buffer for the value
+         * @param size size of the buffer
+         * @return true if the value exists and fits into the buffer
+         */
+        static bool getValue(const char *response, const char *name, uint8_t index, char *value, size_t size);
+
+        /**
+         * @brief Reads one value of a result line as integer
+         *
+         * @return true if the value exists and is a number
+         */
+        static bool getInt(const char *response, const char *name, uint8_t index, int32_t &value);
+
+        /**
+         * @brief Copies a plain text response (e.g. of ATI) without the final OK, with every line
+         * break replaced by a space and without surrounding spaces
+         *
+         * @param response response of the modem
+         * @param text[out] buffer for the text
+         * @param size size of the buffer
+         * @return Length of the text, the text is truncated if the buffer is too small
+         */
+        static size_t getText(const char *response, char *text, size_t size);
+
+        /**
+         * @return true if the response ends with ERROR or contains a +CME ERROR line
+         */
+        static bool isError(const char *response);
+    };
+
+#endif
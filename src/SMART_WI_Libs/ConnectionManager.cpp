@@ -0,0 +1,210 @@
+/**
+ * @file ConnectionManager.cpp
+ * @brief ConnectionManager member function definitions
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#if defined (DXCORE)
+
+#include "ConnectionManager.h"
+
+ConnectionManager::ConnectionManager(SequansModem* modem, MQTTClient* client)
+{
+    _modem = modem;
+    _client = client;
+}
+
+void ConnectionManager::begin(){
+    is_enabled = true;
+    failures = {0};
+    //Continue with the modem as it is, the first failing step falls back to the lower layers
+    setState(CONNECTION_MODEM_OFF);
+}
+
+void ConnectionManager::end(){
+    if (state == CONNECTION_CONNECTED || is_mqttBegun)
+    {
+        _client->end();
+    }
+    is_enabled = false;
+    setState(CONNECTION_MODEM_OFF);
+}
+
+void ConnectionManager::setState(ConnectionState newState){
+    state = newState;
+    stateStart = millis();
+    //First poll of the new state is done with the next call
+    lastPoll = stateStart - CONNECTION_CHECK_INTERVAL_MS;
+    is_mqttBegun = false;
+}
+
+bool ConnectionManager::pollDue(uint32_t interval_ms){
+    if (millis() - lastPoll < interval_ms)
+    {
+        return false;
+    }
+    lastPoll = millis();
+    return true;
+}
+
+bool ConnectionManager::timedOut(uint32_t timeout_ms){
+    return millis() - stateStart >= timeout_ms;
+}
+
+void ConnectionManager::fail(ConnectionState step){
+    //Saturates without leaving the restart cycle, so the backoff stays at its max after many failures
+    if (failures > UINT8_MAX - CONNECTION_RESTART_FAILURES)
+    {
+        failures -= CONNECTION_RESTART_FAILURES;
+    }
+    failures++;
+    retryState = step;
+    if (failures % CONNECTION_RESTART_FAILURES == 0)
+    {
+        //Restart the modem, as retrying the step alone did not help
+        Serial3.println(F("[WARNING]: Connection failed repeatedly, restarting modem"));
+        _modem->end();
+        retryState = CONNECTION_MODEM_OFF;
+    }
+    //Exponential backoff with a random part, so not every device of a cell reconnects at the same time
+    uint8_t shift = (failures - 1 < 7) ? failures - 1 : 7;
+    backoffMs = CONNECTION_BACKOFF_MIN_MS << shift;
+    if (backoffMs > CONNECTION_BACKOFF_MAX_MS)
+    {
+        backoffMs = CONNECTION_BACKOFF_MAX_MS;
+    }
+    backoffMs += random(backoffMs / 4);
+    Serial3.print(F("[WARNING]: Connection step "));
+    Serial3.print(step);
+    Serial3.print(F(" failed, retry in s: "));
+    Serial3.println(backoffMs / 1000);
+    setState(CONNECTION_BACKOFF);
+}
+
+ConnectionState ConnectionManager::process(){
+    if (!is_enabled)
+    {
+        return state;
+    }
+    switch (state)
+    {
+    case CONNECTION_MODEM_OFF:
+        //Starting the modem interface waits for the modem, this is the only longer step
+        Watchdog.reset();
+        if (_modem->init())
+        {
+            setState(CONNECTION_MODEM_ON);
+        }else{
+            fail(CONNECTION_MODEM_OFF);
+        }
+        Watchdog.reset();
+        break;
+
+    case CONNECTION_MODEM_ON:
+        if (_modem->enableRadio())
+        {
+            //Registration changes are reported by +CEREG, so the poll only sends AT+CEREG?
+            //if the cache is older than LINK_STATE_MAX_AGE_MS
+            _modem->enableLinkStateURC();
+            setState(CONNECTION_REGISTERING);
+        }else{
+            fail(CONNECTION_MODEM_ON);
+        }
+        break;
+
+    case CONNECTION_REGISTERING:
+        if (!pollDue(CONNECTION_POLL_INTERVAL_MS))
+        {
+            break;
+        }
+        if (_modem->isNetworkRegisteredCached(LINK_STATE_MAX_AGE_MS))
+        {
+            setState(CONNECTION_ATTACHING);
+        }else if (timedOut(CONNECTION_REGISTER_TIMEOUT_MS))
+        {
+            fail(CONNECTION_MODEM_ON);
+        }
+        break;
+
+    case CONNECTION_ATTACHING:
+        if (!pollDue(CONNECTION_POLL_INTERVAL_MS))
+        {
+            break;
+        }
+        if (_modem->pollGprsConnected())
+        {
+            setState(CONNECTION_MQTT_CONNECTING);
+        }else if (timedOut(CONNECTION_ATTACH_TIMEOUT_MS))
+        {
+            fail(CONNECTION_REGISTERING);
+        }
+        break;
+
+    case CONNECTION_MQTT_CONNECTING:
+        if (!is_mqttBegun)
+        {
+            if (!_client->beginConnect())
+            {
+                fail(CONNECTION_ATTACHING);
+                break;
+            }
+            is_mqttBegun = true;
+            break;
+        }
+        if (!pollDue(CONNECTION_POLL_INTERVAL_MS))
+        {
+            break;
+        }
+        if (_client->connected())
+        {
+            Serial3.println(F("Connected to MQTT broker"));
+            failures = {0};
+            setState(CONNECTION_CONNECTED);
+        }else if (timedOut(CONNECTION_MQTT_TIMEOUT_MS))
+        {
+            _client->end();
+            fail(CONNECTION_ATTACHING);
+        }
+        break;
+
+    case CONNECTION_CONNECTED:
+        if (!pollDue(CONNECTION_CHECK_INTERVAL_MS))
+        {
+            break;
+        }
+        if (!_client->connected())
+        {
+            Serial3.println(F("[WARNING]: MQTT connection lost"));
+            _client->end();
+            //Check the network registration first, as it is the most common cause
+            setState(CONNECTION_REGISTERING);
+        }
+        break;
+
+    case CONNECTION_BACKOFF:
+        if (millis() - stateStart >= backoffMs)
+        {
+            setState(retryState);
+        }
+        break;
+    }
+    return state;
+}
+
+bool ConnectionManager::isConnected(){
+    return state == CONNECTION_CONNECTED;
+}
+
+ConnectionState ConnectionManager::getState(){
+    return state;
+}
+
+uint8_t ConnectionManager::getFailures(){
+    return failures;
+}
+
+#endif
@@ -0,0 +1,131 @@
+/**
+ * @file ConnectionManager.h
+ * @brief Non-blocking state machine for the cellular connection: modem power, network registration,
+ * PDP attach and MQTT session
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Every call of process() executes at most one short AT command and returns, so RS485 sampling and
+ * UART reception keep running in the main loop while the connection is (re)established.
+ * Failed steps are retried after an exponential backoff. After CONNECTION_RESTART_FAILURES failures
+ * in a row the modem is restarted.
+ *
+ */
+#if defined (DXCORE)
+#ifndef ConnectionManager_h
+#define ConnectionManager_h
+
+#include <Arduino.h>
+#include "SequansModem.h"
+#include "MQTTClient.h"
+#include "watchdogAVR.h"
+
+const uint32_t CONNECTION_POLL_INTERVAL_MS = {2000};         //Time between two status polls while a step is pending
+const uint32_t CONNECTION_CHECK_INTERVAL_MS = {30000};       //Time between two checks of an established connection
+const uint32_t CONNECTION_REGISTER_TIMEOUT_MS = {180000};    //Max time for the network registration
+const uint32_t CONNECTION_ATTACH_TIMEOUT_MS = {60000};       //Max time for the PDP attach
+const uint32_t CONNECTION_MQTT_TIMEOUT_MS = {60000};         //Max time till the broker confirmed the MQTT session
+const uint32_t CONNECTION_BACKOFF_MIN_MS = {10000};
+const uint32_t CONNECTION_BACKOFF_MAX_MS = {900000};
+const uint8_t CONNECTION_RESTART_FAILURES = {3};             //Failures in a row, after which the modem is restarted
+
+/**
+ * @brief States of the connection, in the order they are passed while connecting
+ *
+ */
+enum ConnectionState {
+  CONNECTION_MODEM_OFF,         //Modem interface not initialized
+  CONNECTION_MODEM_ON,          //Modem initialized, radio not yet enabled
+  CONNECTION_REGISTERING,       //Waiting for the network registration
+  CONNECTION_ATTACHING,         //Waiting for the PDP context and an IP address
+  CONNECTION_MQTT_CONNECTING,   //Waiting for the broker to confirm the MQTT session
+  CONNECTION_CONNECTED,
+  CONNECTION_BACKOFF,           //Waiting before the failed step is retried
+};
+
+class ConnectionManager
+{
+private:
+    SequansModem* _modem;
+    MQTTClient* _client;
+    ConnectionState state = {CONNECTION_MODEM_OFF};
+    ConnectionState retryState = {CONNECTION_MODEM_OFF};    //State which is entered after the backoff
+    unsigned long stateStart = {0};     //Time the current state was entered
+    unsigned long lastPoll = {0};
+    uint32_t backoffMs = {0};
+    uint8_t failures = {0};             //Failures in a row, reset when connected
+    bool is_mqttBegun = {false};
+    bool is_enabled = {false};
+
+    /**
+     * @brief Enters a new state and restarts the timers of the state
+     *
+     */
+    void setState(ConnectionState newState);
+
+    /**
+     * @brief Handles a failed step and enters the backoff
+     *
+     * @param step state which is retried after the backoff
+     */
+    void fail(ConnectionState step);
+
+    /**
+     * @return true if the poll interval has elapsed since the last poll, the poll time is updated
+     */
+    bool pollDue(uint32_t interval_ms);
+
+    /**
+     * @return true if the current state lasts longer than timeout_ms
+     */
+    bool timedOut(uint32_t timeout_ms);
+
+public:
+    /**
+     * @brief Construct a new ConnectionManager object
+     *
+     * @param modem
+     * @param client MQTT client, its parameters have to be set before begin()
+     */
+    ConnectionManager(SequansModem* modem, MQTTClient* client);
+
+    /**
+     * @brief Starts connecting, the connection is established by the following calls of process()
+     *
+     */
+    void begin();
+
+    /**
+     * @brief Stops the state machine and disconnects from the broker. The modem stays on.
+     *
+     */
+    void end();
+
+    /**
+     * @brief Executes the next step of the state machine. Has to be called cyclically in the main loop,
+     * never blocks longer than one AT command or the start of the modem interface
+     *
+     * @return ConnectionState after this call
+     */
+    ConnectionState process();
+
+    /**
+     * @return true if the MQTT session is established
+     */
+    bool isConnected();
+
+    /**
+     * @return Current state
+     */
+    ConnectionState getState();
+
+    /**
+     * @return Number of failed steps in a row, saturates below 255
+     */
+    uint8_t getFailures();
+};
+
+#endif
+#endif
@@ -17,7 +17,8 @@ static bool initialized = false;
 
 SPISettings EEPROMSettings(8000000, MSBFIRST, SPI_MODE0);
 
-EEPROM_SPI_Class EEPROM_SPI = EEPROM_SPI_Class::instance();
+//Reference to the singleton, so the write buffer exists only once in RAM
+EEPROM_SPI_Class &EEPROM_SPI = EEPROM_SPI_Class::instance();
 
 void EEPROM_SPI_Class::begin(){
     pinMode(chipSelectE, OUTPUT);
@@ -39,6 +40,9 @@ bool EEPROM_SPI_Class::isInitialized(){
 }
 
 void EEPROM_SPI_Class::end(){
+  //Do not lose pending telemetry bytes
+  flushWriteBuffer();
+  waitForReady();
   SPI.endTransaction();
   SPI.end();
   initialized = false;
@@ -112,86 +116,149 @@ bool EEPROM_SPI_Class::isWriteEnabled(){
   return (statusReg & 0x02);
 }
 
+bool EEPROM_SPI_Class::waitForReady(uint16_t timeout_ms){
+  uint32_t start_ms = millis();
+  //Poll the RDY/BSY bit, the 25CSM04 allows reading the status register during a write cycle
+  while (readEEPROMStatusRegister() & 0x01)
+  {
+    if (millis() - start_ms > timeout_ms)
+    {
+      Serial3.println(F("[ERROR]: Timed out while waiting for EEPROM write cycle"));
+      return false;
+    }
+  }
+  return true;
+}
+
+void EEPROM_SPI_Class::writeChunk(uint32_t address, const uint8_t *buf, uint16_t sizeBuf){
+  //Begin SPI communication
+  SPI.beginTransaction(EEPROMSettings);
+  //First we have to enable to write to the EEPROM 
+  digitalWrite(chipSelectE, LOW);
+
+  //Enable to Write
+  SPI.transfer(WREN);
+  digitalWrite(chipSelectE, HIGH);
+
+  //Send Write instruction Sequence
+  digitalWrite(chipSelectE, LOW);
+  SPI.transfer(WRITE);
+
+  //Write MSB of address 16Bit at once
+  address = address & 0x7FFFF;
+  SPI.transfer((byte) (address>>16));
+  //Write LSB of address
+  SPI.transfer16(address);
+
+  /*Write arbitary data*/
+  for (uint16_t i = 0; i < sizeBuf; i++)
+  {
+    SPI.transfer(buf[i]);
+  }
+
+  //End bit Stream, this starts the internal write cycle
+  digitalWrite(chipSelectE, HIGH);
+  //End transaction of data
+  SPI.endTransaction();
+}
+
 void EEPROM_SPI_Class::writeExternEEPROM(uint32_t address, const uint8_t *buf, uint16_t sizeBuf){
   uint16_t remainingBytes = sizeBuf;
   uint16_t bufferIndex = {0};
+
+  //Pending bytes of the same area have to be written first, otherwise they would overwrite this data later
+  if (overlapsWriteBuffer(address, sizeBuf))
+  {
+    flushWriteBuffer();
+  }
+
   //Wait till EEPPROM is ready
-  while (EEPROMisBusy()){}
+  waitForReady();
 
-  //NEW
   while(remainingBytes > 0){
     uint16_t positionInPage = address % pageSize;
     uint16_t spaceLeftInPage = pageSize - positionInPage;
     uint16_t chunkSize = (remainingBytes < spaceLeftInPage) ? remainingBytes : spaceLeftInPage;
-    //Serial3.print(F("sizeBuf: "));
-    //Serial3.println(sizeBuf);
-    //Begin SPI communication
-    SPI.beginTransaction(EEPROMSettings);
-    //First we have to enable to write to the EEPROM 
-    digitalWrite(chipSelectE, LOW);
-    //delayMicroseconds(1);
 
-    //Enable to Write
-    SPI.transfer(WREN);
-    digitalWrite(chipSelectE, HIGH);
+    writeChunk(address, &buf[bufferIndex], chunkSize);
+    //Wait till EEPPROM is ready
+    waitForReady();
 
-    //Check for WEL
-    // if(isWriteEnabled()){
-    //   Serial3.println(F("Enabled to write"));
-    // }else
-    // {
-    //   Serial3.println(F("NOT YET READY TO WRITE!!"));
-    // }
-    
+    address += chunkSize;
+    bufferIndex += chunkSize;
+    remainingBytes -= chunkSize;
+  }
+}
 
-    //Send Write instruction Sequence
-    digitalWrite(chipSelectE, LOW);
-    SPI.transfer(WRITE);
+bool EEPROM_SPI_Class::overlapsWriteBuffer(uint32_t address, uint16_t sizeBuf){
+  if (writeBufferLength == 0)
+  {
+    return false;
+  }
+  return (address < writeBufferAddress + writeBufferLength) && (writeBufferAddress < address + sizeBuf);
+}
 
-   
-  
-    //Write MSB of address 16Bit at once
-    address = address & 0x7FFFF;
-    // Serial3.print("write to EEPROM address: ");
-    // Serial3.println(address, BIN);
-    SPI.transfer((byte) (address>>16)); //address>>8)
-    //Write LSB of address
-    SPI.transfer16(address);
+bool EEPROM_SPI_Class::hasPendingWrites(){
+  return writeBufferLength > 0;
+}
+
+void EEPROM_SPI_Class::flushWriteBuffer(){
+  if (writeBufferLength == 0)
+  {
+    return;
+  }
+  //Wait till a previous write cycle is completed
+  waitForReady();
+  //The buffer never crosses a write page, so it can be written with one WRITE sequence
+  writeChunk(writeBufferAddress, writeBuffer, writeBufferLength);
+  writeBufferLength = {0};
+}
+
+bool EEPROM_SPI_Class::writeBufferedEEPROM(uint32_t address, const uint8_t *buf, uint16_t sizeBuf){
+  bool flushed = false;
+  uint16_t bufferIndex = {0};
 
-    /*Write arbitary data*/
-    for (uint8_t i = 0; i < chunkSize; i++)
+  //Start a new page, if the data does not continue the pending bytes
+  if (writeBufferLength > 0 && address != writeBufferAddress + writeBufferLength)
+  {
+    flushWriteBuffer();
+    flushed = true;
+  }
+
+  while (sizeBuf > 0)
+  {
+    if (writeBufferLength == 0)
     {
-      SPI.transfer(buf[bufferIndex + i]);
-      //Serial3.print("write 8 Bits: ");
-      //Serial3.println(buf[i], BIN);
+      writeBufferAddress = address;
     }
-  
-    //End bit Stream
-    digitalWrite(chipSelectE, HIGH);
-    //delay(5);
-
-    //Check for WEL
-    // if(isWriteEnabled()){
-    //   Serial3.println(F("Still Enabled to write"));
-    // }else
-    // {
-    //   Serial3.println(F("Disabled to write"));
-    // }
-    //End transaction of data
-    SPI.endTransaction();
-    //readBusyStatusLatch();
-    //Wait till EEPPROM is ready
-    while (EEPROMisBusy()){}
+    uint16_t positionInPage = (writeBufferAddress + writeBufferLength) % pageSize;
+    uint16_t spaceLeftInPage = pageSize - positionInPage;
+    uint16_t chunkSize = (sizeBuf < spaceLeftInPage) ? sizeBuf : spaceLeftInPage;
 
-    address += chunkSize;
+    memcpy(&writeBuffer[writeBufferLength], &buf[bufferIndex], chunkSize);
+    writeBufferLength += chunkSize;
     bufferIndex += chunkSize;
-    remainingBytes -= chunkSize;
+    address += chunkSize;
+    sizeBuf -= chunkSize;
+
+    //Write the page as soon as the end of the physical write page has been reached
+    if (chunkSize == spaceLeftInPage)
+    {
+      flushWriteBuffer();
+      flushed = true;
+    }
   }
+  return flushed;
 }
 
-void EEPROM_SPI_Class::readExternEEPROM(uint32_t address, uint8_t *buf, uint8_t sizeBuf){
+void EEPROM_SPI_Class::readExternEEPROM(uint32_t address, uint8_t *buf, uint16_t sizeBuf){
+    //Pending bytes have to be on the EEPROM, before they can be read back
+    if (overlapsWriteBuffer(address, sizeBuf))
+    {
+      flushWriteBuffer();
+    }
     //Wait till EEPPROM is ready
-    while (EEPROMisBusy()){}
+    waitForReady();
     
     //Begin SPI communication
     SPI.beginTransaction(EEPROMSettings);
@@ -208,7 +275,7 @@ void EEPROM_SPI_Class::readExternEEPROM(uint32_t address, uint8_t *buf, uint8_t
     //Read LSB of address
     SPI.transfer16(address);
     //Read value
-    for (uint8_t i = 0; i < sizeBuf; i++) //for (uint8_t i = 0; i < sizeBuf; i++)
+    for (uint16_t i = 0; i < sizeBuf; i++)
     {
         // Serial3.print("i = ");
         // Serial3.println(i);
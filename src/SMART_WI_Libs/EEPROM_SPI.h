@@ -19,12 +19,25 @@ const uint8_t ADDRESS_PAGE_FLAG = {0};             //Address of flag, inlc. crc,
 const uint8_t ADDRESS_SAVED_TELEM_FLAG = {2};   //Address of flag, inlc crc, which indicates if there are new saved tleemetry data on the EEPROM
 const uint32_t ADDRESS_LAST_TELEM_ADDRESS_01 = {4}; //Address for saving the last telemetry address on the frist page
 const uint32_t ADDRESS_FIRST_TELEM_01 = {10};         //First possible free address for telemetry data on the first page;
+const uint32_t ADDRESS_SEQUENCE_RESERVE = {524280};   //Address of the reserved telemetry sequence numbers, incl. crc, behind the last page
+const uint32_t ADDRESS_CONFIG_AREA = {522240};        //Begin of the configuration area (8 write pages) at the end of the last page, telemetry data ends before
+const uint32_t ADDRESS_MQTT_OUTBOX = {489472};        //Store-and-forward outbox of MQTTClient (64 slots of two write pages) before the configuration area, takes 32KB of the last telemetry page
+const uint16_t SIZE_MQTT_OUTBOX = {32768};
+const uint32_t ADDRESS_TELEMETRY_END = ADDRESS_MQTT_OUTBOX;  //Telemetry data of the last page ends before the outbox
+const uint32_t ADDRESS_CALIBRATION = ADDRESS_CONFIG_AREA;  //Calibration curves of the sensors (SensorClass), one slot per sensor
+const uint16_t SIZE_CALIBRATION_AREA = {256};
+const uint32_t ADDRESS_LORAWAN_SESSION = ADDRESS_CALIBRATION + SIZE_CALIBRATION_AREA;  //RadioLib nonces (first write page) and session of SX1262_LoRaWAN
+const uint16_t SIZE_LORAWAN_SESSION_AREA = {768};
+const uint32_t ADDRESS_MQTT_OUTBOX_LAYOUT = ADDRESS_LORAWAN_SESSION + SIZE_LORAWAN_SESSION_AREA;  //Layout version of the outbox, incl. crc, the slots are cleared once if it does not match
 
 
 
 const uint16_t PAGE_SIZE = {52428};     //Max number of possible addresses in one page
 const uint8_t MAX_PAGE_NUMBER = {10};   //Number of pages of the whole EEPROM
 
+const uint16_t EEPROM_WRITE_PAGE_SIZE = {256};  //Size of one physical write page of the 25CSM04
+const uint16_t EEPROM_READY_TIMEOUT_MS = {20};  //Max time to wait for an internal write cycle (tWC is 5ms)
+
 
 class EEPROM_SPI_Class
 {
@@ -38,7 +51,26 @@ private:
     const byte WRITE =  0x02; //Write to EEPROM Array (1 to 256 bytes)
     const byte WRBP = 0x08; //Write Ready/Busy Poll
     const byte WEL = 0x02;  //Write Enable Latch Bit
-    const uint16_t pageSize = 256;  //Size of one page for writing
+    const uint16_t pageSize = EEPROM_WRITE_PAGE_SIZE;  //Size of one page for writing
+
+    //Write combining buffer, which holds the content of one physical write page until it is flushed
+    uint8_t writeBuffer[EEPROM_WRITE_PAGE_SIZE];
+    uint32_t writeBufferAddress = {0};  //EEPROM address of the first byte in writeBuffer
+    uint16_t writeBufferLength = {0};   //Number of pending bytes in writeBuffer
+
+    /**
+     * @brief Sends the WREN and WRITE sequence for one chunk, which must not cross a write page
+     * 
+     * @param address where the chunk should be written
+     * @param buf pointer of data
+     * @param sizeBuf Size of the chunk, MAX pageSize
+     */
+    void writeChunk(uint32_t address, const uint8_t *buf, uint16_t sizeBuf);
+
+    /**
+     * @brief Checks if the range [address, address + sizeBuf) overlaps the pending bytes of the write buffer
+     */
+    bool overlapsWriteBuffer(uint32_t address, uint16_t sizeBuf);
 
     /**
      * @brief Hide constructor in order to enforce a single instance of the
@@ -98,6 +130,16 @@ public:
     */
     bool EEPROMisBusy();
 
+    /**
+     * @brief Polls the RDY/BSY bit of the status register until the EEPROM is ready, 
+     * instead of waiting a fixed time
+     * 
+     * @param timeout_ms max time to wait
+     * @return true if the EEPROM is ready
+     * @return false if timed out
+     */
+    bool waitForReady(uint16_t timeout_ms = EEPROM_READY_TIMEOUT_MS);
+
     /**
      * @brief Chekst if EEPROM is enabled for writing, by ckecking the WEL status register
      * 
@@ -120,28 +162,81 @@ public:
     * 
     * @param address from the data should be read
     * @param buf pointer of buffer for the copied data
-    * @param sizeBuf Size of buffer where data should be copied
+    * @param sizeBuf Size of buffer where data should be copied, the whole range is read in one SPI transaction
     */
-    void readExternEEPROM(uint32_t address, uint8_t *buf, uint8_t sizeBuf);
+    void readExternEEPROM(uint32_t address, uint8_t *buf, uint16_t sizeBuf);
+
+    /**
+     * @brief Write data into the write combining buffer. Consecutive writes are gathered
+     * and written as one full page, as soon as the end of the current write page is reached.
+     * Non consecutive writes flush the pending bytes first.
+     * 
+     * @param address where the data should be written
+     * @param buf pointer of data
+     * @param sizeBuf Size of data
+     * @return true if at least one page has been written to the EEPROM during this call
+     * @return false if all data is still pending in the write buffer
+     */
+    bool writeBufferedEEPROM(uint32_t address, const uint8_t *buf, uint16_t sizeBuf);
+
+    /**
+     * @brief Write all pending bytes of the write combining buffer to the EEPROM
+     * 
+     */
+    void flushWriteBuffer();
+
+    /**
+     * @return True if there are bytes in the write buffer, which are not yet written to the EEPROM
+     */
+    bool hasPendingWrites();
 
     template <typename T>
     const T &putEEPROMData(uint32_t address, const T &t){
         const uint8_t *data = (const uint8_t *)&t;
+        //writeExternEEPROM polls the status register till the write cycle is completed
         writeExternEEPROM(address, data, sizeof(T)); 
-        delay(5);
         return t;
     }
 
+    template <typename T>
+    bool putEEPROMDataBuffered(uint32_t address, const T &t){
+        const uint8_t *data = (const uint8_t *)&t;
+        return writeBufferedEEPROM(address, data, sizeof(T));
+    }
+
     template <typename T>
     T &getEEPROMData(uint32_t address, T &t){
         uint8_t *ptrValue = (uint8_t *)&t;
         readExternEEPROM(address, ptrValue, sizeof(T));
-        delay(5);
         return t;
     }
 
+    /**
+     * @brief Write data and read it back to check if the writing process was not currupted
+     * 
+     * @param address where the data on the EEPROM should be written
+     * @param t data which should be written
+     * @param tries max number of write attempts
+     * @return true if the data on the EEPROM is equal to t,
+     * @return false if not after every attempt
+     */
+    template <typename T>
+    bool putEEPROMDataVerified(uint32_t address, const T &t, uint8_t tries = 3){
+        T check;
+        for (uint8_t i = 0; i < tries; i++)
+        {
+            putEEPROMData(address, t);
+            getEEPROMData(address, check);
+            if (memcmp(&check, &t, sizeof(T)) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
 };
 
-extern EEPROM_SPI_Class EEPROM_SPI;
+extern EEPROM_SPI_Class &EEPROM_SPI;
 
 #endif
@@ -223,6 +223,25 @@ void ChirpStackReceiver::onBinaryData(const uint8_t* data, size_t size) {
         }
     }
     
+    // Fragmente sammeln, bis die Nachricht vollständig ist
+    if (LoRaWAN_Reassembler::isFragment(payloadData, payloadSize)) {
+        LoRaWAN_Reassembler& reassembler = findReassembler(deviceId.c_str());
+        if (!reassembler.add(payloadData, payloadSize)) {
+            if (debugSerial) {
+                debugSerial->print(F("[DEBUG] Fragment "));
+                debugSerial->print((payloadData[2] >> 4) + 1);
+                debugSerial->print(F("/"));
+                debugSerial->print((payloadData[2] & 0x0F) + 1);
+                debugSerial->println(F(" gespeichert"));
+            }
+            return;
+        }
+        payloadData = reassembler.getData();
+        payloadSize = reassembler.getLength();
+        data = payloadData;
+        size = payloadSize;
+    }
+    
     // Dekodiere und speichere die Sensordaten
     lastSensorData = ChirpStackMessageProcessor::decodeSensorDataToStruct(payloadData, payloadSize, deviceId);
     
@@ -231,6 +250,39 @@ void ChirpStackReceiver::onBinaryData(const uint8_t* data, size_t size) {
     stats.recordProcessed();
 }
 
+LoRaWAN_Reassembler& ChirpStackReceiver::findReassembler(const char* deviceId) {
+    // Platz des Geräts, sonst ein freier oder abgelaufener, sonst der am längsten offene
+    ReassemblySlot* freeSlot = nullptr;
+    ReassemblySlot* oldestSlot = nullptr;
+    for (ReassemblySlot& slot : reassemblySlots) {
+        if (!slot.reassembler.isPending()) {
+            if (!freeSlot) {
+                freeSlot = &slot;
+            }
+            continue;
+        }
+        if (strcmp(slot.deviceId, deviceId) == 0) {
+            return slot.reassembler;
+        }
+        if (!oldestSlot || (long)(slot.reassembler.getStartTime() - oldestSlot->reassembler.getStartTime()) < 0) {
+            oldestSlot = &slot;
+        }
+    }
+    
+    ReassemblySlot* slot = freeSlot;
+    if (!slot) {
+        slot = oldestSlot;
+        if (debugSerial) {
+            debugSerial->print(F("[DEBUG] Unvollständige Nachricht verworfen von "));
+            debugSerial->println(slot->deviceId);
+        }
+    }
+    slot->reassembler.reset();
+    strncpy(slot->deviceId, deviceId, sizeof(slot->deviceId) - 1);
+    slot->deviceId[sizeof(slot->deviceId) - 1] = '\0';
+    return slot->reassembler;
+}
+
 void ChirpStackReceiver::onJsonData(JsonObject data) {
     if (debugSerial) {
         serializeJson(data, *debugSerial);
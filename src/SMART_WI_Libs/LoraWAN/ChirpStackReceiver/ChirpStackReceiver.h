@@ -19,6 +19,7 @@
 #include "../../KitConfig.h"
 #include "../../SerialMon.h"
 #include "../Payload_Builder.h"
+#include "../LoRaWAN_Fragment.h"
 
 // ========================================
 // Sensordaten-Strukturen
@@ -87,8 +88,17 @@ namespace ChirpStackConfig {
     constexpr uint16_t PAYLOAD_BUFFER_SIZE = 256;
     constexpr uint8_t EXPECTED_PAYLOAD_SIZE = 28;
     constexpr uint16_t SERIAL_INIT_DELAY_MS = 100;
+    constexpr uint8_t REASSEMBLY_SLOTS = 4;     // Geräte, deren Fragmente gleichzeitig gesammelt werden
 }
 
+/**
+ * @brief Fragmente eines Geräts, die noch zu einer Nachricht zusammengesetzt werden
+ */
+struct ReassemblySlot {
+    char deviceId[17] = {0};            // Device-ID (16 Hex-Zeichen), leer ohne Device-ID
+    LoRaWAN_Reassembler reassembler;
+};
+
 // ========================================
 // Statistik-Klasse
 // ========================================
@@ -205,6 +215,10 @@ public:
     
     /**
      * @brief Callback für empfangene Binärdaten
+     * 
+     * Fragmente (siehe LoRaWAN_Fragment.h) werden je Device-ID gesammelt und erst nach
+     * dem letzten fehlenden Fragment als vollständige Nachricht dekodiert. Fragmente von
+     * bis zu ChirpStackConfig::REASSEMBLY_SLOTS Geräten können sich überschneiden.
      */
     void onBinaryData(const uint8_t* data, size_t size);
     
@@ -251,11 +265,13 @@ private:
     bool debugMode;
     uint32_t statsIntervalMs;
     SensorData lastSensorData;  // Speichert die zuletzt empfangenen Sensordaten
+    ReassemblySlot reassemblySlots[ChirpStackConfig::REASSEMBLY_SLOTS];  // Setzt fragmentierte Uplinks je Gerät zusammen
     
     void initializeSerial();
     void initializeUART();
     void displayWelcome();
     void processDebugMode();
+    LoRaWAN_Reassembler& findReassembler(const char* deviceId);
     
     // Statische Callback-Wrapper
     static ChirpStackReceiver* instance;
@@ -0,0 +1,83 @@
+/**
+ * LoRaWAN AT-Antwort-Matcher Implementation
+ */
+
+#include "LoRaWAN_ATMatcher.h"
+
+LoRaWAN_ATMatcher::LoRaWAN_ATMatcher() {
+    memset(_patterns, 0, sizeof(_patterns));
+    memset(_length, 0, sizeof(_length));
+    memset(_offset, 0, sizeof(_offset));
+    memset(_state, 0, sizeof(_state));
+    memset(_failure, 0, sizeof(_failure));
+    _count = 0;
+}
+
+int8_t LoRaWAN_ATMatcher::addPattern(const char* pattern) {
+    if (!pattern || _count >= LORAWAN_MATCHER_MAX_PATTERNS) return -1;
+
+    size_t length = strlen(pattern);
+    uint8_t offset = (_count > 0) ? _offset[_count - 1] + _length[_count - 1] : 0;
+    if (length == 0 || length > 255 || offset + length > LORAWAN_MATCHER_TABLE_SIZE) return -1;
+
+    // KMP-Fehlertabelle: _failure[offset + i] = Länge des längsten echten Präfixes von
+    // pattern[0..i], der gleichzeitig Suffix davon ist
+    uint8_t* failure = &_failure[offset];
+    failure[0] = 0;
+    uint8_t k = 0;
+    for (uint8_t i = 1; i < length; i++) {
+        while (k > 0 && pattern[i] != pattern[k]) {
+            k = failure[k - 1];
+        }
+        if (pattern[i] == pattern[k]) {
+            k++;
+        }
+        failure[i] = k;
+    }
+
+    _patterns[_count] = pattern;
+    _length[_count] = (uint8_t)length;
+    _offset[_count] = offset;
+    _state[_count] = 0;
+    return (int8_t)_count++;
+}
+
+void LoRaWAN_ATMatcher::removePatternsFrom(uint8_t index) {
+    if (index < _count) {
+        _count = index;
+    }
+}
+
+uint8_t LoRaWAN_ATMatcher::getPatternCount() {
+    return _count;
+}
+
+void LoRaWAN_ATMatcher::reset() {
+    memset(_state, 0, sizeof(_state));
+}
+
+uint16_t LoRaWAN_ATMatcher::feed(char c) {
+    uint16_t matches = 0;
+
+    for (uint8_t i = 0; i < _count; i++) {
+        const char* pattern = _patterns[i];
+        const uint8_t* failure = &_failure[_offset[i]];
+        uint8_t state = _state[i];
+
+        // Bei Abweichung auf den längsten passenden Präfix zurückfallen, ohne Zeichen erneut zu lesen
+        while (state > 0 && pattern[state] != c) {
+            state = failure[state - 1];
+        }
+        if (pattern[state] == c) {
+            state++;
+        }
+        if (state == _length[i]) {
+            matches |= (uint16_t)1 << i;
+            state = failure[state - 1];
+        }
+
+        _state[i] = state;
+    }
+
+    return matches;
+}
@@ -0,0 +1,65 @@
+/**
+ * LoRaWAN AT-Antwort-Matcher
+ *
+ * Sucht mehrere Muster (z.B. "ERROR", "+JOIN: Done", "RX: \"") gleichzeitig in
+ * einem Zeichenstrom. Jedes Zeichen wird genau einmal betrachtet (paralleles KMP),
+ * statt nach jedem Zeichen den gesamten Antwortpuffer mit strstr() zu durchsuchen.
+ *
+ * Die Muster gelten zeilenweise: reset() am Zeilenende, feed() für jedes Zeichen
+ * der Zeile. Die Rückgabe von feed() ist eine Bitmaske der Muster, die mit diesem
+ * Zeichen vollständig erkannt wurden.
+ */
+
+#ifndef LORAWAN_ATMATCHER_H
+#define LORAWAN_ATMATCHER_H
+
+#include "Arduino.h"
+
+#define LORAWAN_MATCHER_MAX_PATTERNS 12     // Max. Anzahl gleichzeitiger Muster (Bitmaske uint16_t)
+#define LORAWAN_MATCHER_TABLE_SIZE 192      // Summe der Musterlängen (KMP-Fehlertabellen)
+
+class LoRaWAN_ATMatcher {
+private:
+    const char* _patterns[LORAWAN_MATCHER_MAX_PATTERNS];
+    uint8_t _length[LORAWAN_MATCHER_MAX_PATTERNS];
+    uint8_t _offset[LORAWAN_MATCHER_MAX_PATTERNS];  // Beginn der Fehlertabelle in _failure
+    uint8_t _state[LORAWAN_MATCHER_MAX_PATTERNS];   // Anzahl bereits passender Zeichen
+    uint8_t _failure[LORAWAN_MATCHER_TABLE_SIZE];   // Längster echter Präfix, der auch Suffix ist
+    uint8_t _count;
+
+public:
+    LoRaWAN_ATMatcher();
+
+    /**
+     * Fügt ein Muster hinzu
+     * @param pattern Muster, muss gültig bleiben solange es verwendet wird (String-Literal)
+     * @return Index des Musters (Bit in der Maske von feed()) oder -1 wenn kein Platz
+     */
+    int8_t addPattern(const char* pattern);
+
+    /**
+     * Entfernt alle Muster ab dem angegebenen Index, die vorherigen behalten ihren Zustand
+     * @param index Erster zu entfernender Index
+     */
+    void removePatternsFrom(uint8_t index);
+
+    /**
+     * Gibt die Anzahl der Muster zurück
+     * @return Anzahl der Muster
+     */
+    uint8_t getPatternCount();
+
+    /**
+     * Setzt den Suchzustand aller Muster zurück (Zeilenanfang)
+     */
+    void reset();
+
+    /**
+     * Verarbeitet ein Zeichen
+     * @param c Empfangenes Zeichen
+     * @return Bitmaske der Muster, die mit diesem Zeichen vollständig erkannt wurden
+     */
+    uint16_t feed(char c);
+};
+
+#endif // LORAWAN_ATMATCHER_H
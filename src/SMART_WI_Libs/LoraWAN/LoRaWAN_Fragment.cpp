@@ -0,0 +1,159 @@
+/**
+ * LoRaWAN Fragmentierung Implementation
+ */
+
+#include "LoRaWAN_Fragment.h"
+
+// ================================================================
+// SENDER
+// ================================================================
+
+LoRaWAN_Fragmenter::LoRaWAN_Fragmenter() {
+    _data = nullptr;
+    _length = 0;
+    _chunkSize = 0;
+    _count = 0;
+    _index = 0;
+    _messageId = 0;
+}
+
+bool LoRaWAN_Fragmenter::begin(const uint8_t* data, size_t length, size_t maxPayloadSize) {
+    _count = 0;
+    _index = 0;
+    if (!data || length == 0 || length > LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE) return false;
+    if (maxPayloadSize <= LORAWAN_FRAGMENT_HEADER_SIZE) return false;
+
+    // Datenlänge je Fragment muss in ein Byte des Headers passen
+    size_t chunkSize = maxPayloadSize - LORAWAN_FRAGMENT_HEADER_SIZE;
+    if (chunkSize > 255) chunkSize = 255;
+
+    size_t count = (length + chunkSize - 1) / chunkSize;
+    if (count > LORAWAN_FRAGMENT_MAX_COUNT) return false;
+
+    _data = data;
+    _length = length;
+    _chunkSize = (uint8_t)chunkSize;
+    _count = (uint8_t)count;
+    _messageId++;
+    return true;
+}
+
+bool LoRaWAN_Fragmenter::next(LoRaWAN_Fragment& fragment) {
+    if (_index >= _count) return false;
+
+    size_t offset = (size_t)_index * _chunkSize;
+    size_t remaining = _length - offset;
+
+    fragment.header[0] = LORAWAN_FRAGMENT_MARKER;
+    fragment.header[1] = _messageId;
+    fragment.header[2] = (uint8_t)((_index << 4) | (_count - 1));
+    fragment.header[3] = _chunkSize;
+    fragment.data = &_data[offset];
+    fragment.length = (remaining < _chunkSize) ? (uint8_t)remaining : _chunkSize;
+
+    _index++;
+    return true;
+}
+
+uint8_t LoRaWAN_Fragmenter::getCount() {
+    return _count;
+}
+
+// ================================================================
+// EMPFÄNGER
+// ================================================================
+
+LoRaWAN_Reassembler::LoRaWAN_Reassembler() {
+    reset();
+}
+
+bool LoRaWAN_Reassembler::isFragment(const uint8_t* data, size_t size) {
+    return data && size > LORAWAN_FRAGMENT_HEADER_SIZE && data[0] == LORAWAN_FRAGMENT_MARKER;
+}
+
+bool LoRaWAN_Reassembler::add(const uint8_t* data, size_t size) {
+    if (!isFragment(data, size)) return false;
+
+    uint8_t messageId = data[1];
+    uint8_t index = data[2] >> 4;
+    uint8_t count = (data[2] & 0x0F) + 1;
+    uint8_t chunkSize = data[3];
+    const uint8_t* chunk = &data[LORAWAN_FRAGMENT_HEADER_SIZE];
+    size_t chunkLength = size - LORAWAN_FRAGMENT_HEADER_SIZE;
+
+    // Alle Fragmente außer dem letzten sind genau chunkSize lang
+    bool last = (index == count - 1);
+    if (index >= count || chunkSize == 0 || chunkLength > chunkSize || (!last && chunkLength != chunkSize)) {
+        return false;
+    }
+    size_t offset = (size_t)index * chunkSize;
+    if (offset + chunkLength > LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE) {
+        return false;
+    }
+
+    // Neue Nachricht beginnt: unvollständige oder veraltete Nachricht verwerfen
+    if (!_active || messageId != _messageId || count != _count || chunkSize != _chunkSize ||
+        millis() - _startTime > LORAWAN_FRAGMENT_TIMEOUT_MS) {
+        reset();
+        _active = true;
+        _messageId = messageId;
+        _count = count;
+        _chunkSize = chunkSize;
+        _startTime = millis();
+    }
+
+    uint16_t bit = (uint16_t)1 << index;
+    if (_receivedMask & bit) {
+        // Doppeltes Fragment (z.B. Wiederholung eines bestätigten Uplinks)
+        return false;
+    }
+
+    memcpy(&_buffer[offset], chunk, chunkLength);
+    _receivedMask |= bit;
+    if (last) {
+        _length = offset + chunkLength;
+    }
+
+    uint16_t completeMask = (count == 16) ? 0xFFFF : (uint16_t)((1U << count) - 1);
+    if (_receivedMask != completeMask) {
+        return false;
+    }
+
+    // Nachricht vollständig, ein erneutes Fragment derselben ID beginnt eine neue Nachricht
+    _active = false;
+    return true;
+}
+
+const uint8_t* LoRaWAN_Reassembler::getData() {
+    return _buffer;
+}
+
+size_t LoRaWAN_Reassembler::getLength() {
+    return _length;
+}
+
+uint8_t LoRaWAN_Reassembler::getReceivedCount() {
+    uint8_t received = 0;
+    for (uint16_t mask = _receivedMask; mask; mask >>= 1) {
+        received += mask & 1;
+    }
+    return received;
+}
+
+bool LoRaWAN_Reassembler::isPending() {
+    return _active && millis() - _startTime <= LORAWAN_FRAGMENT_TIMEOUT_MS;
+}
+
+unsigned long LoRaWAN_Reassembler::getStartTime() {
+    return _startTime;
+}
+
+void LoRaWAN_Reassembler::reset() {
+    _receivedMask = 0;
+    _messageId = 0;
+    _count = 0;
+    _chunkSize = 0;
+    _length = 0;
+    _startTime = 0;
+    _active = false;
+}
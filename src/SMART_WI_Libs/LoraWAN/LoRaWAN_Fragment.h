@@ -0,0 +1,156 @@
+/**
+ * LoRaWAN Fragmentierung
+ *
+ * Teilt Payloads, die bei der aktuellen Data Rate nicht in einen Uplink passen
+ * (z.B. 51 Bytes bei DR0 in EU868), auf mehrere Uplinks auf und setzt sie auf
+ * der Empfängerseite (ChirpStackReceiver) wieder zusammen.
+ *
+ * Payloads, die in einen Uplink passen, werden unverändert gesendet. Nur
+ * Fragmente beginnen mit einem Header von 4 Bytes:
+ *
+ *   Byte 0: LORAWAN_FRAGMENT_MARKER (0xFE, kein gültiger Cayenne-Kanal/TLV-Tag)
+ *   Byte 1: Nachrichten-ID (fortlaufend je Nachricht)
+ *   Byte 2: Fragment-Index (obere 4 Bit) | Anzahl Fragmente - 1 (untere 4 Bit)
+ *   Byte 3: Datenlänge je Fragment (alle außer dem letzten Fragment)
+ *
+ * Verwendung Sender:
+ *   LoRaWAN_Fragmenter fragmenter;
+ *   LoRaWAN_Fragment fragment;
+ *   if (fragmenter.begin(data, length, maxPayloadSize)) {
+ *       while (fragmenter.next(fragment)) {
+ *           // fragment.header + fragment.data als ein Uplink senden
+ *       }
+ *   }
+ *
+ * Verwendung Empfänger:
+ *   LoRaWAN_Reassembler reassembler;
+ *   if (LoRaWAN_Reassembler::isFragment(data, size)) {
+ *       if (reassembler.add(data, size)) {
+ *           decode(reassembler.getData(), reassembler.getLength());
+ *       }
+ *   }
+ *
+ * Ein Empfänger für mehrere Geräte braucht je Gerät einen Reassembler, da sich
+ * die Nachrichten-IDs der Geräte überschneiden (siehe ChirpStackReceiver).
+ */
+
+#ifndef LORAWAN_FRAGMENT_H
+#define LORAWAN_FRAGMENT_H
+
+#include "Arduino.h"
+
+#define LORAWAN_FRAGMENT_MARKER 0xFE
+#define LORAWAN_FRAGMENT_HEADER_SIZE 4
+#define LORAWAN_FRAGMENT_MAX_COUNT 16               // Begrenzt durch 4 Bit im Header
+#define LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE 256       // Max. Größe einer fragmentierten Nachricht
+#define LORAWAN_FRAGMENT_TIMEOUT_MS 900000UL        // Unvollständige Nachricht nach 15 Minuten verwerfen
+
+struct LoRaWAN_Fragment {
+    uint8_t header[LORAWAN_FRAGMENT_HEADER_SIZE];
+    const uint8_t* data;        // Zeigt in die Nachricht, wird nicht kopiert
+    uint8_t length;             // Länge der Daten ohne Header
+};
+
+class LoRaWAN_Fragmenter {
+private:
+    const uint8_t* _data;
+    size_t _length;
+    uint8_t _chunkSize;
+    uint8_t _count;
+    uint8_t _index;
+    uint8_t _messageId;
+
+public:
+    LoRaWAN_Fragmenter();
+
+    /**
+     * Beginnt eine neue fragmentierte Nachricht
+     * @param data Nachricht, muss gültig bleiben bis alle Fragmente gesendet sind
+     * @param length Länge der Nachricht (max. LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE)
+     * @param maxPayloadSize Max. Payload eines Uplinks bei der aktuellen Data Rate
+     * @return true wenn die Nachricht in max. LORAWAN_FRAGMENT_MAX_COUNT Fragmente passt
+     */
+    bool begin(const uint8_t* data, size_t length, size_t maxPayloadSize);
+
+    /**
+     * Liefert das nächste Fragment
+     * @param fragment Header und Datenbereich des Fragments
+     * @return false wenn alle Fragmente geliefert wurden
+     */
+    bool next(LoRaWAN_Fragment& fragment);
+
+    /**
+     * Gibt die Anzahl der Fragmente der aktuellen Nachricht zurück
+     * @return Anzahl der Fragmente
+     */
+    uint8_t getCount();
+};
+
+class LoRaWAN_Reassembler {
+private:
+    uint8_t _buffer[LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE];
+    uint16_t _receivedMask;     // Bit je empfangenem Fragment
+    uint8_t _messageId;
+    uint8_t _count;
+    uint8_t _chunkSize;
+    size_t _length;             // Bekannt, sobald das letzte Fragment empfangen wurde
+    unsigned long _startTime;
+    bool _active;
+
+public:
+    LoRaWAN_Reassembler();
+
+    /**
+     * Prüft, ob ein Uplink ein Fragment ist
+     * @param data Empfangene Payload
+     * @param size Länge der Payload
+     * @return true wenn die Payload mit einem Fragment-Header beginnt
+     */
+    static bool isFragment(const uint8_t* data, size_t size);
+
+    /**
+     * Fügt ein Fragment hinzu. Ein Fragment einer anderen Nachricht verwirft die
+     * unvollständige bisherige Nachricht, doppelte Fragmente werden ignoriert.
+     * @param data Empfangene Payload inkl. Header
+     * @param size Länge der Payload
+     * @return true wenn die Nachricht damit vollständig ist
+     */
+    bool add(const uint8_t* data, size_t size);
+
+    /**
+     * Gibt die zusammengesetzte Nachricht zurück (gültig nach add() == true)
+     * @return Zeiger auf die Nachricht
+     */
+    const uint8_t* getData();
+
+    /**
+     * Gibt die Länge der zusammengesetzten Nachricht zurück
+     * @return Länge in Bytes
+     */
+    size_t getLength();
+
+    /**
+     * Gibt die Anzahl bisher empfangener Fragmente der aktuellen Nachricht zurück
+     * @return Anzahl der Fragmente
+     */
+    uint8_t getReceivedCount();
+
+    /**
+     * Prüft, ob eine unvollständige Nachricht gesammelt wird, die noch nicht abgelaufen ist
+     * @return true wenn Fragmente fehlen und das erste vor max. LORAWAN_FRAGMENT_TIMEOUT_MS kam
+     */
+    bool isPending();
+
+    /**
+     * Gibt den Empfangszeitpunkt des ersten Fragments der aktuellen Nachricht zurück
+     * @return millis() beim ersten Fragment
+     */
+    unsigned long getStartTime();
+
+    /**
+     * Verwirft die aktuelle Nachricht
+     */
+    void reset();
+};
+
+#endif // LORAWAN_FRAGMENT_H
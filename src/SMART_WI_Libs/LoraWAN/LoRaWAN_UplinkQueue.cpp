@@ -0,0 +1,258 @@
+/**
+ * LoRaWAN Uplink-Warteschlange Implementation
+ */
+
+#include "LoRaWAN_UplinkQueue.h"
+
+// LoRaWAN-Overhead je Uplink: MHDR (1) + FHDR ohne FOpts (7) + FPort (1) + MIC (4)
+static const uint8_t LORAWAN_FRAME_OVERHEAD = 13;
+
+LoRaWAN_UplinkQueue::LoRaWAN_UplinkQueue(LoRaWAN_WioE5& lora) : _lora(lora) {
+    memset(_uplinks, 0, sizeof(_uplinks));
+    _nextOrder = 0;
+    _inFlightIndex = -1;
+    _inFlightCost = 0;
+
+    // Mit vollem Budget starten
+    _airtimeBudget = LORAWAN_DUTY_CYCLE_WINDOW_MS;
+    _lastRefill = millis();
+}
+
+// ================================================================
+// EINREIHEN
+// ================================================================
+
+bool LoRaWAN_UplinkQueue::enqueue(const uint8_t* data, uint8_t length, uint8_t channel,
+                                  LoRaWAN_UplinkPriority priority, uint8_t port, bool confirmed) {
+    if (!data || length == 0 || length > LORAWAN_UPLINK_PAYLOAD_SIZE) return false;
+
+    int8_t index = findCoalesce(channel);
+    if (index >= 0) {
+        // Veralteten Wert ersetzen, Position in der Warteschlange bleibt erhalten
+        if (_uplinks[index].priority > priority) {
+            priority = _uplinks[index].priority;
+        }
+        confirmed = confirmed || _uplinks[index].confirmed;
+    } else {
+        index = findFree(priority);
+        if (index < 0) return false;
+        _uplinks[index].order = _nextOrder++;
+    }
+
+    LoRaWAN_Uplink& uplink = _uplinks[index];
+    memcpy(uplink.payload, data, length);
+    uplink.length = length;
+    uplink.port = port;
+    uplink.channel = channel;
+    uplink.priority = priority;
+    uplink.confirmed = confirmed;
+    uplink.inFlight = false;
+    uplink.retries = 0;
+    return true;
+}
+
+int8_t LoRaWAN_UplinkQueue::findCoalesce(uint8_t channel) {
+    if (channel == LORAWAN_UPLINK_NO_CHANNEL) return -1;
+
+    for (uint8_t i = 0; i < LORAWAN_UPLINK_QUEUE_SIZE; i++) {
+        if (_uplinks[i].length > 0 && !_uplinks[i].inFlight && _uplinks[i].channel == channel) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int8_t LoRaWAN_UplinkQueue::findFree(LoRaWAN_UplinkPriority priority) {
+    int8_t victim = -1;
+
+    for (uint8_t i = 0; i < LORAWAN_UPLINK_QUEUE_SIZE; i++) {
+        const LoRaWAN_Uplink& uplink = _uplinks[i];
+        if (uplink.length == 0) {
+            return i;
+        }
+        if (uplink.inFlight) {
+            continue;
+        }
+        // Ältesten Uplink der niedrigsten Priorität als Kandidat zum Verdrängen merken
+        if (victim < 0 || uplink.priority < _uplinks[victim].priority ||
+            (uplink.priority == _uplinks[victim].priority &&
+             (int16_t)(uplink.order - _uplinks[victim].order) < 0)) {
+            victim = i;
+        }
+    }
+
+    if (victim >= 0 && _uplinks[victim].priority <= priority) {
+        return victim;
+    }
+    return -1;
+}
+
+// ================================================================
+// SENDEN
+// ================================================================
+
+void LoRaWAN_UplinkQueue::process() {
+    // Nach "No band" hat das Modul bis zum Ablauf der Wartezeit keinen freien Kanal
+    if (_inFlightIndex >= 0 || !_lora.isNetworkJoined() || _lora.getNoBandWaitMs() > 0) return;
+
+    int8_t index = findNext();
+    if (index < 0) return;
+
+    LoRaWAN_Uplink& uplink = _uplinks[index];
+    LoRaWAN_Config config = _lora.getConfig();
+
+    // Duty-Cycle-Budget der Region prüfen, bis dahin können neue Werte den Uplink noch ersetzen
+    uint16_t divisor = getDutyCycleDivisor(config.region);
+    uint32_t cost = 0;
+    if (divisor > 0) {
+        refillBudget();
+        cost = calcAirtimeMs(uplink.length, config.dataRate, config.region) * divisor;
+        if (cost > _airtimeBudget) return;
+    }
+
+    if (!_lora.sendBinaryDataAsync(uplink.payload, uplink.length, uplink.port, uplink.confirmed,
+                                   onUplinkComplete, this)) {
+        // AT-Warteschlange belegt, im nächsten Durchlauf erneut versuchen
+        return;
+    }
+
+    _airtimeBudget -= cost;
+    _inFlightCost = cost;
+    uplink.inFlight = true;
+    _inFlightIndex = index;
+}
+
+int8_t LoRaWAN_UplinkQueue::findNext() {
+    int8_t next = -1;
+
+    for (uint8_t i = 0; i < LORAWAN_UPLINK_QUEUE_SIZE; i++) {
+        const LoRaWAN_Uplink& uplink = _uplinks[i];
+        if (uplink.length == 0) continue;
+
+        if (next < 0 || uplink.priority > _uplinks[next].priority ||
+            (uplink.priority == _uplinks[next].priority &&
+             (int16_t)(uplink.order - _uplinks[next].order) < 0)) {
+            next = i;
+        }
+    }
+    return next;
+}
+
+void LoRaWAN_UplinkQueue::refillBudget() {
+    unsigned long now = millis();
+    uint32_t elapsed = now - _lastRefill;
+    _lastRefill = now;
+
+    // Budget auf den Betrachtungszeitraum begrenzen (1% von 1h = 36s Time-on-Air)
+    if (elapsed >= LORAWAN_DUTY_CYCLE_WINDOW_MS - _airtimeBudget) {
+        _airtimeBudget = LORAWAN_DUTY_CYCLE_WINDOW_MS;
+    } else {
+        _airtimeBudget += elapsed;
+    }
+}
+
+void LoRaWAN_UplinkQueue::onUplinkComplete(LoRaWAN_ATResult result, const char* line, void* context) {
+    static_cast<LoRaWAN_UplinkQueue*>(context)->completeUplink(result);
+}
+
+void LoRaWAN_UplinkQueue::completeUplink(LoRaWAN_ATResult result) {
+    if (_inFlightIndex < 0) return;
+
+    // Neuerer Wert für den Kanal, der während des Sendens eingereiht wurde
+    LoRaWAN_Uplink& uplink = _uplinks[_inFlightIndex];
+    bool superseded = findCoalesce(uplink.channel) >= 0;
+    uplink.inFlight = false;
+    _inFlightIndex = -1;
+
+    if (result == LORAWAN_AT_NO_BAND) {
+        // Nicht gesendet: Sendezeit zurückbuchen, ohne eine Wiederholung zu verbrauchen
+        refillBudget();
+        _airtimeBudget = (_inFlightCost >= LORAWAN_DUTY_CYCLE_WINDOW_MS - _airtimeBudget)
+                         ? LORAWAN_DUTY_CYCLE_WINDOW_MS : _airtimeBudget + _inFlightCost;
+        if (!superseded) return;
+    } else if (result != LORAWAN_AT_OK && uplink.retries < LORAWAN_UPLINK_MAX_RETRIES && !superseded) {
+        // Erneut senden, außer es liegt bereits ein neuerer Wert für den Kanal vor
+        uplink.retries++;
+        return;
+    }
+
+    uplink.length = 0;
+}
+
+// ================================================================
+// DUTY-CYCLE UND TIME-ON-AIR
+// ================================================================
+
+uint32_t LoRaWAN_UplinkQueue::calcAirtimeMs(uint8_t payloadLength, LoRaWAN_DataRate dataRate,
+                                            LoRaWAN_Region region) {
+    uint16_t phyLength = payloadLength + LORAWAN_FRAME_OVERHEAD;
+
+    // Spreading Factor und Bandbreite (kHz) der Data Rate
+    uint8_t sf;
+    uint16_t bandwidth = 125;
+    if (region == LORAWAN_REGION_US915) {
+        // US915: DR0-3 = SF10-SF7 bei 125kHz, DR4 = SF8 bei 500kHz
+        if (dataRate >= LORAWAN_DR4) {
+            sf = 8;
+            bandwidth = 500;
+        } else {
+            sf = 10 - dataRate;
+        }
+    } else {
+        if (dataRate == LORAWAN_DR7) {
+            // FSK 50kbps: Präambel (5) + Sync (3) + Länge (1) + Payload + CRC (2), 20us je Bit
+            return ((uint32_t)(phyLength + 11) * 8 * 20 + 999) / 1000;
+        }
+        if (dataRate == LORAWAN_DR6) {
+            sf = 7;
+            bandwidth = 250;
+        } else {
+            sf = 12 - dataRate;
+        }
+    }
+
+    // Low Data Rate Optimization bei Symboldauer >= 16ms (SF11/SF12 bei 125kHz)
+    uint8_t lowDataRate = (bandwidth == 125 && sf >= 11) ? 1 : 0;
+    uint32_t symbolTimeUs = ((uint32_t)1 << sf) * 1000UL / bandwidth;
+
+    // Payload-Symbole bei Coding Rate 4/5, explizitem Header und CRC
+    int16_t numerator = 8 * phyLength - 4 * sf + 28 + 16;
+    int16_t denominator = 4 * (sf - 2 * lowDataRate);
+    uint16_t payloadSymbols = 8;
+    if (numerator > 0) {
+        payloadSymbols += ((numerator + denominator - 1) / denominator) * 5;
+    }
+
+    // Präambel mit 8 + 4.25 Symbolen, gerechnet in Viertel-Symbolen
+    uint32_t airtimeUs = ((uint32_t)payloadSymbols * 4 + 49) * symbolTimeUs / 4;
+    return (airtimeUs + 999) / 1000;
+}
+
+uint16_t LoRaWAN_UplinkQueue::getDutyCycleDivisor(LoRaWAN_Region region) {
+    switch (region) {
+        case LORAWAN_REGION_EU868: return 100;  // 1% in den Standard-Subbändern (ETSI EN 300 220)
+        case LORAWAN_REGION_AS923: return 100;  // 1%, soweit die Länder kein LBT nutzen
+        case LORAWAN_REGION_US915: return 0;    // Kein Duty-Cycle, nur 400ms Dwell Time (vom Modul geprüft)
+        default: return 100;
+    }
+}
+
+// ================================================================
+// STATUS
+// ================================================================
+
+uint8_t LoRaWAN_UplinkQueue::getPendingCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < LORAWAN_UPLINK_QUEUE_SIZE; i++) {
+        if (_uplinks[i].length > 0) count++;
+    }
+    return count;
+}
+
+uint32_t LoRaWAN_UplinkQueue::getAirtimeBudgetMs() {
+    uint16_t divisor = getDutyCycleDivisor(_lora.getConfig().region);
+    if (divisor == 0) return UINT32_MAX;
+
+    refillBudget();
+    return _airtimeBudget / divisor;
+}
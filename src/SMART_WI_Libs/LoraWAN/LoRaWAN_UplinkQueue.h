@@ -0,0 +1,132 @@
+/**
+ * LoRaWAN Uplink-Warteschlange
+ *
+ * Begrenzte Warteschlange für Uplinks über die asynchrone AT-Engine von LoRaWAN_WioE5:
+ * - Prioritäten: Alarme werden vor Routine-Telemetrie gesendet, innerhalb einer
+ *   Priorität in Reihenfolge des Einreihens
+ * - Zusammenfassen: ein neuer Messwert für einen Kanal ersetzt den noch nicht
+ *   gesendeten alten Wert dieses Kanals, statt zusätzliche Sendezeit zu belegen
+ * - Duty-Cycle: gesendet wird nur, wenn das Sendezeit-Budget der Region
+ *   (z.B. 1% in EU868) für die berechnete Time-on-Air ausreicht. Meldet das Modul
+ *   trotzdem "No band", wird der Uplink nach der genannten Wartezeit wiederholt
+ *
+ * Verwendung:
+ *   LoRaWAN_UplinkQueue uplinks(lora);
+ *   uplinks.enqueue(data, length, CHANNEL_TEMP1);
+ *   uplinks.enqueue(alarm, alarmLength, CHANNEL_ALARM, LORAWAN_PRIORITY_ALARM, 2, true);
+ *
+ *   void loop() {
+ *       lora.process();
+ *       uplinks.process();
+ *   }
+ */
+
+#ifndef LORAWAN_UPLINKQUEUE_H
+#define LORAWAN_UPLINKQUEUE_H
+
+#include "LoRaWAN_WioE5.h"
+
+#define LORAWAN_UPLINK_QUEUE_SIZE 6             // Max. Anzahl wartender Uplinks
+#define LORAWAN_UPLINK_PAYLOAD_SIZE 51          // Max. Payload je Uplink (garantiert bis DR0 in EU868)
+#define LORAWAN_UPLINK_MAX_RETRIES 2            // Wiederholungen nach Fehler, Timeout oder fehlendem ACK
+#define LORAWAN_UPLINK_NO_CHANNEL 0xFF          // Kanal für Uplinks, die nie zusammengefasst werden
+#define LORAWAN_DUTY_CYCLE_WINDOW_MS 3600000UL  // Betrachtungszeitraum des Duty-Cycles (1 Stunde)
+
+enum LoRaWAN_UplinkPriority {
+    LORAWAN_PRIORITY_ROUTINE,   // Regelmäßige Telemetrie
+    LORAWAN_PRIORITY_NORMAL,    // Ereignisse, Statusmeldungen
+    LORAWAN_PRIORITY_ALARM      // Alarme, werden immer zuerst gesendet
+};
+
+struct LoRaWAN_Uplink {
+    uint8_t payload[LORAWAN_UPLINK_PAYLOAD_SIZE];
+    uint8_t length;             // 0 = Platz frei
+    uint8_t port;
+    uint8_t channel;            // Uplinks mit gleichem Kanal werden zusammengefasst
+    LoRaWAN_UplinkPriority priority;
+    bool confirmed;
+    bool inFlight;              // An die AT-Engine übergeben, Payload darf nicht geändert werden
+    uint8_t retries;
+    uint16_t order;             // Reihenfolge des Einreihens innerhalb einer Priorität
+};
+
+class LoRaWAN_UplinkQueue {
+private:
+    LoRaWAN_WioE5& _lora;
+    LoRaWAN_Uplink _uplinks[LORAWAN_UPLINK_QUEUE_SIZE];
+    uint16_t _nextOrder;
+    int8_t _inFlightIndex;      // -1 = kein Uplink in Bearbeitung
+    uint32_t _inFlightCost;     // Vom Budget abgezogen, wird bei "No band" zurückgebucht
+
+    // Sendezeit-Budget als Token-Bucket: Einheit ist verdiente Wartezeit in ms,
+    // ein Uplink kostet Time-on-Air * Divisor des Duty-Cycles (100 bei 1%)
+    uint32_t _airtimeBudget;
+    unsigned long _lastRefill;
+
+    int8_t findNext();
+    int8_t findCoalesce(uint8_t channel);
+    int8_t findFree(LoRaWAN_UplinkPriority priority);
+    void refillBudget();
+    static void onUplinkComplete(LoRaWAN_ATResult result, const char* line, void* context);
+    void completeUplink(LoRaWAN_ATResult result);
+
+public:
+    /**
+     * Konstruktor
+     * @param lora Initialisierte LoRaWAN_WioE5-Instanz, deren process() zyklisch aufgerufen wird
+     */
+    LoRaWAN_UplinkQueue(LoRaWAN_WioE5& lora);
+
+    /**
+     * Reiht einen Uplink ein. Ein noch nicht gesendeter Uplink desselben Kanals wird
+     * durch den neuen ersetzt (Priorität ist das Maximum beider). Bei voller
+     * Warteschlange wird der älteste Uplink niedrigster Priorität verdrängt, sofern
+     * dessen Priorität nicht höher ist.
+     * @param data Payload, wird kopiert
+     * @param length Länge der Payload (max. LORAWAN_UPLINK_PAYLOAD_SIZE)
+     * @param channel Kanal zum Zusammenfassen oder LORAWAN_UPLINK_NO_CHANNEL
+     * @param priority Priorität des Uplinks
+     * @param port LoRaWAN-Port (1-223)
+     * @param confirmed Bestätigte Nachricht
+     * @return true wenn eingereiht oder zusammengefasst
+     */
+    bool enqueue(const uint8_t* data, uint8_t length, uint8_t channel = LORAWAN_UPLINK_NO_CHANNEL,
+                 LoRaWAN_UplinkPriority priority = LORAWAN_PRIORITY_ROUTINE,
+                 uint8_t port = 1, bool confirmed = false);
+
+    /**
+     * Übergibt den nächsten Uplink an die AT-Engine, sobald kein anderer in
+     * Bearbeitung ist und das Duty-Cycle-Budget reicht. Blockiert nie.
+     */
+    void process();
+
+    /**
+     * Berechnet die Time-on-Air eines Uplinks (LoRa nach Semtech AN1200.13, FSK für DR7)
+     * @param payloadLength Länge der Anwendungs-Payload in Bytes
+     * @param dataRate Data Rate
+     * @param region Region (bestimmt die Zuordnung von Data Rate zu SF/Bandbreite)
+     * @return Time-on-Air in Millisekunden (aufgerundet)
+     */
+    static uint32_t calcAirtimeMs(uint8_t payloadLength, LoRaWAN_DataRate dataRate, LoRaWAN_Region region);
+
+    /**
+     * Gibt den Divisor des Duty-Cycles einer Region zurück
+     * @param region Region
+     * @return 100 für 1% Duty-Cycle, 0 wenn die Region keinen Duty-Cycle vorschreibt
+     */
+    static uint16_t getDutyCycleDivisor(LoRaWAN_Region region);
+
+    /**
+     * Gibt die Anzahl wartender Uplinks zurück (inkl. des gerade gesendeten)
+     * @return Anzahl der Uplinks
+     */
+    uint8_t getPendingCount();
+
+    /**
+     * Gibt das aktuell verfügbare Sendezeit-Budget zurück
+     * @return Mögliche Time-on-Air in Millisekunden
+     */
+    uint32_t getAirtimeBudgetMs();
+};
+
+#endif // LORAWAN_UPLINKQUEUE_H
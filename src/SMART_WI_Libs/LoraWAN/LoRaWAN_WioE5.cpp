@@ -10,6 +10,39 @@
 
 #include "LoRaWAN_WioE5.h"
 
+// Feste Muster des Antwort-Matchers, werden im Konstruktor in dieser Reihenfolge angelegt.
+// Kommandospezifische Muster folgen ab URC_COUNT.
+static const char* const URC_PATTERNS[] = {
+    "ERROR",
+    "+JOIN: Network joined",
+    "+JOIN: Joined already",
+    "+JOIN: Join failed",
+    "MSGHEX: Start",            // +MSGHEX und +CMSGHEX
+    "MSGHEX: Done",
+    "RX: \"",                   // Downlink
+    "+PORT: ",
+    "No band"                   // Duty-Cycle: kein Kanal frei, Uplink nicht gesendet
+};
+
+enum {
+    URC_ERROR,
+    URC_JOINED,
+    URC_JOINED_ALREADY,
+    URC_JOIN_FAILED,
+    URC_SEND_START,
+    URC_SEND_DONE,
+    URC_DOWNLINK,
+    URC_PORT,
+    URC_NO_BAND,
+    URC_COUNT
+};
+
+#define URC_MASK(index) ((uint16_t)1 << (index))
+
+// Nibble-Tabelle für die Hex-Kodierung der Payload
+static const char HEX_DIGITS[16] PROGMEM = {'0', '1', '2', '3', '4', '5', '6', '7',
+                                            '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
 // ================================================================
 // KONSTRUKTOR UND DESTRUKTOR
 // ================================================================
@@ -38,9 +71,46 @@ LoRaWAN_WioE5::LoRaWAN_WioE5(HardwareSerial* serial, Stream* debugSerial) {
     _status.networkJoined = false;
     _status.messageCounter = 0;
     _status.lastSendTime = 0;
-    _status.hasDownlink = false;
-    _status.downlinkSize = 0;
-    _status.downlinkPort = 0;
+    
+    // Downlinks
+    memset(_downlinks, 0, sizeof(_downlinks));
+    memset(_downlinkRoutes, 0, sizeof(_downlinkRoutes));
+    _nextDownlinkOrder = 0;
+    _droppedDownlinks = 0;
+    _dispatching = false;
+    
+    // Asynchrone AT-Engine initialisieren
+    memset(_atQueue, 0, sizeof(_atQueue));
+    memset(_lineBuffer, 0, sizeof(_lineBuffer));
+    _atHead = 0;
+    _atCount = 0;
+    _lineLength = 0;
+    _lineMask = 0;
+    _expectedMask = 0;
+    _finalMask = 0;
+    _responseLength = 0;
+    _lineStart = 0;
+    _matchedLine = _responseBuffer;
+    _urcCallback = nullptr;
+    _urcContext = nullptr;
+    _uplinkPort = 0;
+    
+    // Fragmente und Duty-Cycle
+    memset(&_fragment, 0, sizeof(_fragment));
+    _fragmentActive = false;
+    _fragmentQueued = false;
+    _fragmentPort = 0;
+    _fragmentConfirmed = false;
+    _fragmentStart = 0;
+    _fragmentCallback = nullptr;
+    _fragmentContext = nullptr;
+    _noBandStart = 0;
+    _noBandWaitMs = 0;
+    _noBandPending = false;
+    
+    for (uint8_t i = 0; i < URC_COUNT; i++) {
+        _matcher.addPattern(URC_PATTERNS[i]);
+    }
 }
 
 LoRaWAN_WioE5::~LoRaWAN_WioE5() {
@@ -58,35 +128,47 @@ bool LoRaWAN_WioE5::sendATCommand(const char* command, const char* expectedRespo
 
 bool LoRaWAN_WioE5::sendATCommandSilent(const char* command, const char* expectedResponse, 
                                        unsigned long timeout) {
-    if (!_serial) return false;
-    
-    // Buffer leeren
-    memset(_responseBuffer, 0, sizeof(_responseBuffer));
-    clearInputBuffer();
+    if (!beginATCommand()) return false;
+    uint16_t expectedMask = expectedResponse ? addResponsePattern(expectedResponse) : 0;
     
     // Kommando senden (ohne Debug-Ausgabe)
     _serial->print(command);
     _serial->flush();
     
+    return awaitATResponse(expectedMask, timeout);
+}
+
+bool LoRaWAN_WioE5::beginATCommand() {
+    if (!_serial) return false;
+    
+    // Blockierende Kommandos würden die Antworten der asynchronen Kommandos verwerfen
+    if (isATBusy()) {
+        debugPrintln("[WARNING] Asynchrone AT-Kommandos aktiv - blockierendes Kommando abgelehnt");
+        return false;
+    }
+    
+    // Buffer leeren
+    beginResponse();
+    clearInputBuffer();
+    return true;
+}
+
+bool LoRaWAN_WioE5::awaitATResponse(uint16_t expectedMask, unsigned long timeout) {
     unsigned long startTime = millis();
-    int bufferIndex = 0;
-    bool dataReceived = false;
+    uint16_t mask;
+    char* line;
     
-    // Auf Antwort warten
-    while (millis() - startTime < timeout) {
-        while (_serial->available() > 0 && bufferIndex < sizeof(_responseBuffer) - 1) {
-            char c = _serial->read();
-            _responseBuffer[bufferIndex++] = c;
-            _responseBuffer[bufferIndex] = '\0';
-            dataReceived = true;
-        }
-        
-        // Prüfen ob erwartete Antwort empfangen
-        if (expectedResponse != nullptr && strstr(_responseBuffer, expectedResponse) != nullptr) {
+    // Auf Antwort warten, jedes Zeichen wird nur einmal vom Matcher betrachtet
+    while (readResponseLine(startTime, timeout, false, mask, line)) {
+        if (mask & expectedMask) {
+            _matchedLine = line;
             return true;
         }
         
-        delay(10);
+        // Fehlermeldung beendet das Warten vorzeitig
+        if (expectedMask && (mask & URC_MASK(URC_ERROR))) {
+            return false;
+        }
     }
     
     return false;
@@ -95,17 +177,60 @@ bool LoRaWAN_WioE5::sendATCommandSilent(const char* command, const char* expecte
 bool LoRaWAN_WioE5::waitForResponse(const char* expectedResponse, unsigned long timeout) {
     if (!_serial || !expectedResponse) return false;
     
+    // Empfang wird im bestehenden Puffer fortgesetzt, nur das erwartete Muster wird ersetzt
+    _matcher.removePatternsFrom(URC_COUNT);
+    uint16_t expectedMask = addResponsePattern(expectedResponse);
+    
     unsigned long startTime = millis();
-    int bufferIndex = strlen(_responseBuffer);
+    uint16_t mask;
+    char* line;
+    
+    while (readResponseLine(startTime, timeout, true, mask, line)) {
+        // Prüfen ob erwartete Antwort empfangen
+        if (mask & expectedMask) {
+            _matchedLine = line;
+            if (_debugSerial) {
+                _debugSerial->println();
+                _debugSerial->print("[RX] SUCCESS: ");
+                _debugSerial->println(expectedResponse);
+            }
+            return true;
+        }
+    }
     
+    return false;
+}
+
+void LoRaWAN_WioE5::beginResponse() {
+    _responseBuffer[0] = '\0';
+    _responseLength = 0;
+    _lineStart = 0;
+    _matchedLine = _responseBuffer;
+    
+    // Angefangene Zeile der asynchronen Engine wird mit dem Eingangspuffer verworfen
+    _lineLength = 0;
+    _lineMask = 0;
+    _matcher.reset();
+    _matcher.removePatternsFrom(URC_COUNT);
+}
+
+uint16_t LoRaWAN_WioE5::addResponsePattern(const char* pattern) {
+    int8_t index = _matcher.addPattern(pattern);
+    if (index < 0) {
+        debugPrintln("[ERROR] Antwortmuster passt nicht in den Matcher");
+        return 0;
+    }
+    return URC_MASK(index);
+}
+
+bool LoRaWAN_WioE5::readResponseLine(unsigned long startTime, unsigned long timeout, bool echo,
+                                     uint16_t& mask, char*& line) {
     while (millis() - startTime < timeout) {
-        while (_serial->available() > 0 && bufferIndex < sizeof(_responseBuffer) - 1) {
+        while (_serial->available() > 0) {
             char c = _serial->read();
-            _responseBuffer[bufferIndex++] = c;
-            _responseBuffer[bufferIndex] = '\0';
             
-            // Debug-Ausgabe
-            if (_debugSerial) {
+            // Echo zum Debug-Serial
+            if (echo && _debugSerial) {
                 if (c >= 32 && c <= 126) {
                     _debugSerial->print(c);
                 } else {
@@ -114,24 +239,69 @@ bool LoRaWAN_WioE5::waitForResponse(const char* expectedResponse, unsigned long
                     _debugSerial->print("]");
                 }
             }
-        }
-        
-        // Prüfen ob erwartete Antwort empfangen
-        if (strstr(_responseBuffer, expectedResponse) != nullptr) {
-            if (_debugSerial) {
-                _debugSerial->println();
-                _debugSerial->print("[RX] SUCCESS: ");
-                _debugSerial->println(expectedResponse);
+            
+            // Voller Puffer: bereits ausgewertete Zeilen verwerfen, die aktuelle Zeile bleibt erhalten
+            if (_responseLength >= sizeof(_responseBuffer) - 1 && _lineStart > 0) {
+                _responseLength -= _lineStart;
+                memmove(_responseBuffer, &_responseBuffer[_lineStart], _responseLength);
+                _lineStart = 0;
+            }
+            if (_responseLength < sizeof(_responseBuffer) - 1) {
+                _responseBuffer[_responseLength++] = c;
+            }
+            _responseBuffer[_responseLength] = '\0';
+            
+            if (c != '\n') {
+                if (c != '\r') {
+                    _lineMask |= _matcher.feed(c);
+                }
+                continue;
+            }
+            
+            // Zeile vollständig: Muster wurden bereits beim Empfang erkannt
+            line = &_responseBuffer[_lineStart];
+            mask = _lineMask;
+            bool emptyLine = (line[0] == '\r' || line[0] == '\n');
+            _lineStart = _responseLength;
+            _lineMask = 0;
+            _matcher.reset();
+            
+            if (!emptyLine) {
+                return true;
             }
-            return true;
         }
         
         delay(10);
     }
     
+    // Timeout: angefangene Zeile nicht in die nächste Auswertung übernehmen
+    _lineMask = 0;
+    _matcher.reset();
+    mask = 0;
+    line = nullptr;
     return false;
 }
 
+void LoRaWAN_WioE5::writeHexPayload(const uint8_t* data, size_t length) {
+    // Hex-Zeichen blockweise schreiben, ohne String und ohne Heap
+    char chunk[32];
+    uint8_t chunkLength = 0;
+    
+    for (size_t i = 0; i < length; i++) {
+        chunk[chunkLength++] = pgm_read_byte(&HEX_DIGITS[data[i] >> 4]);
+        chunk[chunkLength++] = pgm_read_byte(&HEX_DIGITS[data[i] & 0x0F]);
+        
+        if (chunkLength == sizeof(chunk)) {
+            _serial->write((const uint8_t*)chunk, chunkLength);
+            chunkLength = 0;
+        }
+    }
+    
+    if (chunkLength > 0) {
+        _serial->write((const uint8_t*)chunk, chunkLength);
+    }
+}
+
 void LoRaWAN_WioE5::clearInputBuffer() {
     if (!_serial) return;
     
@@ -152,6 +322,12 @@ void LoRaWAN_WioE5::debugPrintln(const char* message) {
     }
 }
 
+void LoRaWAN_WioE5::debugPrint(unsigned long value) {
+    if (_debugSerial) {
+        _debugSerial->print(value);
+    }
+}
+
 // ================================================================
 // PRIVATE KONFIGURATIONSMETHODEN
 // ================================================================
@@ -516,48 +692,29 @@ bool LoRaWAN_WioE5::joinNetwork() {
     // Auf Join-Bestätigung warten
     debugPrintln("[INFO] Warte auf Netzwerk-Join...");
     
+    beginResponse();
+    uint16_t doneMask = addResponsePattern("+JOIN: Done");
     unsigned long joinStartTime = millis();
-    memset(_responseBuffer, 0, sizeof(_responseBuffer));
-    int index = 0;
+    uint16_t mask;
+    char* line;
     
-    while (millis() - joinStartTime < LORAWAN_JOIN_TIMEOUT_MS) {
-        while (_serial->available() > 0 && index < sizeof(_responseBuffer) - 1) {
-            char c = _serial->read();
-            
-            // Echo zum Debug-Serial
-            if (_debugSerial) {
-                if (c >= 32 && c <= 126) {
-                    _debugSerial->print(c);
-                } else {
-                    _debugSerial->print("[");
-                    _debugSerial->print((int)c);
-                    _debugSerial->print("]");
-                }
-            }
-            
-            _responseBuffer[index++] = c;
-            _responseBuffer[index] = '\0';
-        }
-        
-        // Suche nach Erfolgs- oder Fehlermeldung
-        if (strstr(_responseBuffer, "+JOIN: Network joined") != nullptr || 
-            strstr(_responseBuffer, "+JOIN: Joined") != nullptr) {
+    while (readResponseLine(joinStartTime, LORAWAN_JOIN_TIMEOUT_MS, true, mask, line)) {
+        // Erfolgs- oder Fehlermeldung in der aktuellen Zeile
+        if (mask & (URC_MASK(URC_JOINED) | URC_MASK(URC_JOINED_ALREADY))) {
             debugPrintln("\n[OK] Erfolgreich mit LoRaWAN Netzwerk verbunden");
             _status.networkJoined = true;
             return true;
         }
         
-        if (strstr(_responseBuffer, "+JOIN: Join failed") != nullptr) {
+        if (mask & URC_MASK(URC_JOIN_FAILED)) {
             debugPrintln("\n[ERROR] Netzwerk-Join fehlgeschlagen");
             return false;
         }
         
-        if (strstr(_responseBuffer, "+JOIN: Done") != nullptr) {
+        if (mask & doneMask) {
             debugPrintln("\n[ERROR] Join-Prozess beendet, aber kein Erfolg");
             return false;
         }
-        
-        delay(100);
     }
     
     debugPrintln("\n[ERROR] Timeout beim Warten auf Join-Antwort");
@@ -580,82 +737,140 @@ bool LoRaWAN_WioE5::sendMessage(const char* message, uint8_t port, bool confirme
     debugPrint(": ");
     debugPrintln(message);
     
-    // Nachricht in Hex umwandeln
-    String hexMessage = "";
-    for (int i = 0; i < strlen(message); i++) {
-        char hex[3];
-        sprintf(hex, "%02X", message[i]);
-        hexMessage += hex;
-    }
-    
-    return sendHexData(hexMessage.c_str(), port, confirmed);
+    // Text wird beim Senden direkt als Hex kodiert
+    return sendBinaryData((const uint8_t*)message, strlen(message), port, confirmed);
 }
 
 bool LoRaWAN_WioE5::sendHexData(const char* hexData, uint8_t port, bool confirmed) {
     if (!_status.moduleReady || !hexData) return false;
     
-    // Clear previous downlink data
-    _status.hasDownlink = false;
-    _status.downlinkSize = 0;
-    _status.downlinkPort = 0;
+    return sendUplink(hexData, nullptr, 0, confirmed);
+}
+
+bool LoRaWAN_WioE5::sendBinaryData(const uint8_t* data, size_t length, uint8_t port, bool confirmed) {
+    if (!_status.moduleReady || !data || length == 0) return false;
+    
+    // Der Fragmenter ist mit der asynchronen Nachricht belegt
+    if (_fragmentActive) {
+        debugPrintln("[WARNING] Fragmentierte Nachricht wird noch gesendet - Nachricht abgelehnt");
+        return false;
+    }
+    
+    size_t maxPayloadSize = getMaxPayloadSize();
+    if (length <= maxPayloadSize) {
+        return sendUplink(nullptr, data, length, confirmed);
+    }
     
-    // AT-Kommando für Nachrichtenversand zusammenstellen
-    char command[256];
-    if (confirmed) {
-        sprintf(command, "AT+CMSG=%s\r\n", hexData);
+    if (!_fragmenter.begin(data, length, maxPayloadSize)) {
+        debugPrintln("[ERROR] Payload zu groß");
+        return false;
+    }
+    
+    debugPrint("[INFO] Payload wird in ");
+    debugPrint((unsigned long)_fragmenter.getCount());
+    debugPrintln(" Fragmente aufgeteilt");
+    
+    // Fragmente nacheinander senden, der Header wird vor den Daten direkt als Hex geschrieben.
+    // Bei "No band" wird nicht blockierend gewartet, der Empfänger verwirft die unvollständige Nachricht
+    LoRaWAN_Fragment fragment;
+    while (_fragmenter.next(fragment)) {
+        if (!sendUplink(nullptr, fragment.data, fragment.length, confirmed,
+                        fragment.header, LORAWAN_FRAGMENT_HEADER_SIZE)) {
+            debugPrintln("[ERROR] Fragmentierte Nachricht abgebrochen");
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t LoRaWAN_WioE5::getMaxPayloadSize() {
+    // Mit ADR kann das Netzwerk die Data Rate seit der Konfiguration geändert haben
+    return getMaxPayloadSize(_config.adaptiveDataRate ? queryDataRate() : _config.dataRate);
+}
+
+uint8_t LoRaWAN_WioE5::getMaxPayloadSize(LoRaWAN_DataRate dataRate) {
+    // Max. Payload je Data Rate (LoRaWAN Regional Parameters, ohne FOpts)
+    static const uint8_t MAX_PAYLOAD_EU868[8] PROGMEM = {51, 51, 51, 115, 242, 242, 242, 242};
+    static const uint8_t MAX_PAYLOAD_US915[5] PROGMEM = {11, 53, 125, 242, 242};
+    
+    if (_config.region == LORAWAN_REGION_US915) {
+        return pgm_read_byte(&MAX_PAYLOAD_US915[dataRate <= LORAWAN_DR4 ? dataRate : LORAWAN_DR0]);
+    }
+    // AS923 erlaubt ohne Dwell-Time-Grenze mehr, die EU868-Werte sind die sichere Untergrenze
+    return pgm_read_byte(&MAX_PAYLOAD_EU868[dataRate]);
+}
+
+LoRaWAN_DataRate LoRaWAN_WioE5::queryDataRate() {
+    // Antwort z.B. "+DR: DR3", bei Fehler die konfigurierte Data Rate verwenden
+    if (sendATCommandSilent("AT+DR\r\n", "+DR: DR")) {
+        const char* value = strstr(_matchedLine, "+DR: DR");
+        if (value && value[7] >= '0' && value[7] <= '7') {
+            return (LoRaWAN_DataRate)(value[7] - '0');
+        }
+    }
+    return _config.dataRate;
+}
+
+bool LoRaWAN_WioE5::sendUplink(const char* hexData, const uint8_t* data, size_t length, bool confirmed,
+                               const uint8_t* header, uint8_t headerLength) {
+    if (!beginATCommand()) {
+        debugPrintln("[ERROR] Nachricht konnte nicht gesendet werden");
+        return false;
+    }
+    
+    // AT-Kommando direkt auf die Schnittstelle schreiben, Binärdaten werden dabei als Hex kodiert
+    _serial->print(confirmed ? "AT+CMSGHEX=" : "AT+MSGHEX=");
+    if (header) {
+        writeHexPayload(header, headerLength);
+    }
+    if (data) {
+        writeHexPayload(data, length);
     } else {
-        sprintf(command, "AT+MSGHEX=%s\r\n", hexData);
+        _serial->print(hexData);
     }
+    _serial->print("\r\n");
+    _serial->flush();
     
-    // Nachricht senden
-    if (!sendATCommand(command, confirmed ? "+CMSG: Start" : "+MSGHEX: Start", 3000)) {
+    // Nachricht senden, ohne freien Kanal antwortet das Modul mit "No band"
+    if (!awaitATResponse(URC_MASK(URC_SEND_START) | URC_MASK(URC_NO_BAND), 3000)) {
         debugPrintln("[ERROR] Nachricht konnte nicht gesendet werden");
         return false;
     }
+    if (strstr(_matchedLine, "No band")) {
+        setNoBand(_matchedLine);
+        return false;
+    }
     
     // Auf Sendbestätigung warten und auf Downlink prüfen
-    memset(_responseBuffer, 0, sizeof(_responseBuffer));
+    beginResponse();
+    uint16_t doneMask = URC_MASK(URC_SEND_DONE);
     unsigned long startTime = millis();
-    int index = 0;
     bool sendSuccess = false;
+    uint16_t mask;
+    char* line;
     
-    while (millis() - startTime < LORAWAN_SEND_TIMEOUT_MS) {
-        while (_serial->available() > 0 && index < sizeof(_responseBuffer) - 1) {
-            char c = _serial->read();
-            
-            // Echo zum Debug-Serial
-            if (_debugSerial) {
-                if (c >= 32 && c <= 126) {
-                    _debugSerial->print(c);
-                } else {
-                    _debugSerial->print("[");
-                    _debugSerial->print((int)c);
-                    _debugSerial->print("]");
-                }
-            }
-            
-            _responseBuffer[index++] = c;
-            _responseBuffer[index] = '\0';
+    while (readResponseLine(startTime, LORAWAN_SEND_TIMEOUT_MS, true, mask, line)) {
+        // Downlink wird direkt aus seiner Zeile gelesen
+        if (mask & URC_MASK(URC_DOWNLINK)) {
+            parseDownlinkMessage(line);
         }
         
         // Prüfe auf Sendbestätigung
-        const char* expectedDone = confirmed ? "+CMSG: Done" : "+MSGHEX: Done";
-        if (strstr(_responseBuffer, expectedDone) != nullptr) {
+        if (mask & doneMask) {
             sendSuccess = true;
             debugPrintln("[OK] Sendbestätigung erhalten");
-            
-            // Prüfe auf Downlink-Nachricht
-            parseDownlinkMessage(_responseBuffer);
             break;
         }
         
         // Prüfe auf Fehler
-        if (strstr(_responseBuffer, "ERROR") != nullptr) {
+        if (mask & URC_MASK(URC_ERROR)) {
             debugPrintln("[ERROR] Sendung fehlgeschlagen");
             return false;
         }
-        
-        delay(100);
+        if (mask & URC_MASK(URC_NO_BAND)) {
+            setNoBand(line);
+            return false;
+        }
     }
     
     if (!sendSuccess) {
@@ -666,41 +881,434 @@ bool LoRaWAN_WioE5::sendHexData(const char* hexData, uint8_t port, bool confirme
     _status.messageCounter++;
     _status.lastSendTime = millis();
     
-    // Zeige Downlink-Informationen an
-    if (_status.hasDownlink) {
-        debugPrint("[INFO] Downlink empfangen auf Port ");
-        debugPrint(String(_status.downlinkPort).c_str());
-        debugPrint(", Größe: ");
-        debugPrint(String(_status.downlinkSize).c_str());
-        debugPrintln(" bytes");
+    debugPrintln("[OK] Nachricht erfolgreich gesendet");
+    
+    // Im Uplink empfangene Downlinks an ihre Handler übergeben
+    dispatchDownlinks();
+    return true;
+}
+
+// ================================================================
+// ASYNCHRONE AT-ENGINE
+// ================================================================
+
+void LoRaWAN_WioE5::process() {
+    if (!_serial) return;
+    
+    // Empfangene Zeichen zeilenweise sammeln, ausgewertet wird nur die jeweils vollständige Zeile
+    while (_serial->available() > 0) {
+        char c = _serial->read();
         
-        if (_debugSerial) {
-            _debugSerial->print("[DEBUG] Downlink Hex: ");
-            for (size_t i = 0; i < _status.downlinkSize; i++) {
-                if (_status.downlinkData[i] < 0x10) _debugSerial->print("0");
-                _debugSerial->print(_status.downlinkData[i], HEX);
-                _debugSerial->print(" ");
+        if (c == '\r') continue;
+        
+        if (c == '\n') {
+            if (_lineLength > 0) {
+                _lineBuffer[_lineLength] = '\0';
+                uint16_t mask = _lineMask;
+                _lineLength = 0;
+                _lineMask = 0;
+                _matcher.reset();
+                handleATLine(_lineBuffer, mask);
             }
-            _debugSerial->println();
+            continue;
+        }
+        
+        // Zu lange Zeilen werden abgeschnitten, das Zeilenende wird trotzdem erkannt
+        if (_lineLength < sizeof(_lineBuffer) - 1) {
+            _lineBuffer[_lineLength++] = c;
         }
+        
+        // Muster werden beim Empfang erkannt, die Zeile muss danach nicht mehr durchsucht werden
+        _lineMask |= _matcher.feed(c);
     }
     
-    debugPrintln("[OK] Nachricht erfolgreich gesendet");
+    // Timeout des aktiven Kommandos prüfen
+    if (_atCount > 0 && _atQueue[_atHead].state == LORAWAN_AT_WAITING &&
+        millis() - _atQueue[_atHead].startTime >= _atQueue[_atHead].timeout) {
+        finishATCommand(LORAWAN_AT_TIMEOUT, nullptr);
+    }
+    
+    // Nächstes Fragment einreihen, sobald das vorherige gesendet und ein Kanal frei ist
+    processFragments();
+    
+    // Nächstes Kommando senden (auch direkt nach Abschluss des vorherigen)
+    if (_atCount > 0 && _atQueue[_atHead].state == LORAWAN_AT_QUEUED) {
+        startATCommand(_atQueue[_atHead]);
+    }
+    
+    // Rest des aktiven Kommandos schreiben, soweit der Sendepuffer Platz hat
+    if (_atCount > 0 && _atQueue[_atHead].state == LORAWAN_AT_SENDING) {
+        continueATCommand(_atQueue[_atHead]);
+    }
+    
+    // Handler erst nach der Zeilenauswertung aufrufen, damit sie neue Kommandos einreihen können
+    dispatchDownlinks();
+}
+
+bool LoRaWAN_WioE5::queueATCommand(const char* command, const char* expectedResponse,
+                                   const char* finalResponse, unsigned long timeout,
+                                   LoRaWAN_ATCallback callback, void* context) {
+    if (!command || (!expectedResponse && !finalResponse)) return false;
+    
+    if ((expectedResponse && strlen(expectedResponse) > LORAWAN_AT_PATTERN_SIZE) ||
+        (finalResponse && strlen(finalResponse) > LORAWAN_AT_PATTERN_SIZE)) {
+        debugPrintln("[ERROR] Erwartete Antwort zu lang für den Matcher");
+        return false;
+    }
+    
+    if (_atCount >= LORAWAN_AT_QUEUE_SIZE) {
+        debugPrintln("[WARNING] AT-Warteschlange voll");
+        return false;
+    }
+    
+    if (strlen(command) >= LORAWAN_AT_COMMAND_SIZE) {
+        debugPrintln("[ERROR] AT-Kommando zu lang für die Warteschlange");
+        return false;
+    }
+    
+    LoRaWAN_ATCommand& cmd = _atQueue[(_atHead + _atCount) % LORAWAN_AT_QUEUE_SIZE];
+    strcpy(cmd.command, command);
+    cmd.payload = nullptr;
+    cmd.binaryPayload = nullptr;
+    cmd.binaryLength = 0;
+    cmd.binaryHeader = nullptr;
+    cmd.binaryHeaderLength = 0;
+    cmd.expectedResponse = expectedResponse;
+    cmd.finalResponse = finalResponse;
+    cmd.sendLength = 0;
+    cmd.sentLength = 0;
+    cmd.timeout = timeout;
+    cmd.startTime = 0;
+    cmd.callback = callback;
+    cmd.context = context;
+    cmd.state = LORAWAN_AT_QUEUED;
+    cmd.expectedSeen = false;
+    _atCount++;
+    
     return true;
 }
 
-bool LoRaWAN_WioE5::sendBinaryData(const uint8_t* data, size_t length, uint8_t port, bool confirmed) {
-    if (!data || length == 0) return false;
+bool LoRaWAN_WioE5::joinNetworkAsync(LoRaWAN_ATCallback callback, void* context) {
+    if (_config.mode == LORAWAN_MODE_ABP) {
+        // ABP-Modus - kein Join erforderlich
+        _status.networkJoined = true;
+        if (callback) {
+            callback(LORAWAN_AT_OK, nullptr, context);
+        }
+        return true;
+    }
     
-    // Binärdaten in Hex-String umwandeln
-    String hexString = "";
-    for (size_t i = 0; i < length; i++) {
-        char hex[3];
-        sprintf(hex, "%02X", data[i]);
-        hexString += hex;
+    // "+JOIN: Joined already" wird in handleURC() als Erfolg gewertet
+    return queueATCommand("AT+JOIN", "+JOIN: Network joined", "+JOIN: Done",
+                          LORAWAN_JOIN_TIMEOUT_MS, callback, context);
+}
+
+bool LoRaWAN_WioE5::sendHexDataAsync(const char* hexData, uint8_t port, bool confirmed,
+                                     LoRaWAN_ATCallback callback, void* context) {
+    if (!_status.moduleReady || !hexData) return false;
+    
+    return queueUplink(hexData, nullptr, 0, port, confirmed, callback, context);
+}
+
+bool LoRaWAN_WioE5::sendBinaryDataAsync(const uint8_t* data, size_t length, uint8_t port, bool confirmed,
+                                        LoRaWAN_ATCallback callback, void* context) {
+    if (!_status.moduleReady || !data || length == 0) return false;
+    
+    // Die Data Rate wird nicht blockierend abgefragt, mit ADR gilt die kleinste Payload der Region
+    uint8_t maxPayloadSize = getMaxPayloadSize(_config.adaptiveDataRate ? LORAWAN_DR0 : _config.dataRate);
+    if (length <= maxPayloadSize) {
+        return queueUplink(nullptr, data, (uint8_t)length, port, confirmed, callback, context);
+    }
+    
+    if (_fragmentActive) {
+        debugPrintln("[WARNING] Fragmentierte Nachricht wird noch gesendet - Nachricht abgelehnt");
+        return false;
+    }
+    
+    if (!_fragmenter.begin(data, length, maxPayloadSize)) {
+        debugPrintln("[ERROR] Payload zu groß");
+        return false;
+    }
+    _fragmenter.next(_fragment);
+    _fragmentActive = true;
+    _fragmentQueued = false;
+    _fragmentPort = port;
+    _fragmentConfirmed = confirmed;
+    _fragmentStart = millis();
+    _fragmentCallback = callback;
+    _fragmentContext = context;
+    
+    // Erstes Fragment sofort einreihen, bei voller Warteschlange folgt es mit process()
+    processFragments();
+    return true;
+}
+
+void LoRaWAN_WioE5::processFragments() {
+    if (!_fragmentActive || _fragmentQueued || getNoBandWaitMs() > 0) return;
+    
+    // Der Empfänger verwirft unvollständige Nachrichten nach LORAWAN_FRAGMENT_TIMEOUT_MS
+    if (millis() - _fragmentStart > LORAWAN_FRAGMENT_TIMEOUT_MS) {
+        debugPrintln("[ERROR] Fragmentierte Nachricht abgebrochen, kein freier Kanal");
+        finishFragments(LORAWAN_AT_NO_BAND, nullptr);
+        return;
+    }
+    
+    // Der Header liegt in _fragment und bleibt bis zum Callback gültig
+    if (queueUplink(nullptr, _fragment.data, _fragment.length, _fragmentPort, _fragmentConfirmed,
+                    onFragmentComplete, this, _fragment.header, LORAWAN_FRAGMENT_HEADER_SIZE)) {
+        _fragmentQueued = true;
+    }
+}
+
+void LoRaWAN_WioE5::onFragmentComplete(LoRaWAN_ATResult result, const char* line, void* context) {
+    LoRaWAN_WioE5* lora = static_cast<LoRaWAN_WioE5*>(context);
+    lora->_fragmentQueued = false;
+    
+    // Nicht gesendet: dasselbe Fragment nach der Wartezeit erneut einreihen
+    if (result == LORAWAN_AT_NO_BAND) return;
+    
+    // Ohne ein Fragment ist die Nachricht für den Empfänger wertlos
+    if (result != LORAWAN_AT_OK) {
+        lora->finishFragments(result, line);
+        return;
+    }
+    
+    if (!lora->_fragmenter.next(lora->_fragment)) {
+        lora->finishFragments(LORAWAN_AT_OK, line);
+    }
+}
+
+void LoRaWAN_WioE5::finishFragments(LoRaWAN_ATResult result, const char* line) {
+    LoRaWAN_ATCallback callback = _fragmentCallback;
+    void* context = _fragmentContext;
+    
+    // Erst freigeben, damit der Callback die nächste Nachricht senden kann
+    _fragmentActive = false;
+    _fragmentCallback = nullptr;
+    _fragmentContext = nullptr;
+    
+    if (callback) {
+        callback(result, line, context);
+    }
+}
+
+bool LoRaWAN_WioE5::queueUplink(const char* hexData, const uint8_t* data, uint8_t length, uint8_t port,
+                                bool confirmed, LoRaWAN_ATCallback callback, void* context,
+                                const uint8_t* header, uint8_t headerLength) {
+    // Port nur bei Änderung setzen, dafür wird ein zusätzlicher Platz benötigt
+    bool setPort = (port != _uplinkPort);
+    if (getATQueueFree() < (setPort ? 2 : 1)) {
+        debugPrintln("[WARNING] AT-Warteschlange voll - Nachricht nicht eingereiht");
+        return false;
+    }
+    
+    if (setPort) {
+        char command[16];
+        sprintf(command, "AT+PORT=%u", port);
+        queueATCommand(command, "+PORT:");
+    }
+    
+    // Bestätigte Nachrichten ohne ACK enden mit LORAWAN_AT_FAILED, damit sie wiederholt werden
+    if (!queueATCommand(confirmed ? "AT+CMSGHEX=" : "AT+MSGHEX=",
+                        confirmed ? "+CMSGHEX: ACK Received" : nullptr,
+                        confirmed ? "+CMSGHEX: Done" : "+MSGHEX: Done",
+                        LORAWAN_SEND_TIMEOUT_MS, callback, context)) {
+        return false;
+    }
+    
+    // Payload wird beim Senden direkt hinter das Kommando geschrieben
+    LoRaWAN_ATCommand& cmd = _atQueue[(_atHead + _atCount - 1) % LORAWAN_AT_QUEUE_SIZE];
+    cmd.payload = hexData;
+    cmd.binaryPayload = data;
+    cmd.binaryLength = length;
+    cmd.binaryHeader = header;
+    cmd.binaryHeaderLength = headerLength;
+    return true;
+}
+
+void LoRaWAN_WioE5::setURCHandler(LoRaWAN_URCCallback callback, void* context) {
+    _urcCallback = callback;
+    _urcContext = context;
+}
+
+bool LoRaWAN_WioE5::isATBusy() {
+    return _atCount > 0;
+}
+
+uint8_t LoRaWAN_WioE5::getATQueueFree() {
+    return LORAWAN_AT_QUEUE_SIZE - _atCount;
+}
+
+uint32_t LoRaWAN_WioE5::getNoBandWaitMs() {
+    uint32_t elapsed = millis() - _noBandStart;
+    return (elapsed >= _noBandWaitMs) ? 0 : _noBandWaitMs - elapsed;
+}
+
+void LoRaWAN_WioE5::setNoBand(const char* line) {
+    // z.B. "+MSGHEX: No band in 2345ms"
+    const char* value = strstr(line, "No band in ");
+    uint32_t waitMs = value ? strtoul(value + 11, nullptr, 10) : 0;
+    _noBandWaitMs = (waitMs > 0) ? waitMs : LORAWAN_NO_BAND_MIN_WAIT_MS;
+    _noBandStart = millis();
+    _noBandPending = true;
+    
+    debugPrint("[WARNING] Kein freier Kanal (Duty-Cycle), Wartezeit ms: ");
+    debugPrint((unsigned long)_noBandWaitMs);
+    debugPrintln("");
+}
+
+void LoRaWAN_WioE5::startATCommand(LoRaWAN_ATCommand& cmd) {
+    // Eine Payload mit 242 Bytes sind 484 Hex-Zeichen, bei 9600 Baud rund 500 ms.
+    // Daher wird nur geschrieben, was ohne Warten in den Sendepuffer passt, den Rest schreibt process()
+    uint16_t payloadLength = 0;
+    if (cmd.binaryPayload) {
+        payloadLength = 2 * (cmd.binaryHeaderLength + cmd.binaryLength);
+    } else if (cmd.payload) {
+        payloadLength = strlen(cmd.payload);
+    }
+    cmd.sendLength = strlen(cmd.command) + payloadLength + 2;
+    cmd.sentLength = 0;
+    
+    // Muster des Kommandos hinter den festen Mustern anlegen
+    _matcher.removePatternsFrom(URC_COUNT);
+    _expectedMask = cmd.expectedResponse ? addResponsePattern(cmd.expectedResponse) : 0;
+    _finalMask = cmd.finalResponse ? addResponsePattern(cmd.finalResponse) : 0;
+    
+    cmd.state = LORAWAN_AT_SENDING;
+    cmd.expectedSeen = false;
+    continueATCommand(cmd);
+}
+
+void LoRaWAN_WioE5::continueATCommand(LoRaWAN_ATCommand& cmd) {
+    int space = _serial->availableForWrite();
+    while (space > 0 && cmd.sentLength < cmd.sendLength) {
+        _serial->write((uint8_t)getATCommandChar(cmd, cmd.sentLength++));
+        space--;
+    }
+    
+    // Timeout erst ab dem vollständigen Schreiben, die Antwort kann erst danach kommen
+    if (cmd.sentLength == cmd.sendLength) {
+        cmd.state = LORAWAN_AT_WAITING;
+        cmd.startTime = millis();
+    }
+}
+
+char LoRaWAN_WioE5::getATCommandChar(const LoRaWAN_ATCommand& cmd, uint16_t index) {
+    // Zeichenfolge: Kommando, Payload (Binärdaten als Hex), "\r\n"
+    uint16_t commandLength = strlen(cmd.command);
+    if (index < commandLength) {
+        return cmd.command[index];
+    }
+    index -= commandLength;
+    
+    uint16_t payloadLength = cmd.sendLength - commandLength - 2;
+    if (index >= payloadLength) {
+        return index == payloadLength ? '\r' : '\n';
+    }
+    if (cmd.binaryPayload) {
+        uint16_t offset = index / 2;
+        uint8_t value = (offset < cmd.binaryHeaderLength) ? cmd.binaryHeader[offset]
+                                                          : cmd.binaryPayload[offset - cmd.binaryHeaderLength];
+        return pgm_read_byte(&HEX_DIGITS[(index & 1) ? (value & 0x0F) : (value >> 4)]);
+    }
+    return cmd.payload[index];
+}
+
+void LoRaWAN_WioE5::handleATLine(const char* line, uint16_t mask) {
+    // Statusmeldungen unabhängig vom aktiven Kommando auswerten
+    handleURC(line, mask);
+    
+    if (_urcCallback) {
+        _urcCallback(line, _urcContext);
+    }
+    
+    if (_atCount == 0) return;
+    
+    LoRaWAN_ATCommand& cmd = _atQueue[_atHead];
+    if (cmd.state != LORAWAN_AT_WAITING) return;
+    
+    if (mask & URC_MASK(URC_ERROR)) {
+        finishATCommand(LORAWAN_AT_ERROR, line);
+        return;
     }
     
-    return sendHexData(hexString.c_str(), port, confirmed);
+    // Uplink wegen Duty-Cycle nicht gesendet, die Wartezeit wurde in handleURC() übernommen
+    if (mask & URC_MASK(URC_NO_BAND)) {
+        finishATCommand(LORAWAN_AT_NO_BAND, line);
+        return;
+    }
+    
+    if (!cmd.expectedSeen && (mask & _expectedMask)) {
+        cmd.expectedSeen = true;
+        if (!cmd.finalResponse) {
+            finishATCommand(LORAWAN_AT_OK, line);
+            return;
+        }
+    }
+    
+    if (mask & _finalMask) {
+        bool success = !cmd.expectedResponse || cmd.expectedSeen;
+        finishATCommand(success ? LORAWAN_AT_OK : LORAWAN_AT_FAILED, line);
+    }
+}
+
+void LoRaWAN_WioE5::handleURC(const char* line, uint16_t mask) {
+    // Join-Meldungen
+    if (mask & URC_MASK(URC_JOINED)) {
+        _status.networkJoined = true;
+        debugPrintln("[OK] Erfolgreich mit LoRaWAN Netzwerk verbunden");
+    } else if (mask & URC_MASK(URC_JOINED_ALREADY)) {
+        _status.networkJoined = true;
+        // Auf AT+JOIN folgt in diesem Fall kein "+JOIN: Done"
+        if (_atCount > 0 && _atQueue[_atHead].state == LORAWAN_AT_WAITING &&
+            strcmp(_atQueue[_atHead].command, "AT+JOIN") == 0) {
+            finishATCommand(LORAWAN_AT_OK, line);
+        }
+    } else if (mask & URC_MASK(URC_JOIN_FAILED)) {
+        _status.networkJoined = false;
+        debugPrintln("[ERROR] Netzwerk-Join fehlgeschlagen");
+    }
+    
+    // Uplink-Meldungen
+    else if (mask & URC_MASK(URC_SEND_START)) {
+        _noBandPending = false;
+    } else if (mask & URC_MASK(URC_NO_BAND)) {
+        setNoBand(line);
+    } else if (mask & URC_MASK(URC_SEND_DONE)) {
+        if (!_noBandPending) {
+            _status.messageCounter++;
+            _status.lastSendTime = millis();
+        }
+        _noBandPending = false;
+    } else if (mask & URC_MASK(URC_DOWNLINK)) {
+        parseDownlinkMessage(line);
+    } else if (mask & URC_MASK(URC_PORT)) {
+        _uplinkPort = (uint8_t)atoi(strstr(line, "+PORT: ") + 7);
+    }
+}
+
+void LoRaWAN_WioE5::finishATCommand(LoRaWAN_ATResult result, const char* line) {
+    LoRaWAN_ATCommand& cmd = _atQueue[_atHead];
+    LoRaWAN_ATCallback callback = cmd.callback;
+    void* context = cmd.context;
+    
+    if (result == LORAWAN_AT_TIMEOUT) {
+        debugPrint("[ERROR] Timeout bei AT-Kommando ");
+        debugPrintln(cmd.command);
+    }
+    
+    // Muster des Kommandos entfernen
+    _matcher.removePatternsFrom(URC_COUNT);
+    _expectedMask = 0;
+    _finalMask = 0;
+    
+    // Erst austragen, damit der Callback neue Kommandos einreihen kann
+    _atHead = (_atHead + 1) % LORAWAN_AT_QUEUE_SIZE;
+    _atCount--;
+    
+    if (callback) {
+        callback(result, line, context);
+    }
 }
 
 // ================================================================
@@ -716,45 +1324,21 @@ LoRaWAN_Config LoRaWAN_WioE5::getConfig() {
 }
 
 bool LoRaWAN_WioE5::getRealDeviceEUI(char* buffer) {
-    if (!buffer) return false;
+    if (!buffer || isATBusy()) return false;
     
     // DevEUI-Abfrage mit erweitertem Timeout
-    memset(_responseBuffer, 0, sizeof(_responseBuffer));
+    beginResponse();
+    uint16_t deveuiMask = addResponsePattern("+ID: DevEui, ");
     _serial->print("AT+ID=DevEui\r\n");
     
     unsigned long startTime = millis();
-    int index = 0;
-    
-    while (millis() - startTime < 8000 && index < sizeof(_responseBuffer) - 1) {
-        while (_serial->available()) {
-            char c = _serial->read();
-            _responseBuffer[index++] = c;
-            _responseBuffer[index] = '\0';
-        }
-        
-        // Stoppe wenn komplette DevEUI empfangen
-        if (strstr(_responseBuffer, "+ID: DevEui, ") != nullptr) {
-            char* deveuiStart = strstr(_responseBuffer, "+ID: DevEui, ");
-            if (deveuiStart != nullptr && strlen(deveuiStart) >= 36) {
-                // Zusätzlich warten für eventuelle nachkommende Zeichen
-                delay(500);
-                while (_serial->available() && index < sizeof(_responseBuffer) - 1) {
-                    char c = _serial->read();
-                    _responseBuffer[index++] = c;
-                    _responseBuffer[index] = '\0';
-                }
-                break;
-            }
-        }
-        
-        delay(10);
-    }
+    uint16_t mask;
+    char* line;
     
-    if (strstr(_responseBuffer, "+ID: DevEui") != nullptr) {
-        // DevEUI extrahieren
-        char* deveuiStart = strstr(_responseBuffer, "+ID: DevEui, ");
-        if (deveuiStart != nullptr) {
-            deveuiStart += 13; // Überspringe "+ID: DevEui, "
+    while (readResponseLine(startTime, 8000, false, mask, line)) {
+        if (mask & deveuiMask) {
+            // DevEUI aus der aktuellen Zeile extrahieren
+            const char* deveuiStart = strstr(line, "+ID: DevEui, ") + 13; // Überspringe "+ID: DevEui, "
             
             // Kopiere bis zu 16 Zeichen oder bis Zeilenende
             int i = 0;
@@ -775,8 +1359,8 @@ bool LoRaWAN_WioE5::getFirmwareVersion(char* buffer) {
     if (!buffer) return false;
     
     if (sendATCommand("AT+VER\r\n", "+VER:", 3000)) {
-        // Version extrahieren
-        char* versionStart = strstr(_responseBuffer, "+VER:");
+        // Version aus der erkannten Zeile extrahieren
+        const char* versionStart = strstr(_matchedLine, "+VER:");
         if (versionStart != nullptr) {
             versionStart += 5; // Überspringe "+VER:"
             
@@ -806,94 +1390,165 @@ uint16_t LoRaWAN_WioE5::getMessageCounter() {
 bool LoRaWAN_WioE5::parseDownlinkMessage(const char* response) {
     if (!response) return false;
     
-    // Suche nach Downlink-Pattern: "+CMSG: ACK Received" oder "+MSGHEX: RX" etc.
-    // WioE5 sendet Downlinks im Format: "+CMSG: PORT: XX; RX: "HEXDATA""
+    // WioE5 sendet Downlinks im Format: "+MSGHEX: PORT: XX; RX: "HEXDATA""
+    const char* rxStart = strstr(response, "RX: \"");
+    if (!rxStart) return false;
+    rxStart += 5; // Skip 'RX: "'
     
-    char* downlinkStart = nullptr;
+    const char* rxEnd = strchr(rxStart, '"');
+    if (!rxEnd) return false;
     
-    // Suche nach verschiedenen Downlink-Mustern
-    if ((downlinkStart = strstr(response, "+CMSG: PORT:")) != nullptr ||
-        (downlinkStart = strstr(response, "+MSGHEX: PORT:")) != nullptr) {
-        
-        // Port extrahieren
-        char* portStart = strstr(downlinkStart, "PORT: ");
-        if (portStart) {
-            portStart += 6; // Skip "PORT: "
-            _status.downlinkPort = (uint8_t)atoi(portStart);
+    // Port steht vor den Daten, Standard-Port wenn nicht angegeben
+    uint8_t port = 1;
+    const char* portStart = strstr(response, "PORT: ");
+    if (portStart && portStart < rxStart) {
+        port = (uint8_t)atoi(portStart + 6);
+    }
+    
+    size_t hexLen = rxEnd - rxStart;
+    if (hexLen == 0 || hexLen % 2 != 0 || port == 0) return false;
+    if (hexLen / 2 > LORAWAN_DOWNLINK_MAX_SIZE) {
+        debugPrintln("[WARNING] Downlink zu groß - verworfen");
+        _droppedDownlinks++;
+        return false;
+    }
+    
+    // Freien Platz suchen, bei voller Warteschlange den ältesten Downlink verdrängen
+    int8_t index = -1;
+    for (uint8_t i = 0; i < LORAWAN_DOWNLINK_QUEUE_SIZE; i++) {
+        if (_downlinks[i].port == 0) {
+            index = i;
+            break;
         }
-        
-        // Downlink-Daten extrahieren
-        char* rxStart = strstr(downlinkStart, "RX: \"");
-        if (rxStart) {
-            rxStart += 5; // Skip 'RX: "'
-            
-            // Hex-String bis zum schließenden Anführungszeichen lesen
-            char* rxEnd = strchr(rxStart, '"');
-            if (rxEnd) {
-                size_t hexLen = rxEnd - rxStart;
-                
-                // Hex-String in Bytes konvertieren
-                _status.downlinkSize = 0;
-                for (size_t i = 0; i < hexLen && i < 510 && _status.downlinkSize < 255; i += 2) {
-                    if (i + 1 < hexLen) {
-                        char hexByte[3] = {rxStart[i], rxStart[i + 1], '\0'};
-                        _status.downlinkData[_status.downlinkSize++] = (uint8_t)strtol(hexByte, nullptr, 16);
-                    }
-                }
-                
-                _status.hasDownlink = true;
-                return true;
-            }
+        if (index < 0 || (int16_t)(_downlinks[i].order - _downlinks[index].order) < 0) {
+            index = i;
         }
     }
+    LoRaWAN_Downlink& downlink = _downlinks[index];
+    if (downlink.port != 0) {
+        debugPrintln("[WARNING] Downlink-Warteschlange voll - ältester Downlink verworfen");
+        _droppedDownlinks++;
+    }
+    
+    // Hex-String direkt in den Platz dekodieren
+    for (size_t i = 0; i < hexLen; i += 2) {
+        char hexByte[3] = {rxStart[i], rxStart[i + 1], '\0'};
+        downlink.data[i / 2] = (uint8_t)strtol(hexByte, nullptr, 16);
+    }
+    downlink.size = (uint8_t)(hexLen / 2);
+    downlink.port = port;
+    downlink.order = _nextDownlinkOrder++;
+    
+    debugPrint("[INFO] Downlink empfangen auf Port ");
+    debugPrint((unsigned long)port);
+    debugPrint(", Größe: ");
+    debugPrint((unsigned long)downlink.size);
+    debugPrintln(" bytes");
+    return true;
+}
+
+int8_t LoRaWAN_WioE5::findDownlink(bool routed) {
+    int8_t oldest = -1;
     
-    // Alternative Downlink-Formate prüfen
-    if ((downlinkStart = strstr(response, "RX: \"")) != nullptr) {
-        downlinkStart += 5; // Skip 'RX: "'
+    for (uint8_t i = 0; i < LORAWAN_DOWNLINK_QUEUE_SIZE; i++) {
+        const LoRaWAN_Downlink& downlink = _downlinks[i];
+        if (downlink.port == 0 || (findDownlinkRoute(downlink.port) != nullptr) != routed) continue;
         
-        char* rxEnd = strchr(downlinkStart, '"');
-        if (rxEnd) {
-            size_t hexLen = rxEnd - downlinkStart;
-            
-            _status.downlinkPort = 1; // Standard-Port wenn nicht spezifiziert
-            _status.downlinkSize = 0;
-            
-            for (size_t i = 0; i < hexLen && i < 510 && _status.downlinkSize < 255; i += 2) {
-                if (i + 1 < hexLen) {
-                    char hexByte[3] = {downlinkStart[i], downlinkStart[i + 1], '\0'};
-                    _status.downlinkData[_status.downlinkSize++] = (uint8_t)strtol(hexByte, nullptr, 16);
-                }
-            }
-            
-            _status.hasDownlink = true;
+        if (oldest < 0 || (int16_t)(downlink.order - _downlinks[oldest].order) < 0) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+LoRaWAN_DownlinkRoute* LoRaWAN_WioE5::findDownlinkRoute(uint8_t port) {
+    LoRaWAN_DownlinkRoute* fallback = nullptr;
+    
+    for (uint8_t i = 0; i < LORAWAN_DOWNLINK_MAX_HANDLERS; i++) {
+        LoRaWAN_DownlinkRoute& route = _downlinkRoutes[i];
+        if (!route.handler) continue;
+        if (route.port == port) return &route;
+        if (route.port == LORAWAN_DOWNLINK_ANY_PORT) fallback = &route;
+    }
+    return fallback;
+}
+
+bool LoRaWAN_WioE5::onDownlink(uint8_t port, LoRaWAN_DownlinkHandler handler, void* context) {
+    LoRaWAN_DownlinkRoute* free = nullptr;
+    
+    for (uint8_t i = 0; i < LORAWAN_DOWNLINK_MAX_HANDLERS; i++) {
+        LoRaWAN_DownlinkRoute& route = _downlinkRoutes[i];
+        if (route.handler && route.port == port) {
+            // Vorhandenen Handler ersetzen oder abmelden
+            route.handler = handler;
+            route.context = context;
             return true;
         }
+        if (!route.handler && !free) {
+            free = &route;
+        }
     }
     
-    return false;
+    if (!handler) return true;
+    if (!free) {
+        debugPrintln("[ERROR] Keine freien Downlink-Handler");
+        return false;
+    }
+    free->port = port;
+    free->handler = handler;
+    free->context = context;
+    return true;
+}
+
+void LoRaWAN_WioE5::dispatchDownlinks() {
+    if (_dispatching) return;
+    _dispatching = true;
+    
+    int8_t index;
+    while ((index = findDownlink(true)) >= 0) {
+        LoRaWAN_Downlink& downlink = _downlinks[index];
+        LoRaWAN_DownlinkRoute* route = findDownlinkRoute(downlink.port);
+        
+        // Handler arbeitet direkt auf dem Platz, freigegeben wird erst danach (sofern
+        // der Platz nicht inzwischen von einem neuen Downlink belegt wurde)
+        uint16_t order = downlink.order;
+        route->handler(downlink.data, downlink.size, downlink.port, route->context);
+        if (downlink.order == order) {
+            downlink.port = 0;
+        }
+    }
+    
+    _dispatching = false;
 }
 
 bool LoRaWAN_WioE5::hasDownlinkMessage() {
-    return _status.hasDownlink;
+    return findDownlink(false) >= 0;
 }
 
 size_t LoRaWAN_WioE5::getDownlinkSize() {
-    return _status.downlinkSize;
+    int8_t index = findDownlink(false);
+    return (index >= 0) ? _downlinks[index].size : 0;
 }
 
 const uint8_t* LoRaWAN_WioE5::getDownlinkData() {
-    return _status.downlinkData;
+    int8_t index = findDownlink(false);
+    return (index >= 0) ? _downlinks[index].data : nullptr;
 }
 
 uint8_t LoRaWAN_WioE5::getDownlinkPort() {
-    return _status.downlinkPort;
+    int8_t index = findDownlink(false);
+    return (index >= 0) ? _downlinks[index].port : 0;
 }
 
 void LoRaWAN_WioE5::clearDownlink() {
-    _status.hasDownlink = false;
-    _status.downlinkSize = 0;
-    _status.downlinkPort = 0;
-    memset(_status.downlinkData, 0, sizeof(_status.downlinkData));
+    int8_t index = findDownlink(false);
+    if (index >= 0) {
+        _downlinks[index].port = 0;
+    }
+}
+
+uint16_t LoRaWAN_WioE5::getDroppedDownlinkCount() {
+    return _droppedDownlinks;
 }
 
 // ================================================================
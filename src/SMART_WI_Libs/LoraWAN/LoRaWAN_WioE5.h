@@ -282,6 +282,56 @@
  *     // Dein Code hier...
  * }
  * 
+ * ┌─────────────────────────────────────────────────────────────────────────┐
+ * │ BEISPIEL 6: NICHT-BLOCKIERENDER BETRIEB (ASYNCHRONE AT-ENGINE)        │
+ * └─────────────────────────────────────────────────────────────────────────┘
+ * 
+ * #include "SMART_WI_Libs/LoRaWAN_WioE5.h"
+ * #include "SMART_WI_Libs/SerialMon.h"
+ * 
+ * LoRaWAN_WioE5 lora(&Serial2, &SerialMon);
+ * 
+ * void onSendDone(LoRaWAN_ATResult result, const char* line, void* context) {
+ *     SerialMon.println(result == LORAWAN_AT_OK ? "✅ Gesendet" : "❌ Fehler");
+ * }
+ * 
+ * void setup() {
+ *     SerialMon.begin(115200);
+ *     lora.initializeEverything();     // Initialisierung weiterhin blockierend
+ * }
+ * 
+ * void loop() {
+ *     static unsigned long lastSend = 0;
+ *     
+ *     // Kommandos werden nur eingereiht, loop() läuft sofort weiter
+ *     if (millis() - lastSend >= 30000 && lora.sendHexDataAsync("48656C6C6F", 1, true, onSendDone)) {
+ *         lastSend = millis();
+ *     }
+ *     
+ *     // Empfang, Zeilenauswertung, Timeouts und Callbacks - NIE mit delay() blockieren!
+ *     lora.process();
+ * }
+ * 
+ * ┌─────────────────────────────────────────────────────────────────────────┐
+ * │ BEISPIEL 7: DOWNLINK-HANDLER JE PORT                                  │
+ * └─────────────────────────────────────────────────────────────────────────┘
+ * 
+ * Downlinks werden gepuffert (LORAWAN_DOWNLINK_QUEUE_SIZE), zwei kurz
+ * hintereinander empfangene Downlinks überschreiben sich nicht mehr.
+ * 
+ * void onConfig(const uint8_t* data, uint8_t size, uint8_t port, void* context) {
+ *     if (size >= 2) sampleInterval = (data[0] << 8) | data[1];
+ * }
+ * 
+ * void setup() {
+ *     lora.initializeEverything();
+ *     lora.onDownlink(10, onConfig);      // Port 10: Konfiguration
+ * }
+ * 
+ * void loop() {
+ *     lora.process();                     // ruft onConfig() für jeden Downlink auf Port 10 auf
+ * }
+ * 
  * ═════════════════════════════════════════════════════════════════════════════
  *                                 HARDWARE SETUP
  * ═════════════════════════════════════════════════════════════════════════════
@@ -423,6 +473,14 @@
  * ✅ Umfassendes Debug-System
  * ✅ Vollständige Dokumentation mit Beispielen
  * 
+ * v1.1.0:
+ * ✅ Nicht-blockierende AT-Engine mit Warteschlange und Callbacks (process())
+ * ✅ Zeilenweiser Antwort-Matcher (KMP) statt strstr() über den ganzen Antwortpuffer
+ * ✅ Uplinks werden ohne String/Heap direkt als Hex auf die UART geschrieben
+ * ✅ Uplink-Warteschlange mit Prioritäten und Duty-Cycle-Budget (LoRaWAN_UplinkQueue.h)
+ * ✅ Fragmentierung zu großer Payloads je nach Data Rate (LoRaWAN_Fragment.h)
+ * ✅ Downlink-Warteschlange mit Handlern je Port (onDownlink())
+ * 
  * @author: Smart Wire Industries
  * @version: 1.0.0
  * @date: 2025-01-04
@@ -436,6 +494,8 @@
 
 #include "Arduino.h"
 #include "HardwareSerial.h"
+#include "LoRaWAN_ATMatcher.h"
+#include "LoRaWAN_Fragment.h"
 
 // ================================================================
 // KONSTANTEN UND KONFIGURATION
@@ -445,7 +505,19 @@
 #define LORAWAN_DEFAULT_TIMEOUT_MS 5000       // Standard AT-Kommando Timeout
 #define LORAWAN_JOIN_TIMEOUT_MS 45000         // Timeout für LoRaWAN Join
 #define LORAWAN_SEND_TIMEOUT_MS 15000         // Timeout für Nachrichtenversand
-#define LORAWAN_RESPONSE_BUFFER_SIZE 1024     // Größe des Empfangspuffers
+#define LORAWAN_NO_BAND_MIN_WAIT_MS 1000      // Wartezeit nach "No band", wenn das Modul keine nennt
+#define LORAWAN_RESPONSE_BUFFER_SIZE 544      // Empfangspuffer der blockierenden Kommandos, fasst eine Downlink-Zeile
+
+// Asynchrone AT-Engine
+#define LORAWAN_AT_QUEUE_SIZE 4               // Max. Anzahl eingereihter AT-Kommandos
+#define LORAWAN_AT_COMMAND_SIZE 48            // Max. Länge eines eingereihten AT-Kommandos (ohne Payload)
+#define LORAWAN_LINE_BUFFER_SIZE 544          // Max. Länge einer Antwortzeile (Downlink mit 242 Bytes als Hex)
+#define LORAWAN_AT_PATTERN_SIZE 40            // Max. Länge von expectedResponse und finalResponse
+#define LORAWAN_MAX_PAYLOAD_SIZE 242          // Max. Payload eines Uplinks in Bytes (DR4/DR5)
+#define LORAWAN_DOWNLINK_QUEUE_SIZE 4         // Max. Anzahl gepufferter Downlinks
+#define LORAWAN_DOWNLINK_MAX_SIZE LORAWAN_MAX_PAYLOAD_SIZE // Max. Payload eines Downlinks (regionales Maximum)
+#define LORAWAN_DOWNLINK_MAX_HANDLERS 6       // Max. Anzahl registrierter Downlink-Handler
+#define LORAWAN_DOWNLINK_ANY_PORT 0           // Handler für alle Ports ohne eigenen Handler
 
 // EU868 Standard-Frequenzen
 #define LORAWAN_FREQ_CH0 867.1f  // MHz
@@ -570,10 +642,81 @@ enum LoRaWAN_DataRate {
     LORAWAN_DR7 = 7     // FSK
 };
 
+enum LoRaWAN_ATResult {
+    LORAWAN_AT_OK,      // Erwartete Antwort empfangen
+    LORAWAN_AT_FAILED,  // Abschlusszeile empfangen, aber ohne erwartete Antwort
+    LORAWAN_AT_ERROR,   // Modul hat ERROR gemeldet
+    LORAWAN_AT_TIMEOUT, // Keine Abschlusszeile innerhalb des Timeouts
+    LORAWAN_AT_NO_BAND  // Uplink abgelehnt, kein Kanal frei (Duty-Cycle), siehe getNoBandWaitMs()
+};
+
+enum LoRaWAN_ATState {
+    LORAWAN_AT_QUEUED,  // Eingereiht, noch nicht gesendet
+    LORAWAN_AT_SENDING, // Wird in Teilen geschrieben, soweit der Sendepuffer Platz hat
+    LORAWAN_AT_WAITING  // Gesendet, wartet auf Antwortzeilen
+};
+
 // ================================================================
 // STRUKTUREN
 // ================================================================
 
+/**
+ * Callback nach Abschluss eines asynchronen AT-Kommandos
+ * @param result Ergebnis des Kommandos
+ * @param line Zeile, die das Kommando beendet hat (nullptr bei Timeout)
+ * @param context Beim Einreihen übergebener Kontext
+ */
+typedef void (*LoRaWAN_ATCallback)(LoRaWAN_ATResult result, const char* line, void* context);
+
+/**
+ * Callback für jede empfangene Zeile (URC = unaufgeforderte Meldung des Moduls)
+ * @param line Empfangene Zeile ohne Zeilenende
+ * @param context Beim Registrieren übergebener Kontext
+ */
+typedef void (*LoRaWAN_URCCallback)(const char* line, void* context);
+
+/**
+ * Handler für Downlinks eines Ports
+ * @param data Payload, zeigt direkt in den Downlink-Puffer (nur während des Aufrufs gültig)
+ * @param size Länge der Payload
+ * @param port LoRaWAN-Port des Downlinks
+ * @param context Beim Registrieren übergebener Kontext
+ */
+typedef void (*LoRaWAN_DownlinkHandler)(const uint8_t* data, uint8_t size, uint8_t port, void* context);
+
+struct LoRaWAN_Downlink {
+    uint8_t data[LORAWAN_DOWNLINK_MAX_SIZE];
+    uint8_t size;
+    uint8_t port;               // 0 = Platz frei
+    uint16_t order;             // Reihenfolge des Empfangs
+};
+
+struct LoRaWAN_DownlinkRoute {
+    uint8_t port;
+    LoRaWAN_DownlinkHandler handler;    // nullptr = Eintrag frei
+    void* context;
+};
+
+struct LoRaWAN_ATCommand {
+    char command[LORAWAN_AT_COMMAND_SIZE];  // Kommando ohne "\r\n"
+    const char* payload;            // Optional hinter dem Kommando gesendet, muss bis zum Callback gültig bleiben
+    const uint8_t* binaryPayload;   // Alternativ Binärdaten, werden beim Senden als Hex kodiert
+    uint8_t binaryLength;
+    const uint8_t* binaryHeader;    // Optional vor den Binärdaten gesendet (Fragment-Header)
+    uint8_t binaryHeaderLength;
+    const char* expectedResponse;   // Erfolgsmeldung (String-Literal) oder nullptr
+    const char* finalResponse;      // Abschlusszeile (String-Literal) oder nullptr = Ende mit expectedResponse
+    uint16_t sendLength;            // Zeichen von Kommando, Payload (als Hex) und "\r\n"
+    uint16_t sentLength;            // Davon bereits in den Sendepuffer geschrieben
+    unsigned long timeout;
+    unsigned long startTime;
+    LoRaWAN_ATCallback callback;
+    void* context;
+    LoRaWAN_ATState state;
+    bool expectedSeen;
+};
+
+
 struct LoRaWAN_Config {
     // OTAA Parameter
     char deviceEUI[17];         // 16 Hex-Zeichen + Null-Terminator
@@ -601,10 +744,6 @@ struct LoRaWAN_Status {
     char realDeviceEUI[17];
     uint16_t messageCounter;
     unsigned long lastSendTime;
-    bool hasDownlink;
-    uint8_t downlinkData[256];
-    size_t downlinkSize;
-    uint8_t downlinkPort;
 };
 
 // ================================================================
@@ -617,6 +756,9 @@ private:
     Stream* _debugSerial;
     
     char _responseBuffer[LORAWAN_RESPONSE_BUFFER_SIZE];
+    uint16_t _responseLength;
+    uint16_t _lineStart;        // Beginn der aktuellen Zeile in _responseBuffer
+    char* _matchedLine;         // Zeile mit der erwarteten Antwort des letzten Kommandos
     LoRaWAN_Config _config;
     LoRaWAN_Status _status;
     
@@ -626,10 +768,81 @@ private:
     bool sendATCommandSilent(const char* command, const char* expectedResponse = nullptr, 
                             unsigned long timeout = LORAWAN_DEFAULT_TIMEOUT_MS);
     bool waitForResponse(const char* expectedResponse, unsigned long timeout);
+    bool beginATCommand();
+    bool awaitATResponse(uint16_t expectedMask, unsigned long timeout);
+    void writeHexPayload(const uint8_t* data, size_t length);
+    bool sendUplink(const char* hexData, const uint8_t* data, size_t length, bool confirmed,
+                    const uint8_t* header = nullptr, uint8_t headerLength = 0);
+    LoRaWAN_DataRate queryDataRate();
+    uint8_t getMaxPayloadSize(LoRaWAN_DataRate dataRate);
+    bool queueUplink(const char* hexData, const uint8_t* data, uint8_t length, uint8_t port,
+                     bool confirmed, LoRaWAN_ATCallback callback, void* context,
+                     const uint8_t* header = nullptr, uint8_t headerLength = 0);
+    void setNoBand(const char* line);
+    void beginResponse();
+    uint16_t addResponsePattern(const char* pattern);
+    bool readResponseLine(unsigned long startTime, unsigned long timeout, bool echo,
+                          uint16_t& mask, char*& line);
     void clearInputBuffer();
     void debugPrint(const char* message);
     void debugPrintln(const char* message);
+    void debugPrint(unsigned long value);
     bool parseDownlinkMessage(const char* response);
+    int8_t findDownlink(bool routed);
+    LoRaWAN_DownlinkRoute* findDownlinkRoute(uint8_t port);
+    
+    // Asynchrone AT-Engine: Ringpuffer der Kommandos, _atQueue[_atHead] ist das aktive Kommando
+    LoRaWAN_ATCommand _atQueue[LORAWAN_AT_QUEUE_SIZE];
+    uint8_t _atHead;
+    uint8_t _atCount;
+    char _lineBuffer[LORAWAN_LINE_BUFFER_SIZE];
+    uint16_t _lineLength;
+    
+    // Zeilenweiser Antwort-Matcher: feste Muster (ERROR, +JOIN, +MSGHEX, ...) und die des aktiven Kommandos
+    LoRaWAN_ATMatcher _matcher;
+    uint16_t _lineMask;         // In der aktuellen Zeile erkannte Muster
+    uint16_t _expectedMask;
+    uint16_t _finalMask;
+    LoRaWAN_URCCallback _urcCallback;
+    void* _urcContext;
+    uint8_t _uplinkPort;    // Zuletzt per AT+PORT gesetzter Port, 0 = unbekannt
+    
+    // Aufteilung von Uplinks, die bei der aktuellen Data Rate nicht in einen Uplink passen
+    LoRaWAN_Fragmenter _fragmenter;
+    
+    // Asynchron gesendete fragmentierte Nachricht: process() reiht das nächste Fragment erst ein,
+    // wenn das vorherige gesendet wurde und das Modul wieder einen freien Kanal hat
+    LoRaWAN_Fragment _fragment;         // Aktuelles Fragment, wird nach "No band" wiederholt
+    bool _fragmentActive;
+    bool _fragmentQueued;               // Aktuelles Fragment liegt in der AT-Warteschlange
+    uint8_t _fragmentPort;
+    bool _fragmentConfirmed;
+    unsigned long _fragmentStart;
+    LoRaWAN_ATCallback _fragmentCallback;
+    void* _fragmentContext;
+    
+    // Duty-Cycle-Sperre des Moduls ("+MSGHEX: No band in 2345ms")
+    unsigned long _noBandStart;
+    uint32_t _noBandWaitMs;
+    bool _noBandPending;        // Das "Done" nach "No band" ist kein gesendeter Uplink
+    
+    // Empfangene Downlinks: werden direkt aus der Zeile in einen freien Platz dekodiert und
+    // dort entweder vom Handler ihres Ports verarbeitet oder über getDownlinkData() abgeholt
+    LoRaWAN_Downlink _downlinks[LORAWAN_DOWNLINK_QUEUE_SIZE];
+    LoRaWAN_DownlinkRoute _downlinkRoutes[LORAWAN_DOWNLINK_MAX_HANDLERS];
+    uint16_t _nextDownlinkOrder;
+    uint16_t _droppedDownlinks;
+    bool _dispatching;          // Schutz gegen erneutes Verteilen aus einem Handler heraus
+    
+    void processFragments();
+    static void onFragmentComplete(LoRaWAN_ATResult result, const char* line, void* context);
+    void finishFragments(LoRaWAN_ATResult result, const char* line);
+    void startATCommand(LoRaWAN_ATCommand& cmd);
+    void continueATCommand(LoRaWAN_ATCommand& cmd);
+    char getATCommandChar(const LoRaWAN_ATCommand& cmd, uint16_t index);
+    void handleATLine(const char* line, uint16_t mask);
+    void handleURC(const char* line, uint16_t mask);
+    void finishATCommand(LoRaWAN_ATResult result, const char* line);
     
     // Konfigurationsmethoden
     bool setMode(LoRaWAN_Mode mode);
@@ -772,15 +985,121 @@ public:
     bool sendHexData(const char* hexData, uint8_t port = 1, bool confirmed = false);
     
     /**
-     * Sendet Binärdaten (Byte-Array)
+     * Sendet Binärdaten (Byte-Array), die Daten werden ohne Zwischenpuffer als Hex
+     * direkt auf die Schnittstelle geschrieben. Passen die Daten bei der aktuellen
+     * Data Rate nicht in einen Uplink, werden sie als Fragmente (siehe
+     * LoRaWAN_Fragment.h) nacheinander gesendet. Meldet das Modul für ein Fragment
+     * "No band" (Duty-Cycle), wird die ganze Nachricht abgebrochen, die Wartezeit
+     * liefert getNoBandWaitMs(). sendBinaryDataAsync() wartet stattdessen auf den Kanal.
      * @param data Byte-Array der Daten
-     * @param length Länge der Daten
+     * @param length Länge der Daten (max. LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE)
      * @param port LoRaWAN-Port (1-223, Standard: 1)
      * @param confirmed Bestätigte Nachricht (Standard: false)
      * @return true wenn Sendung erfolgreich
      */
     bool sendBinaryData(const uint8_t* data, size_t length, uint8_t port = 1, bool confirmed = false);
     
+    /**
+     * Gibt die max. Payload eines Uplinks bei der aktuellen Data Rate zurück.
+     * Bei aktivem ADR wird die Data Rate vom Modul abgefragt.
+     * @return Max. Payload in Bytes
+     */
+    uint8_t getMaxPayloadSize();
+    
+    // ================================================================
+    // ASYNCHRONE AT-ENGINE (NICHT-BLOCKIEREND)
+    // ================================================================
+    
+    /**
+     * Verarbeitet empfangene Zeichen, Timeouts und die Kommando-Warteschlange.
+     * Muss zyklisch aus loop() aufgerufen werden und blockiert nie: Kommandos mit
+     * Payload werden über mehrere Aufrufe geschrieben, soweit der Sendepuffer Platz hat.
+     */
+    void process();
+    
+    /**
+     * Reiht ein AT-Kommando ein. Das Kommando wird gesendet, sobald alle vorherigen
+     * abgeschlossen sind. Die Antwort wird zeilenweise ausgewertet:
+     * ERROR beendet mit LORAWAN_AT_ERROR, ohne finalResponse beendet expectedResponse
+     * mit LORAWAN_AT_OK, sonst beendet finalResponse (OK nur wenn expectedResponse empfangen wurde).
+     * @param command AT-Kommando ohne "\r\n" (max. LORAWAN_AT_COMMAND_SIZE - 1 Zeichen)
+     * @param expectedResponse Erfolgsmeldung, muss bis zum Abschluss gültig bleiben (String-Literal)
+     * @param finalResponse Abschlusszeile bei mehrzeiligen Antworten (optional)
+     * @param timeout Timeout ab dem Senden in Millisekunden
+     * @param callback Wird nach Abschluss aus process() aufgerufen (optional)
+     * @param context Wird an den Callback übergeben
+     * @return true wenn eingereiht, false wenn Warteschlange voll oder Kommando zu lang
+     */
+    bool queueATCommand(const char* command, const char* expectedResponse,
+                        const char* finalResponse = nullptr,
+                        unsigned long timeout = LORAWAN_DEFAULT_TIMEOUT_MS,
+                        LoRaWAN_ATCallback callback = nullptr, void* context = nullptr);
+    
+    /**
+     * Startet den Netzwerk-Join ohne zu blockieren (OTAA), im ABP-Modus wird der
+     * Callback sofort aufgerufen
+     * @param callback Wird nach Abschluss des Joins aufgerufen (optional)
+     * @param context Wird an den Callback übergeben
+     * @return true wenn eingereiht
+     */
+    bool joinNetworkAsync(LoRaWAN_ATCallback callback = nullptr, void* context = nullptr);
+    
+    /**
+     * Sendet Binärdaten (Hex-String) ohne zu blockieren
+     * @param hexData Hex-String der Daten, muss bis zum Callback gültig bleiben
+     * @param port LoRaWAN-Port (1-223, Standard: 1)
+     * @param confirmed Bestätigte Nachricht (Standard: false), ohne ACK endet sie mit LORAWAN_AT_FAILED
+     * @param callback Wird nach Sendbestätigung, Fehler oder Timeout aufgerufen (optional)
+     * @param context Wird an den Callback übergeben
+     * @return true wenn eingereiht
+     */
+    bool sendHexDataAsync(const char* hexData, uint8_t port = 1, bool confirmed = false,
+                          LoRaWAN_ATCallback callback = nullptr, void* context = nullptr);
+    
+    /**
+     * Sendet Binärdaten (Byte-Array) ohne zu blockieren, die Hex-Kodierung erfolgt
+     * erst beim Schreiben auf die Schnittstelle. Größere Daten als die max. Payload
+     * der Data Rate werden als Fragmente gesendet: process() reiht jedes Fragment erst
+     * nach dem vorherigen ein und wartet nach "No band" die genannte Zeit ab. Der
+     * Callback wird einmal für die ganze Nachricht aufgerufen, bei einem Fehler wird
+     * sie abgebrochen. Es kann nur eine fragmentierte Nachricht gleichzeitig offen sein.
+     * @param data Byte-Array der Daten, muss bis zum Callback gültig bleiben
+     * @param length Länge der Daten (max. LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE)
+     * @param port LoRaWAN-Port (1-223, Standard: 1)
+     * @param confirmed Bestätigte Nachricht (Standard: false), ohne ACK endet sie mit LORAWAN_AT_FAILED
+     * @param callback Wird nach Sendbestätigung, Fehler oder Timeout aufgerufen (optional)
+     * @param context Wird an den Callback übergeben
+     * @return true wenn eingereiht
+     */
+    bool sendBinaryDataAsync(const uint8_t* data, size_t length, uint8_t port = 1, bool confirmed = false,
+                             LoRaWAN_ATCallback callback = nullptr, void* context = nullptr);
+    
+    /**
+     * Registriert einen Callback für jede empfangene Zeile (z.B. Downlinks, Join-Meldungen)
+     * @param callback Callback oder nullptr zum Abmelden
+     * @param context Wird an den Callback übergeben
+     */
+    void setURCHandler(LoRaWAN_URCCallback callback, void* context = nullptr);
+    
+    /**
+     * Prüft ob asynchrone AT-Kommandos eingereiht oder aktiv sind.
+     * Solange true, lehnen die blockierenden Methoden neue Kommandos ab.
+     * @return true wenn beschäftigt
+     */
+    bool isATBusy();
+    
+    /**
+     * Gibt die Anzahl freier Plätze in der Kommando-Warteschlange zurück
+     * @return Freie Plätze
+     */
+    uint8_t getATQueueFree();
+    
+    /**
+     * Gibt die Zeit zurück, bis das Modul nach "No band" wieder einen freien Kanal hat
+     * @return Wartezeit in Millisekunden, 0 wenn gesendet werden kann
+     */
+    uint32_t getNoBandWaitMs();
+    
     // ================================================================
     // STATUS UND INFORMATION
     // ================================================================
@@ -823,35 +1142,62 @@ public:
      */
     uint16_t getMessageCounter();
     
+    // ================================================================
+    // DOWNLINKS
+    // ================================================================
+    
+    /**
+     * Registriert einen Handler für die Downlinks eines Ports. Die Handler werden in
+     * process() und nach einem blockierenden Uplink in Empfangsreihenfolge aufgerufen.
+     * @param port LoRaWAN-Port (1-223) oder LORAWAN_DOWNLINK_ANY_PORT
+     * @param handler Handler oder nullptr zum Abmelden
+     * @param context Wird an den Handler übergeben
+     * @return false wenn die Tabelle voll ist
+     */
+    bool onDownlink(uint8_t port, LoRaWAN_DownlinkHandler handler, void* context = nullptr);
+    
     /**
-     * Prüft ob eine Downlink-Nachricht empfangen wurde
+     * Ruft für alle gepufferten Downlinks den Handler ihres Ports auf und gibt deren
+     * Plätze frei. Downlinks ohne Handler bleiben zum Abholen erhalten.
+     */
+    void dispatchDownlinks();
+    
+    /**
+     * Prüft ob eine Downlink-Nachricht ohne Handler zum Abholen bereitliegt
      * @return true wenn Downlink verfügbar
      */
     bool hasDownlinkMessage();
     
     /**
-     * Gibt die Größe der Downlink-Nachricht zurück
+     * Gibt die Größe der ältesten Downlink-Nachricht zurück
      * @return Größe in Bytes
      */
     size_t getDownlinkSize();
     
     /**
-     * Gibt die Downlink-Daten zurück
+     * Gibt die Daten der ältesten Downlink-Nachricht zurück
      * @return Pointer auf Downlink-Daten
      */
     const uint8_t* getDownlinkData();
     
     /**
-     * Gibt den Downlink-Port zurück
+     * Gibt den Port der ältesten Downlink-Nachricht zurück
      * @return Port-Nummer
      */
     uint8_t getDownlinkPort();
     
     /**
-     * Löscht die Downlink-Daten
+     * Gibt die älteste Downlink-Nachricht frei, danach ist die nächste abrufbar
      */
     void clearDownlink();
     
+    /**
+     * Gibt die Anzahl der Downlinks zurück, die wegen voller Warteschlange oder
+     * Überlänge verworfen wurden
+     * @return Anzahl verworfener Downlinks
+     */
+    uint16_t getDroppedDownlinkCount();
+    
     // ================================================================
     // ERWEITERTE FUNKTIONEN
     // ================================================================
@@ -885,7 +1231,8 @@ public:
                            unsigned long timeout = LORAWAN_DEFAULT_TIMEOUT_MS);
     
     /**
-     * Gibt den letzten Antwortpuffer zurück
+     * Gibt den letzten Antwortpuffer zurück. Bei langen Antworten enthält er nur die letzten
+     * Zeilen, ältere werden verworfen, sobald LORAWAN_RESPONSE_BUFFER_SIZE erreicht ist.
      * @return Pointer zum Antwortpuffer
      */
     const char* getLastResponse();
@@ -5,6 +5,7 @@
 
 #include "SX1262_LoRaWAN.h"
 #include "lorawanconfig.h"
+#include "../EEPROM_SPI.h"
 
 // SerialMon für AVR
 #if defined (__AVR__)
@@ -13,8 +14,70 @@
     #define SerialMon Serial
 #endif
 
+// Nonces in der ersten Schreibseite, Session ab der zweiten (getrennt, da die
+// Nonces bei jedem Join-Versuch und die Session bei jedem Uplink geschrieben werden)
+static const uint32_t ADDRESS_LORAWAN_NONCES = ADDRESS_LORAWAN_SESSION;
+static const uint32_t ADDRESS_LORAWAN_SESSION_BUFFER = ADDRESS_LORAWAN_SESSION + EEPROM_WRITE_PAGE_SIZE;
+
+static_assert(RADIOLIB_LORAWAN_NONCES_BUF_SIZE <= EEPROM_WRITE_PAGE_SIZE,
+              "RadioLib Nonces passen nicht in eine EEPROM-Seite");
+static_assert(EEPROM_WRITE_PAGE_SIZE + RADIOLIB_LORAWAN_SESSION_BUF_SIZE <= SIZE_LORAWAN_SESSION_AREA,
+              "RadioLib Session passt nicht in den EEPROM-Bereich");
+
+// Größe der Blöcke beim Zurücklesen, um keinen zweiten Puffer in Session-Größe zu belegen
+static const uint8_t VERIFY_CHUNK_SIZE = 32;
+
+/**
+ * Vergleicht einen Puffer blockweise mit dem Inhalt des EEPROMs
+ * @param address EEPROM-Adresse
+ * @param buf Vergleichsdaten
+ * @param size Anzahl Bytes
+ * @return true wenn das EEPROM bereits genau diese Daten enthält
+ */
+static bool isEEPROMEqual(uint32_t address, const uint8_t* buf, uint16_t size) {
+    uint8_t check[VERIFY_CHUNK_SIZE];
+
+    for (uint16_t offset = 0; offset < size; offset += VERIFY_CHUNK_SIZE) {
+        uint16_t length = (size - offset < VERIFY_CHUNK_SIZE) ? size - offset : VERIFY_CHUNK_SIZE;
+        EEPROM_SPI.readExternEEPROM(address + offset, check, length);
+        if (memcmp(check, &buf[offset], length) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Schreibt einen Puffer ins EEPROM und liest ihn zur Kontrolle blockweise zurück.
+ * Stehen die Daten bereits im EEPROM, wird nicht geschrieben.
+ * @param address EEPROM-Adresse
+ * @param buf Zu schreibende Daten
+ * @param size Anzahl Bytes
+ * @return true wenn die Daten nach max. 3 Versuchen korrekt im EEPROM stehen
+ */
+static bool writeEEPROMVerified(uint32_t address, const uint8_t* buf, uint16_t size) {
+    if (isEEPROMEqual(address, buf, size)) {
+        return true;
+    }
+
+    for (uint8_t attempt = 0; attempt < 3; attempt++) {
+        EEPROM_SPI.writeExternEEPROM(address, buf, size);
+        if (isEEPROMEqual(address, buf, size)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 SX1262_LoRaWAN::SX1262_LoRaWAN() {
-    // Konstruktor
+    _joinState = SX1262_JOIN_IDLE;
+    _joinAttempts = 0;
+    _maxJoinAttempts = 0;
+    _backoffMs = 0;
+    _backoffStart = 0;
+    memset(&_fragment, 0, sizeof(_fragment));
+    _uplinkState = SX1262_UPLINK_IDLE;
+    _fragmentStart = 0;
 }
 
 SX1262_LoRaWAN::~SX1262_LoRaWAN() {}
@@ -50,36 +113,174 @@ bool SX1262_LoRaWAN::initializeLoRaWAN() {
 }
 
 bool SX1262_LoRaWAN::joinNetwork() {
-    int maxRetries = 5;  // Maximale Anzahl von Versuchen
-    int retryDelay = 30000;  // 30 Sekunden Wartezeit
-    
-    for (int attempt = 1; attempt <= maxRetries; attempt++) {
-        SerialMon.print("Sende Join-Request... (Versuch ");
-        SerialMon.print(attempt);
-        SerialMon.print("/");
-        SerialMon.print(maxRetries);
-        SerialMon.println(")");
-        
-        int state = node.activateOTAA();
-        if (state == RADIOLIB_LORAWAN_NEW_SESSION) {
-            SerialMon.println("✅ Join erfolgreich!");
-            return true;
-        } else {
-            SerialMon.print("❌ Join fehlgeschlagen: ");
-            SerialMon.println(state);
-            
-            // Wenn es nicht der letzte Versuch ist, warten
-            if (attempt < maxRetries) {
-                SerialMon.print("⏰ Warte ");
-                SerialMon.print(retryDelay / 1000);
-                SerialMon.println(" Sekunden bis zum nächsten Versuch...");
-                delay(retryDelay);
-            }
+    startJoin(5);
+
+    SX1262_JoinState state = SX1262_JOIN_PENDING;
+    while (state == SX1262_JOIN_PENDING || state == SX1262_JOIN_BACKOFF) {
+        state = processJoin();
+    }
+
+    return state == SX1262_JOIN_JOINED;
+}
+
+// ================================================================
+// NICHT-BLOCKIERENDER JOIN UND SESSION-SPEICHER
+// ================================================================
+
+void SX1262_LoRaWAN::startJoin(uint8_t maxAttempts) {
+    _maxJoinAttempts = maxAttempts;
+    _joinAttempts = 0;
+    _backoffMs = 0;
+
+    // Bei gültiger Session liefert activateOTAA() sofort RADIOLIB_LORAWAN_SESSION_RESTORED
+    restoreSession();
+    _joinState = SX1262_JOIN_PENDING;
+}
+
+SX1262_JoinState SX1262_LoRaWAN::processJoin() {
+    if (_joinState == SX1262_JOIN_BACKOFF) {
+        if (millis() - _backoffStart < _backoffMs) {
+            return _joinState;
         }
+        _joinState = SX1262_JOIN_PENDING;
     }
-    
-    SerialMon.println("❌ Alle Join-Versuche fehlgeschlagen!");
-    return false;
+    if (_joinState != SX1262_JOIN_PENDING) {
+        return _joinState;
+    }
+
+    // Bei unbegrenzten Versuchen darf der Zähler nicht auf 0 überlaufen (Shift um 255 beim Backoff)
+    if (_joinAttempts < UINT8_MAX) {
+        _joinAttempts++;
+    }
+    SerialMon.print("Sende Join-Request... (Versuch ");
+    SerialMon.print(_joinAttempts);
+    if (_maxJoinAttempts > 0) {
+        SerialMon.print("/");
+        SerialMon.print(_maxJoinAttempts);
+    }
+    SerialMon.println(")");
+
+    int state = node.activateOTAA();
+
+    if (state == RADIOLIB_LORAWAN_SESSION_RESTORED) {
+        SerialMon.println("✅ Session aus EEPROM wiederhergestellt, kein Join nötig");
+        _joinState = SX1262_JOIN_JOINED;
+        return _joinState;
+    }
+
+    // Die DevNonce ist verbraucht und darf auch nach einem Reset nicht erneut gesendet werden
+    saveNonces();
+
+    if (state == RADIOLIB_LORAWAN_NEW_SESSION) {
+        SerialMon.println("✅ Join erfolgreich!");
+        saveSession();
+        _joinState = SX1262_JOIN_JOINED;
+        return _joinState;
+    }
+
+    SerialMon.print("❌ Join fehlgeschlagen: ");
+    SerialMon.println(state);
+
+    if (_maxJoinAttempts > 0 && _joinAttempts >= _maxJoinAttempts) {
+        SerialMon.println("❌ Alle Join-Versuche fehlgeschlagen!");
+        _joinState = SX1262_JOIN_FAILED;
+        return _joinState;
+    }
+
+    // Exponentielles Backoff mit Zufallsanteil, damit nach einem Gateway-Ausfall
+    // nicht alle Knoten gleichzeitig erneut senden
+    uint8_t shift = (_joinAttempts - 1 < 6) ? _joinAttempts - 1 : 6;
+    _backoffMs = SX1262_JOIN_BACKOFF_MIN_MS << shift;
+    if (_backoffMs > SX1262_JOIN_BACKOFF_MAX_MS) {
+        _backoffMs = SX1262_JOIN_BACKOFF_MAX_MS;
+    }
+    _backoffMs += random(_backoffMs / 4);
+    _backoffStart = millis();
+
+    SerialMon.print("⏰ Warte ");
+    SerialMon.print(_backoffMs / 1000);
+    SerialMon.println(" Sekunden bis zum nächsten Versuch...");
+    _joinState = SX1262_JOIN_BACKOFF;
+    return _joinState;
+}
+
+SX1262_JoinState SX1262_LoRaWAN::getJoinState() {
+    return _joinState;
+}
+
+bool SX1262_LoRaWAN::restoreSession() {
+    if (!EEPROM_SPI.isInitialized()) {
+        EEPROM_SPI.begin();
+    }
+
+    // RadioLib prüft Signatur, Keys und Band der Puffer selbst, ein leeres
+    // EEPROM oder eine Session für andere Keys wird abgewiesen
+    uint8_t nonces[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+    EEPROM_SPI.readExternEEPROM(ADDRESS_LORAWAN_NONCES, nonces, sizeof(nonces));
+    int state = node.setBufferNonces(nonces);
+    if (state != RADIOLIB_ERR_NONE) {
+        SerialMon.print("Keine gespeicherten Nonces: ");
+        SerialMon.println(state);
+        return false;
+    }
+
+    uint8_t session[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+    EEPROM_SPI.readExternEEPROM(ADDRESS_LORAWAN_SESSION_BUFFER, session, sizeof(session));
+    state = node.setBufferSession(session);
+    if (state != RADIOLIB_ERR_NONE) {
+        SerialMon.print("Keine gültige Session, Join erforderlich: ");
+        SerialMon.println(state);
+        return false;
+    }
+
+    return true;
+}
+
+bool SX1262_LoRaWAN::saveNonces() {
+    if (!EEPROM_SPI.isInitialized()) {
+        EEPROM_SPI.begin();
+    }
+
+    if (!writeEEPROMVerified(ADDRESS_LORAWAN_NONCES, node.getBufferNonces(), RADIOLIB_LORAWAN_NONCES_BUF_SIZE)) {
+        SerialMon.println("[ERROR]: LoRaWAN nonces could not be saved");
+        return false;
+    }
+    return true;
+}
+
+bool SX1262_LoRaWAN::saveSession() {
+    if (!node.isActivated()) {
+        return false;
+    }
+    if (!EEPROM_SPI.isInitialized()) {
+        EEPROM_SPI.begin();
+    }
+
+    // Die Nonces sichert processJoin() direkt nach activateOTAA(), nach einem Uplink ändern sie sich nicht
+    if (!writeEEPROMVerified(ADDRESS_LORAWAN_SESSION_BUFFER, node.getBufferSession(), RADIOLIB_LORAWAN_SESSION_BUF_SIZE)) {
+        SerialMon.println("[ERROR]: LoRaWAN session could not be saved");
+        return false;
+    }
+    return true;
+}
+
+void SX1262_LoRaWAN::clearSession() {
+    if (!EEPROM_SPI.isInitialized()) {
+        EEPROM_SPI.begin();
+    }
+
+    node.clearSession();
+
+    // Gelöschter Zustand des EEPROMs, die Signaturprüfung von RadioLib schlägt damit fehl
+    uint8_t erased[VERIFY_CHUNK_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    for (uint16_t offset = 0; offset < RADIOLIB_LORAWAN_SESSION_BUF_SIZE; offset += VERIFY_CHUNK_SIZE) {
+        uint16_t length = (RADIOLIB_LORAWAN_SESSION_BUF_SIZE - offset < VERIFY_CHUNK_SIZE)
+                          ? RADIOLIB_LORAWAN_SESSION_BUF_SIZE - offset : VERIFY_CHUNK_SIZE;
+        EEPROM_SPI.writeExternEEPROM(ADDRESS_LORAWAN_SESSION_BUFFER + offset, erased, length);
+    }
+
+    _joinState = SX1262_JOIN_IDLE;
 }
 
 bool SX1262_LoRaWAN::initializeEverything() {
@@ -197,18 +398,87 @@ bool SX1262_LoRaWAN::sendPayload(const uint8_t* payload, size_t payloadSize) {
         SerialMon.println("❌ Ungültiges Payload!");
         return false;
     }
+
+    if (!node.isActivated()) {
+        SerialMon.println("❌ Nicht mit dem Netzwerk verbunden!");
+        return false;
+    }
     
-    // Payload-Größe basierend auf aktuellem Spreading Factor prüfen
+    // Payload-Größe basierend auf aktueller Data Rate prüfen
     size_t maxPayloadSize = getMaxPayloadSize();
-    if (payloadSize > maxPayloadSize) {
+    if (payloadSize <= maxPayloadSize) {
+        return sendUplink(payload, payloadSize);
+    }
+    
+    if (_uplinkState == SX1262_UPLINK_PENDING) {
+        SerialMon.println("❌ Fragmentiertes Payload wird noch gesendet!");
+        return false;
+    }
+    
+    if (payloadSize > sizeof(_fragmentMessage) || !_fragmenter.begin(_fragmentMessage, payloadSize, maxPayloadSize)) {
         SerialMon.print("❌ Payload zu groß (");
         SerialMon.print(payloadSize);
-        SerialMon.print(" bytes) für aktuellen SF. Maximum: ");
-        SerialMon.print(maxPayloadSize);
+        SerialMon.print(" bytes) für aktuellen SF. Maximum mit Fragmentierung: ");
+        SerialMon.print(LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE);
         SerialMon.println(" bytes");
         return false;
     }
+    // Der Fragmenter zeigt in die Kopie, das Payload des Aufrufers muss nicht gültig bleiben
+    memcpy(_fragmentMessage, payload, payloadSize);
+    
+    SerialMon.print("✂️ Payload wird in ");
+    SerialMon.print(_fragmenter.getCount());
+    SerialMon.print(" Fragmente à max. ");
+    SerialMon.print(maxPayloadSize);
+    SerialMon.println(" Bytes aufgeteilt");
+    
+    _fragmenter.next(_fragment);
+    _uplinkState = SX1262_UPLINK_PENDING;
+    _fragmentStart = millis();
+    
+    // Erstes Fragment sofort, falls der Duty-Cycle es erlaubt
+    return process() != SX1262_UPLINK_FAILED;
+}
+
+SX1262_UplinkState SX1262_LoRaWAN::process() {
+    if (_uplinkState != SX1262_UPLINK_PENDING) {
+        return _uplinkState;
+    }
+    
+    // Der Empfänger verwirft unvollständige Nachrichten nach LORAWAN_FRAGMENT_TIMEOUT_MS
+    if (millis() - _fragmentStart > LORAWAN_FRAGMENT_TIMEOUT_MS) {
+        SerialMon.println("❌ Fragmentiertes Payload abgebrochen, Duty-Cycle zu lange belegt");
+        _uplinkState = SX1262_UPLINK_FAILED;
+        return _uplinkState;
+    }
     
+    // Duty-Cycle des vorherigen Uplinks abwarten, sonst lehnt RadioLib den Uplink ab
+    if (node.timeUntilUplink() > 0) {
+        return _uplinkState;
+    }
+    
+    uint8_t frame[LORAWAN_FRAGMENT_HEADER_SIZE + 255];
+    memcpy(frame, _fragment.header, LORAWAN_FRAGMENT_HEADER_SIZE);
+    memcpy(&frame[LORAWAN_FRAGMENT_HEADER_SIZE], _fragment.data, _fragment.length);
+    
+    // Ohne ein Fragment ist die Nachricht für den Empfänger wertlos
+    if (!sendUplink(frame, LORAWAN_FRAGMENT_HEADER_SIZE + _fragment.length)) {
+        SerialMon.println("❌ Fragmentiertes Payload abgebrochen");
+        _uplinkState = SX1262_UPLINK_FAILED;
+        return _uplinkState;
+    }
+    
+    if (!_fragmenter.next(_fragment)) {
+        _uplinkState = SX1262_UPLINK_SENT;
+    }
+    return _uplinkState;
+}
+
+SX1262_UplinkState SX1262_LoRaWAN::getUplinkState() {
+    return _uplinkState;
+}
+
+bool SX1262_LoRaWAN::sendUplink(const uint8_t* payload, size_t payloadSize) {
     // Debug-Ausgabe
     SerialMon.print("📦 Sende Payload (");
     SerialMon.print(payloadSize);
@@ -226,6 +496,9 @@ bool SX1262_LoRaWAN::sendPayload(const uint8_t* payload, size_t payloadSize) {
     // Daten senden
     SerialMon.println("📡 Sende Payload...");
     int state = node.sendReceive(payload, payloadSize);
+
+    // Frame-Counter sichern, damit nach einem Reset keine Frames als Replay verworfen werden
+    saveSession();
     
     if (state < RADIOLIB_ERR_NONE) {
         SerialMon.print("❌ Uplink-Fehler: ");
@@ -281,17 +554,8 @@ void SX1262_LoRaWAN::configureLoRaWAN() {
 }
 
 size_t SX1262_LoRaWAN::getMaxPayloadSize() {
-    // Zurzeit hardcoded auf EU868 DR5 (SF7)
-    // TODO: Dynamisch basierend auf aktuellem Spreading Factor
-    return 242;  // EU868 DR5 Maximum
-    
-    // Alternative: Basierend auf aktuellem DR
-    // int dataRate = node.getDataRate();
-    // switch (dataRate) {
-    //     case 0: case 1: case 2: return 51;   // SF12, SF11, SF10
-    //     case 3: return 115;                  // SF9
-    //     case 4: case 5: return 242;          // SF8, SF7
-    //     default: return 51;                  // Sicherheitswert
-    // }
+    // Abhängig von der aktuellen Data Rate (ADR) und anstehenden MAC-Kommandos
+    // EU868: 51 Bytes bei DR0-DR2 (SF12-SF10), 115 bei DR3 (SF9), 242 bei DR4/DR5
+    return node.getMaxPayloadLen();
 }
 
@@ -120,6 +120,33 @@
  *     // Dein Code hier...
  * }
  *
+ * ┌─────────────────────────────────────────────────────────────────────────┐
+ * │ BEISPIEL 3: NICHT-BLOCKIERENDER JOIN MIT SESSION IM EEPROM             │
+ * └─────────────────────────────────────────────────────────────────────────┘
+ *
+ * Session und Nonces werden im SPI-EEPROM gespeichert. Nach einem Reset (z.B.
+ * durch den Watchdog) wird die Session wiederhergestellt, ohne erneuten Join.
+ *
+ * SX1262_LoRaWAN lora;
+ *
+ * void setup() {
+ *     initializeKeys();
+ *     lora.initializeRadio();
+ *     lora.initializeLoRaWAN();
+ *
+ *     // Unbegrenzte Versuche, Wartezeit wächst exponentiell ab 30 Sekunden
+ *     lora.startJoin();
+ * }
+ *
+ * void loop() {
+ *     if (lora.processJoin() == SX1262_JOIN_JOINED) {
+ *         // sendPayload() speichert die Session nach jedem Uplink
+ *     }
+ *     // Sendet die restlichen Fragmente großer Payloads, sobald der Duty-Cycle es erlaubt
+ *     lora.process();
+ *     // Andere Aufgaben laufen während des Backoffs weiter
+ * }
+ *
  * ═════════════════════════════════════════════════════════════════════════════
  *                                HARDWARE SETUP
  * ═════════════════════════════════════════════════════════════════════════════
@@ -354,17 +381,55 @@
 #include "Arduino.h"
 #include "Payload_Builder.h"
 #include "lorawanconfig.h"
+#include "LoRaWAN_Fragment.h"
 #include <RadioLib.h>
 
+#define SX1262_JOIN_BACKOFF_MIN_MS 30000UL     // Wartezeit nach dem ersten fehlgeschlagenen Join
+#define SX1262_JOIN_BACKOFF_MAX_MS 1800000UL   // Obergrenze der exponentiellen Wartezeit (30 Minuten)
+
+// Zustände des nicht-blockierenden Joins
+enum SX1262_JoinState {
+    SX1262_JOIN_IDLE,       // Kein Join gestartet
+    SX1262_JOIN_PENDING,    // Join-Request wird beim nächsten processJoin() gesendet
+    SX1262_JOIN_BACKOFF,    // Warten bis zum nächsten Versuch
+    SX1262_JOIN_JOINED,     // Session aktiv (neu oder aus dem EEPROM wiederhergestellt)
+    SX1262_JOIN_FAILED      // Maximale Anzahl an Versuchen erreicht
+};
+
+// Zustände eines fragmentierten Uplinks
+enum SX1262_UplinkState {
+    SX1262_UPLINK_IDLE,     // Kein fragmentierter Uplink gestartet
+    SX1262_UPLINK_PENDING,  // Weitere Fragmente werden von process() gesendet
+    SX1262_UPLINK_SENT,     // Alle Fragmente gesendet
+    SX1262_UPLINK_FAILED    // Abgebrochen, die Nachricht muss erneut gesendet werden
+};
+
 // ================================================================
 // HAUPTKLASSE
 // ================================================================
 
 class SX1262_LoRaWAN {
 private:
+    // Join-Zustand
+    SX1262_JoinState _joinState;
+    uint8_t _joinAttempts;
+    uint8_t _maxJoinAttempts;       // 0 = unbegrenzt
+    uint32_t _backoffMs;
+    unsigned long _backoffStart;
+
+    // Aufteilung von Payloads, die bei der aktuellen Data Rate nicht in einen Uplink passen.
+    // Die Nachricht wird kopiert, da process() die Fragmente erst nach dem Duty-Cycle sendet
+    LoRaWAN_Fragmenter _fragmenter;
+    LoRaWAN_Fragment _fragment;     // Nächstes zu sendendes Fragment
+    uint8_t _fragmentMessage[LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE];
+    SX1262_UplinkState _uplinkState;
+    unsigned long _fragmentStart;
+
     // Private Hilfsmethoden
     void configureLoRaWAN();
     size_t getMaxPayloadSize();
+    bool saveNonces();
+    bool sendUplink(const uint8_t* payload, size_t payloadSize);
     
 public:
     // ================================================================
@@ -398,10 +463,56 @@ public:
     bool initializeLoRaWAN();
     
     /**
-     * Führt OTAA Join durch
+     * Führt OTAA Join durch (blockierend, max. 5 Versuche)
+     * Eine im EEPROM gespeicherte Session wird zuerst wiederhergestellt.
      * @return true wenn erfolgreich
      */
     bool joinNetwork();
+
+    // ================================================================
+    // NICHT-BLOCKIERENDER JOIN UND SESSION-SPEICHER
+    // ================================================================
+
+    /**
+     * Startet den Join. Eine gültige Session aus dem EEPROM wird wiederhergestellt,
+     * dann sendet der erste processJoin() keinen Join-Request.
+     * initializeLoRaWAN() muss vorher erfolgreich gewesen sein.
+     * @param maxAttempts Maximale Anzahl an Join-Requests, 0 = unbegrenzt
+     */
+    void startJoin(uint8_t maxAttempts = 0);
+
+    /**
+     * Führt den nächsten Schritt des Joins aus, zyklisch in loop() aufrufen.
+     * Wartet nie: im Backoff kehrt die Funktion sofort zurück. Ein Join-Request
+     * selbst blockiert für Senden und beide Empfangsfenster (ca. 6 Sekunden).
+     * @return Aktueller Join-Zustand
+     */
+    SX1262_JoinState processJoin();
+
+    /**
+     * Gibt den aktuellen Join-Zustand zurück
+     * @return Join-Zustand
+     */
+    SX1262_JoinState getJoinState();
+
+    /**
+     * Lädt Nonces und Session aus dem EEPROM in die RadioLib Node
+     * @return true wenn eine gültige Session wiederhergestellt wurde
+     */
+    bool restoreSession();
+
+    /**
+     * Speichert die Session der RadioLib Node im EEPROM, unveränderte Daten werden nicht neu geschrieben
+     * @return true wenn erfolgreich geschrieben und verifiziert
+     */
+    bool saveSession();
+
+    /**
+     * Verwirft die Session im RAM und im EEPROM (z.B. nach Löschen des Geräts
+     * im Network-Server). Die Nonces bleiben erhalten, da bereits verwendete
+     * DevNonces vom Network-Server abgelehnt werden.
+     */
+    void clearSession();
     
     /**
      * Komplette Initialisierung: Radio + LoRaWAN + Join
@@ -445,11 +556,31 @@ public:
     
     /**
      * Sendet ein fertiges Payload über LoRaWAN
+     * Passt das Payload bei der aktuellen Data Rate nicht in einen Uplink, wird es
+     * kopiert und als Fragmente (siehe LoRaWAN_Fragment.h) gesendet: das erste sofort,
+     * falls der Duty-Cycle es erlaubt, die weiteren mit process(). Es kann nur ein
+     * fragmentiertes Payload gleichzeitig offen sein.
+     * Die Session (Frame-Counter) wird nach jedem Uplink im EEPROM gespeichert.
      * @param payload Pointer auf das Payload-Array
-     * @param payloadSize Größe des Payloads in Bytes
-     * @return true, wenn erfolgreich gesendet
+     * @param payloadSize Größe des Payloads in Bytes (max. LORAWAN_FRAGMENT_MAX_MESSAGE_SIZE)
+     * @return true, wenn gesendet oder die Fragmentierung gestartet wurde (siehe getUplinkState())
      */
     bool sendPayload(const uint8_t* payload, size_t payloadSize);
+
+    /**
+     * Sendet das nächste Fragment, sobald der Duty-Cycle es erlaubt (timeUntilUplink() == 0),
+     * zyklisch in loop() aufrufen. Wartet nie: ohne freie Sendezeit kehrt die Funktion sofort
+     * zurück. Ein Fragment selbst blockiert für Senden und beide Empfangsfenster.
+     * Schlägt ein Fragment fehl, wird die ganze Nachricht abgebrochen.
+     * @return Zustand des fragmentierten Uplinks
+     */
+    SX1262_UplinkState process();
+
+    /**
+     * Gibt den Zustand des fragmentierten Uplinks zurück
+     * @return Uplink-Zustand
+     */
+    SX1262_UplinkState getUplinkState();
     
     
     // ================================================================
@@ -65,8 +65,54 @@ bool MQTTClient::publishAcknowledged(){
 bool MQTTClient::publish(const char* topicname, const char* payload){
     //TimeoutTimer timeout_ms(28000);
     
-    isPublishAcknowledged = MqttClient.publish(topicname, payload, AT_LEAST_ONCE, 60000U);
-    return isPublishAcknowledged;
+    //Older stored messages have to be sent first, so only send directly if nothing is waiting
+    if (_outbox.isEmpty() && connected())
+    {
+        isPublishAcknowledged = MqttClient.publish(topicname, payload, AT_LEAST_ONCE, 60000U);
+        if (isPublishAcknowledged)
+        {
+            return true;
+        }
+        //Keep the message till the broker is reachable again
+        return _outbox.push(topicname, payload);
+    }
+    isPublishAcknowledged = false;
+    if (!_outbox.push(topicname, payload))
+    {
+        return false;
+    }
+    drainOutbox();
+    //The new message is the newest one, so it is acknowledged once the outbox is empty
+    isPublishAcknowledged = _outbox.isEmpty();
+    return true;
+}
+
+uint8_t MQTTClient::drainOutbox(uint8_t maxMessages){
+    uint8_t sent = {0};
+    const char* topicname;
+    const char* payload;
+    while (sent < maxMessages && connected() && _outbox.peek(topicname, payload))
+    {
+        Watchdog.reset();
+        isPublishAcknowledged = MqttClient.publish(topicname, payload, AT_LEAST_ONCE, 60000U);
+        Watchdog.reset();
+        //Backpressure: the message stays the oldest one and is retried with the next call
+        if (!publishAcknowledged())
+        {
+            break;
+        }
+        _outbox.pop();
+        sent++;
+    }
+    return sent;
+}
+
+uint8_t MQTTClient::getOutboxCount(){
+    return _outbox.getCount();
+}
+
+uint16_t MQTTClient::getOutboxDroppedCount(){
+    return _outbox.getDroppedCount();
 }
 
 bool MQTTClient::connected(){
@@ -74,10 +120,8 @@ bool MQTTClient::connected(){
 }
 
 bool MQTTClient::connect(){
-    Watchdog.reset();
-    if (MqttClient.begin(_clientid, _host, _port, true, _keepalive, true, _username, _password, 120000U))
+    if (beginConnect())
     {   
-        Watchdog.reset();
         //Wait till begin() is truely finished and modem sent callback for succesfull connection
         while (!MqttClient.isConnected())
         {
@@ -93,6 +137,13 @@ bool MQTTClient::connect(){
     }  
 }
 
+bool MQTTClient::beginConnect(){
+    Watchdog.reset();
+    bool is_begun = MqttClient.begin(_clientid, _host, _port, true, _keepalive, true, _username, _password, 120000U);
+    Watchdog.reset();
+    return is_begun;
+}
+
 bool MQTTClient::end(){
    return MqttClient.end();
 }
@@ -123,4 +174,279 @@ bool MQTTTopic::publish(const char* payload) {
   return _client->publish(_topicname, payload);
 }
 
+/*MQTT Batch Class*/
+
+MQTTBatch::MQTTBatch(){
+    setMQTTBatchParam(nullptr);
+}
+
+MQTTBatch::MQTTBatch(MQTTTopic* topic, uint8_t maxSamples, uint32_t maxAgeMs){
+    setMQTTBatchParam(topic, maxSamples, maxAgeMs);
+}
+
+void MQTTBatch::setMQTTBatchParam(MQTTTopic* topic, uint8_t maxSamples, uint32_t maxAgeMs){
+    _topic = topic;
+    _maxSamples = maxSamples;
+    _maxAgeMs = maxAgeMs;
+    _buffer[0] = '\0';
+    _length = {0};
+    _count = {0};
+    _firstSampleTime = {0};
+}
+
+bool MQTTBatch::add(const char* sample){
+    if (_topic == nullptr)
+    {
+        return false;
+    }
+    size_t sampleLength = strlen(sample);
+    //Opening bracket or comma before the sample and the closing bracket
+    if (sampleLength + 2 > MQTT_BATCH_SIZE)
+    {
+        bool is_flushed = flush();
+        return _topic->publish(sample) && is_flushed;
+    }
+    bool is_flushed = true;
+    if (_length + 1 + sampleLength + 1 > MQTT_BATCH_SIZE)
+    {
+        is_flushed = flush();
+    }
+    if (_count == 0)
+    {
+        _buffer[0] = '[';
+        _length = 1;
+        _firstSampleTime = millis();
+    }else{
+        _buffer[_length++] = ',';
+    }
+    memcpy(&_buffer[_length], sample, sampleLength);
+    _length += sampleLength;
+    _count++;
+    if (_maxSamples > 0 && _count >= _maxSamples)
+    {
+        return flush() && is_flushed;
+    }
+    return is_flushed;
+}
+
+bool MQTTBatch::process(){
+    if (_count > 0 && millis() - _firstSampleTime >= _maxAgeMs)
+    {
+        return flush();
+    }
+    return true;
+}
+
+bool MQTTBatch::flush(){
+    if (_count == 0)
+    {
+        return true;
+    }
+    _buffer[_length] = ']';
+    _buffer[_length + 1] = '\0';
+    bool is_published = _topic->publish(_buffer);
+    //The batch is emptied anyway, the outbox keeps the message if the broker was not reachable
+    if (!is_published)
+    {
+        Serial3.print(F("[ERROR]: Failed to publish MQTT batch, samples lost: "));
+        Serial3.println(_count);
+    }
+    _length = {0};
+    _count = {0};
+    return is_published;
+}
+
+uint8_t MQTTBatch::getCount(){
+    return _count;
+}
+
+/*MQTT Outbox Class*/
+
+uint32_t MQTTOutbox::getSlotAddress(uint8_t slot){
+    return ADDRESS_MQTT_OUTBOX + (uint32_t)slot * MQTT_OUTBOX_SLOT_SIZE;
+}
+
+bool MQTTOutbox::readHeader(uint8_t slot, MQTTOutboxHeader &header){
+    EEPROM_SPI.getEEPROMData(getSlotAddress(slot), header);
+    //CRC over sequence, lengths and crc is 0 for a valid header
+    if (CRC8.Compute_CRC8((uint8_t *)&header, offsetof(MQTTOutboxHeader, crc) + 1) != 0)
+    {
+        return false;
+    }
+    return header.topicLength > 0 && header.payloadLength > 0 &&
+           header.topicLength + header.payloadLength <= MQTT_OUTBOX_MAX_DATA;
+}
+
+void MQTTOutbox::checkLayout(){
+    MQTTOutboxLayout layout;
+    EEPROM_SPI.getEEPROMData(ADDRESS_MQTT_OUTBOX_LAYOUT, layout);
+    if (CRC8.Compute_CRC8((uint8_t *)&layout, sizeof(layout)) == 0 && layout.version == MQTT_OUTBOX_LAYOUT_VERSION)
+    {
+        return;
+    }
+    Serial3.println(F("[WARNING]: MQTT outbox layout changed, outbox cleared"));
+    //A zero header has no topic and is never taken for a message
+    MQTTOutboxHeader header = {0};
+    for (uint8_t slot = 0; slot < MQTT_OUTBOX_SLOTS; slot++)
+    {
+        EEPROM_SPI.putEEPROMData(getSlotAddress(slot), header);
+    }
+    layout.version = MQTT_OUTBOX_LAYOUT_VERSION;
+    layout.crc = CRC8.Compute_CRC8((uint8_t *)&layout, offsetof(MQTTOutboxLayout, crc));
+    if (!EEPROM_SPI.putEEPROMDataVerified(ADDRESS_MQTT_OUTBOX_LAYOUT, layout))
+    {
+        Serial3.println(F("[ERROR]: Failed to write the MQTT outbox layout to EEPROM"));
+    }
+}
+
+void MQTTOutbox::load(){
+    if (is_loaded)
+    {
+        return;
+    }
+    if (!EEPROM_SPI.isInitialized())
+    {
+        EEPROM_SPI.begin();
+    }
+    checkLayout();
+    bool is_anyValid = false;
+    uint8_t newest = {0};
+    uint32_t oldestPendingSequence = {0};
+    for (uint8_t slot = 0; slot < MQTT_OUTBOX_SLOTS; slot++)
+    {
+        MQTTOutboxHeader header;
+        if (!readHeader(slot, header))
+        {
+            continue;
+        }
+        if (!is_anyValid || (int32_t)(header.sequence - nextSequence) >= 0)
+        {
+            newest = slot;
+            nextSequence = header.sequence + 1;
+            is_anyValid = true;
+        }
+        if (header.state == MQTT_OUTBOX_PENDING)
+        {
+            if (count == 0 || (int32_t)(header.sequence - oldestPendingSequence) < 0)
+            {
+                head = slot;
+                oldestPendingSequence = header.sequence;
+            }
+            count++;
+        }
+    }
+    //Continue behind the newest message, so the slots are used evenly
+    if (count == 0 && is_anyValid)
+    {
+        head = (newest + 1) % MQTT_OUTBOX_SLOTS;
+    }
+    is_loaded = true;
+    if (count > 0)
+    {
+        Serial3.print(F("MQTT outbox: "));
+        Serial3.print(count);
+        Serial3.println(F(" messages pending"));
+    }
+}
+
+bool MQTTOutbox::push(const char* topicname, const char* payload){
+    load();
+    size_t topicLength = strlen(topicname) + 1;
+    size_t payloadLength = strlen(payload) + 1;
+    if (topicLength > UINT8_MAX || topicLength + payloadLength > MQTT_OUTBOX_MAX_DATA)
+    {
+        Serial3.println(F("[ERROR]: MQTT message too large for the outbox"));
+        return false;
+    }
+    if (count == MQTT_OUTBOX_SLOTS)
+    {
+        //Newer data is more valuable than the oldest message, which would be overwritten anyway
+        Serial3.println(F("[WARNING]: MQTT outbox full, oldest message dropped"));
+        head = (head + 1) % MQTT_OUTBOX_SLOTS;
+        count--;
+        droppedCount++;
+    }
+    uint8_t slot = (head + count) % MQTT_OUTBOX_SLOTS;
+    uint32_t address = getSlotAddress(slot);
+
+    MQTTOutboxHeader header = {0};
+    header.sequence = nextSequence;
+    header.topicLength = topicLength;
+    header.payloadLength = payloadLength;
+    header.crc = CRC8.Compute_CRC8((uint8_t *)&header, offsetof(MQTTOutboxHeader, crc));
+    header.state = MQTT_OUTBOX_PENDING;
+
+    //Header, topic and payload are gathered in the write buffer and written in one write cycle per write page
+    EEPROM_SPI.putEEPROMDataBuffered(address, header);
+    EEPROM_SPI.writeBufferedEEPROM(address + sizeof(header), (const uint8_t *)topicname, topicLength);
+    EEPROM_SPI.writeBufferedEEPROM(address + sizeof(header) + topicLength, (const uint8_t *)payload, payloadLength);
+    EEPROM_SPI.flushWriteBuffer();
+
+    MQTTOutboxHeader readBack;
+    bool is_verified = readHeader(slot, readBack) && readBack.sequence == header.sequence && readBack.state == MQTT_OUTBOX_PENDING;
+    if (is_verified)
+    {
+        EEPROM_SPI.readExternEEPROM(address + sizeof(header), (uint8_t *)buffer, topicLength + payloadLength);
+        is_verified = memcmp(buffer, topicname, topicLength) == 0 && memcmp(buffer + topicLength, payload, payloadLength) == 0;
+    }
+    if (!is_verified)
+    {
+        Serial3.println(F("[ERROR]: Failed to write MQTT message to the outbox"));
+        return false;
+    }
+    nextSequence++;
+    count++;
+    return true;
+}
+
+bool MQTTOutbox::peek(const char* &topicname, const char* &payload){
+    load();
+    while (count > 0)
+    {
+        MQTTOutboxHeader header;
+        if (readHeader(head, header) && header.state == MQTT_OUTBOX_PENDING)
+        {
+            uint16_t length = header.topicLength + header.payloadLength;
+            EEPROM_SPI.readExternEEPROM(getSlotAddress(head) + sizeof(header), (uint8_t *)buffer, length);
+            if (buffer[header.topicLength - 1] == '\0' && buffer[length - 1] == '\0')
+            {
+                topicname = buffer;
+                payload = buffer + header.topicLength;
+                return true;
+            }
+        }
+        Serial3.println(F("[WARNING]: Corrupted MQTT message in the outbox dropped"));
+        head = (head + 1) % MQTT_OUTBOX_SLOTS;
+        count--;
+        droppedCount++;
+    }
+    return false;
+}
+
+void MQTTOutbox::pop(){
+    load();
+    if (count == 0)
+    {
+        return;
+    }
+    //Only the state byte is overwritten, the header crc stays valid for the sequence scan in load()
+    const uint8_t acked = MQTT_OUTBOX_ACKED;
+    EEPROM_SPI.writeExternEEPROM(getSlotAddress(head) + offsetof(MQTTOutboxHeader, state), &acked, 1);
+    head = (head + 1) % MQTT_OUTBOX_SLOTS;
+    count--;
+}
+
+uint8_t MQTTOutbox::getCount(){
+    load();
+    return count;
+}
+
+bool MQTTOutbox::isEmpty(){
+    return getCount() == 0;
+}
+
+uint16_t MQTTOutbox::getDroppedCount(){
+    return droppedCount;
+}
+
 #endif
\ No newline at end of file
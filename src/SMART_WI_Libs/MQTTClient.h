@@ -15,6 +15,120 @@
 #include <mqtt_client.h>
 #include <timeout_timer.h>
 #include "watchdogAVR.h"
+#include "EEPROM_SPI.h"
+#include "CRC8.h"
+
+const uint16_t MQTT_OUTBOX_SLOT_SIZE = 2 * EEPROM_WRITE_PAGE_SIZE;    //Two write pages per message, large enough for a batch of MQTTBatch
+const uint8_t MQTT_OUTBOX_SLOTS = SIZE_MQTT_OUTBOX / MQTT_OUTBOX_SLOT_SIZE;
+const uint8_t MQTT_OUTBOX_DRAIN_BATCH = {8};   //Max number of stored messages published by one drainOutbox() call
+const uint16_t MQTT_BATCH_SIZE = {384};         //Max payload of a batch incl. brackets, a batch plus topic has to fit into one outbox slot
+const uint32_t MQTT_BATCH_MAX_AGE_MS = {600000};    //Default max time a sample waits in a batch before it is published
+const uint8_t MQTT_OUTBOX_PENDING = {0xA5};    //State of a message, which is not yet acknowledged by the broker
+const uint8_t MQTT_OUTBOX_ACKED = {0x00};      //State of a message, which has been acknowledged by the broker
+const uint8_t MQTT_OUTBOX_LAYOUT_VERSION = {1}; //Increase if position or size of the slots change, the outbox is cleared once then
+
+/**
+ * @brief Header at the begining of every outbox slot, followed by the topic and the payload
+ * 
+ */
+struct MQTTOutboxHeader{
+    uint32_t sequence;      //Order of the messages, increases with every stored message
+    uint8_t topicLength;    //incl. terminating '\0'
+    uint16_t payloadLength; //incl. terminating '\0'
+    uint8_t crc;            //CRC of sequence and lengths
+    uint8_t state;          //Not covered by the crc, as it is overwritten on its own when the message is acknowledged
+};
+
+/**
+ * @brief Layout version of the outbox, stored in the configuration area
+ * 
+ */
+struct MQTTOutboxLayout{
+    uint8_t version;
+    uint8_t crc;
+};
+
+const uint16_t MQTT_OUTBOX_MAX_DATA = MQTT_OUTBOX_SLOT_SIZE - sizeof(MQTTOutboxHeader);    //Max size of topic plus payload, incl. both '\0'
+
+/**
+ * @brief Store-and-forward outbox of MQTTClient in a circular region of the external EEPROM.
+ * Messages are kept till the broker acknowledged them, so they survive connection losses and reboots.
+ * Head and number of pending messages are rebuilt from the slot headers, no pointers are written.
+ * 
+ */
+class MQTTOutbox
+{
+private:
+    uint8_t head = {0};             //Slot of the oldest pending message
+    uint8_t count = {0};            //Number of pending messages
+    uint32_t nextSequence = {0};
+    uint16_t droppedCount = {0};
+    bool is_loaded = {false};
+    char buffer[MQTT_OUTBOX_MAX_DATA];  //Topic and payload of the oldest message, see peek()
+
+    uint32_t getSlotAddress(uint8_t slot);
+
+    /**
+     * @brief Reads the header of a slot
+     * 
+     * @return true if the header is valid
+     */
+    bool readHeader(uint8_t slot, MQTTOutboxHeader &header);
+
+    /**
+     * @brief Clears all slot headers once, if the stored layout version does not match MQTT_OUTBOX_LAYOUT_VERSION.
+     * The region of the outbox held telemetry data before, which must not be taken for messages
+     * 
+     */
+    void checkLayout();
+
+    /**
+     * @brief Scans all slot headers once to find the oldest pending message and the next sequence number
+     * 
+     */
+    void load();
+
+public:
+    /**
+     * @brief Stores a message behind the newest one. If the outbox is full, the oldest message is dropped.
+     * 
+     * @param topicname 
+     * @param payload 
+     * @return true if the message is stored and verified on the EEPROM
+     */
+    bool push(const char* topicname, const char* payload);
+
+    /**
+     * @brief Reads the oldest pending message. Corrupted messages are skipped.
+     * 
+     * @param topicname points to the internal buffer, valid till the next call of the outbox
+     * @param payload points to the internal buffer, valid till the next call of the outbox
+     * @return true if there is a pending message
+     */
+    bool peek(const char* &topicname, const char* &payload);
+
+    /**
+     * @brief Marks the oldest pending message as acknowledged
+     * 
+     */
+    void pop();
+
+    /**
+     * @return Number of pending messages
+     */
+    uint8_t getCount();
+
+    /**
+     * @return True if there are no pending messages
+     */
+    bool isEmpty();
+
+    /**
+     * @return Number of messages dropped since start, as the outbox was full or they were corrupted
+     */
+    uint16_t getDroppedCount();
+};
+
 /*For MQTT connection*/
 class MQTTClient//: public MqttClient
 {
@@ -27,6 +141,7 @@ private:
     const char* _password;
     uint16_t _keepalive;
     static bool isPublishAcknowledged;
+    MQTTOutbox _outbox;
 public:
 
     /**
@@ -86,6 +201,14 @@ public:
      */
     bool connect();
 
+    /**
+     * @brief Starts the connection to the MQTT broker without waiting till the modem
+     * confirmed it. The connection is established once connected() returns true.
+     * 
+     * @return true if the connection was started
+     */
+    bool beginConnect();
+
     /**
      * @brief Disconnects from the broker and resets the state in the MQTT
      * client.
@@ -93,13 +216,34 @@ public:
      * @return true if disconnection was successfull
      */
     bool end();
+
+    /**
+     * @brief Publishes the stored messages of the outbox in order, while connected.
+     * Stops at the first message the broker does not acknowledge, it is retried with the next call.
+     * Should be called cyclically and after connect().
+     * 
+     * @param maxMessages Max number of messages published by this call
+     * @return Number of acknowledged messages
+     */
+    uint8_t drainOutbox(uint8_t maxMessages = MQTT_OUTBOX_DRAIN_BATCH);
+
+    /**
+     * @return Number of messages in the outbox, which are not yet acknowledged by the broker
+     */
+    uint8_t getOutboxCount();
+
+    /**
+     * @return Number of messages the outbox dropped since start
+     */
+    uint16_t getOutboxDroppedCount();
 protected:
     /**
-     * @brief Publish MQTT message
+     * @brief Publish MQTT message. It is sent directly, if connected and the outbox is empty.
+     * Otherwise, or if the broker does not acknowledge it, it is stored in the outbox.
      * 
      * @param topicname 
      * @param payload 
-     * @return true if publishing was successfull
+     * @return true if publishing was successfull or the message is stored in the outbox
      */
     bool publish(const char* topicname, const char* payload);
 
@@ -145,10 +289,82 @@ class MQTTTopic {
      * @brief Publishes payload to the specified topic
      * 
      * @param payload 
-     * @return true if publishing was successfull
+     * @return true if publishing was successfull or the message is stored in the outbox
      */
     bool publish(const char* payload);
 };
 
+/**
+ * @brief Aggregates several JSON samples into one JSON array, which is published with one message
+ * to a MQTTTopic. On cellular every publish costs a radio wake-up and a PUBACK round trip,
+ * so fewer and larger messages save data volume and energy.
+ * The batch is published, if the next sample does not fit anymore (size), if maxSamples are
+ * reached (count) or if the oldest sample waits longer than maxAgeMs (age, checked by process()).
+ * 
+ */
+class MQTTBatch {
+  private:
+    MQTTTopic* _topic;
+    char _buffer[MQTT_BATCH_SIZE + 1];  //"[sample,sample,...", the closing bracket is added by flush()
+    uint16_t _length;
+    uint8_t _count;
+    uint8_t _maxSamples;
+    uint32_t _maxAgeMs;
+    unsigned long _firstSampleTime;
+
+  public:
+    /**
+     * @brief Construct a new MQTTBatch object
+     * 
+     */
+    MQTTBatch();
+
+    /**
+     * @brief Construct a new MQTTBatch object
+     * 
+     * @param topic topic the batches are published to
+     * @param maxSamples max number of samples per batch, 0 for as many as fit into MQTT_BATCH_SIZE
+     * @param maxAgeMs max time the oldest sample waits before the batch is published
+     */
+    MQTTBatch(MQTTTopic* topic, uint8_t maxSamples = 0, uint32_t maxAgeMs = MQTT_BATCH_MAX_AGE_MS);
+
+    /**
+     * @brief Sets the MQTT Batch parameters
+     * 
+     * @param topic 
+     * @param maxSamples 
+     * @param maxAgeMs 
+     */
+    void setMQTTBatchParam(MQTTTopic* topic, uint8_t maxSamples = 0, uint32_t maxAgeMs = MQTT_BATCH_MAX_AGE_MS);
+
+    /**
+     * @brief Adds a sample to the batch. If it does not fit, the current batch is published first.
+     * A sample, which is larger than a whole batch, is published on its own.
+     * 
+     * @param sample JSON object of one sample, e.g. {"temp1":21.5,"ts":1700000000}
+     * @return true if the sample is added and every batch published by this call was successfull
+     */
+    bool add(const char* sample);
+
+    /**
+     * @brief Publishes the batch, if its oldest sample is older than maxAgeMs. Has to be called cyclically.
+     * 
+     * @return false if publishing failed
+     */
+    bool process();
+
+    /**
+     * @brief Publishes the samples of the batch as JSON array and empties the batch
+     * 
+     * @return true if the batch was empty or publishing was successfull
+     */
+    bool flush();
+
+    /**
+     * @return Number of samples in the batch
+     */
+    uint8_t getCount();
+};
+
 #endif
 #endif
\ No newline at end of file
@@ -26,6 +26,7 @@ SensorClass::SensorClass(const sensorType& _sensorType, const MeasuringRange& mR
     calcRange();
     calcResolution();
     calcZeroValue();
+    calcConversion();
 }
 
 SensorClass::SensorClass(const MeasuringRange& mRange, const signalType& _signalType,
@@ -51,6 +52,7 @@ SensorClass::SensorClass(const MeasuringRange& mRange, const signalType& _signal
     calcRange();
     calcResolution();
     calcZeroValue();
+    calcConversion();
 }
 
 SensorClass::~SensorClass() {
@@ -123,4 +125,308 @@ void SensorClass::printValues()
     SerialMon.print("zero: ");
     SerialMon.println(this->zeroValue);
     SerialMon.println("");
-}
\ No newline at end of file
+}
+
+void SensorClass::calcConversion(){
+    //The measured value rises with the signal if the min measuring value is at the min signal value, else it falls
+    float direction = measuringMinIsSignalMin ? res : -res;
+    convGain = direction * signalPerCount;
+    convOffset = direction * (signalAtZeroCount - mySignalRange.signalOffset - zeroValue) + myMeasuringRange.measuringOffset;
+    //The integer conversion and the lookup table are not valid anymore
+    is_fixedPointValid = false;
+    rawLUT = nullptr;
+}
+
+void SensorClass::setRawScaling(float _signalPerCount, float _signalAtZeroCount){
+    signalPerCount = _signalPerCount;
+    signalAtZeroCount = _signalAtZeroCount;
+    calcConversion();
+}
+
+float SensorClass::convertRaw(uint16_t raw) const{
+    return applyCalibrationFloat(convGain * raw + convOffset);
+}
+
+void SensorClass::convertRawBatch(const uint16_t raw[], float values[], uint16_t count) const{
+    const float gain = convGain;
+    const float offset = convOffset;
+    if (myCalibration.type != CalibrationType::noCalibration)
+    {
+        for (uint16_t i = 0; i < count; i++)
+        {
+            values[i] = applyCalibrationFloat(gain * raw[i] + offset);
+        }
+        return;
+    }
+    for (uint16_t i = 0; i < count; i++)
+    {
+        values[i] = gain * raw[i] + offset;
+    }
+}
+
+bool SensorClass::setFixedPointDecimals(uint8_t decimals){
+    is_fixedPointValid = false;
+    rawLUT = nullptr;
+    if (decimals > MAX_FIXED_POINT_DECIMALS)
+    {
+        SerialMon.println("[ERROR]: Too many decimals for the fixed point conversion");
+        return false;
+    }
+    float scale = 1.0F;
+    for (uint8_t i = 0; i < decimals; i++)
+    {
+        scale *= 10.0F;
+    }
+    //The calibration curve of the float conversions refers to these decimals, even if int16 is too small
+    fixedScale = scale;
+    //The conversion is linear, so every value fits into int16 if the values at both ends of the input do
+    float first = convOffset * scale;
+    float last = (convGain * (RAW_LUT_SIZE - 1) + convOffset) * scale;
+    if (first < INT16_MIN || first > INT16_MAX || last < INT16_MIN || last > INT16_MAX)
+    {
+        SerialMon.println("[ERROR]: Measuring range does not fit into int16 with this number of decimals");
+        return false;
+    }
+    //Q15, so the product can not overflow int32: both ends fit into int16, so |fixedGain * raw| <= |last - first| * 2^15 < 2^31.
+    //fixedOffset and the result of fixedGain * raw + fixedOffset (incl. rounding) are int16 values in Q15 as well
+    fixedGain = (int32_t)lround(convGain * scale * 32768.0F);
+    fixedOffset = (int32_t)lround(convOffset * scale * 32768.0F);
+    is_fixedPointValid = true;
+    return true;
+}
+
+bool SensorClass::buildLUT(int16_t (&lut)[RAW_LUT_SIZE]){
+    if (!is_fixedPointValid)
+    {
+        return false;
+    }
+    //Add the gain step by step instead of a multiplication per value, the calibration is part of the table
+    //The gain is not added after the last value, as the value behind the input range may not fit into int32
+    int32_t value = fixedOffset + 0x4000;
+    lut[0] = applyCalibration((int16_t)(value >> 15));
+    for (uint16_t i = 1; i < RAW_LUT_SIZE; i++)
+    {
+        value += fixedGain;
+        lut[i] = applyCalibration((int16_t)(value >> 15));
+    }
+    rawLUT = lut;
+    return true;
+}
+
+/**
+ * @brief Limit a raw value to the 12 bit input range, so values above it are converted as full scale
+ * 
+ */
+static inline uint16_t clampRaw(uint16_t raw){
+    return (raw < RAW_LUT_SIZE) ? raw : RAW_LUT_SIZE - 1;
+}
+
+bool SensorClass::convertRawBatch(const uint16_t raw[], int16_t values[], uint16_t count) const{
+    if (!is_fixedPointValid)
+    {
+        return false;
+    }
+    if (rawLUT != nullptr)
+    {
+        for (uint16_t i = 0; i < count; i++)
+        {
+            values[i] = rawLUT[clampRaw(raw[i])];
+        }
+        return true;
+    }
+    //The clamp also keeps fixedGain * raw within int32, see setFixedPointDecimals
+    for (uint16_t i = 0; i < count; i++)
+    {
+        values[i] = applyCalibration((int16_t)((fixedGain * (int32_t)clampRaw(raw[i]) + fixedOffset + 0x4000) >> 15));
+    }
+    return true;
+}
+
+/**
+ * @brief Saturate a value to int16
+ * 
+ */
+static int16_t saturateInt16(int32_t value){
+    if (value > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return value;
+}
+
+bool SensorClass::setCalibration(const CalibrationCurve &curve){
+    myCalibration = CalibrationCurve();
+    rawLUT = nullptr;
+    if (curve.type == CalibrationType::polynomial)
+    {
+        if (curve.count < 1 || curve.count > MAX_POLYNOMIAL_COEFFICIENTS)
+        {
+            SerialMon.println("[ERROR]: Invalid number of calibration coefficients");
+            return false;
+        }
+    }
+    else if (curve.type == CalibrationType::piecewiseLinear)
+    {
+        if (curve.count < 2 || curve.count > MAX_CALIBRATION_POINTS)
+        {
+            SerialMon.println("[ERROR]: Invalid number of calibration points");
+            return false;
+        }
+        //The slopes are calculated once here, so the evaluation needs no division
+        for (uint8_t i = 0; i < curve.count - 1; i++)
+        {
+            int32_t dx = (int32_t)curve.values[2 * (i + 1)] - curve.values[2 * i];
+            int32_t dy = (int32_t)curve.values[2 * (i + 1) + 1] - curve.values[2 * i + 1];
+            if (dx <= 0)
+            {
+                SerialMon.println("[ERROR]: x values of the calibration points have to be ascending");
+                return false;
+            }
+            float slope = constrain((float)dy * 65536.0F / dx, -2.0E9F, 2.0E9F);
+            calibrationSlopes[i] = (int32_t)lround(slope);
+        }
+    }
+    else if (curve.type != CalibrationType::noCalibration)
+    {
+        SerialMon.println("[ERROR]: Unknown calibration type");
+        return false;
+    }
+    myCalibration = curve;
+    return true;
+}
+
+const CalibrationCurve &SensorClass::getCalibration() const{
+    return myCalibration;
+}
+
+int16_t SensorClass::evalPolynomial(int16_t x) const{
+    const int16_t (&c)[2 * MAX_CALIBRATION_POINTS] = myCalibration.values;
+    uint8_t n = myCalibration.count;
+    //Horner's scheme with 16 x 16 bit products, the sum is kept in Q14 and saturated to 16 bit
+    int32_t sum = c[n - 1];
+    for (int8_t i = n - 2; i >= 1; i--)
+    {
+        sum = saturateInt16(((sum * x + (1L << 14)) >> 15) + c[i]);
+    }
+    if (n == 1)
+    {
+        return saturateInt16((int32_t)c[0] * 2);
+    }
+    //Last step in Q28, so the result keeps the full resolution: (Q14 * Q15) / 2 + c0 * 2^14
+    int32_t result = ((sum * x) >> 1) + ((int32_t)c[0] << 14);
+    return saturateInt16((result + (1L << 12)) >> 13);
+}
+
+int16_t SensorClass::evalPiecewiseLinear(int16_t x) const{
+    const int16_t (&p)[2 * MAX_CALIBRATION_POINTS] = myCalibration.values;
+    uint8_t segment = {0};
+    while (segment < myCalibration.count - 2 && x >= p[2 * (segment + 1)])
+    {
+        segment++;
+    }
+    //dx * slope in Q16 with 16 x 16 bit products only: |dx| * (high word + low word / 2^16)
+    int32_t dx = (int32_t)x - p[2 * segment];
+    int32_t slope = calibrationSlopes[segment];
+    bool is_negative = (dx < 0) != (slope < 0);
+    uint32_t absDx = (dx < 0) ? -dx : dx;
+    uint32_t absSlope = (slope < 0) ? -slope : slope;
+    uint32_t delta = absDx * (absSlope >> 16) + ((absDx * (absSlope & 0xFFFF) + 0x8000) >> 16);
+    if (delta > 0xFFFF)
+    {
+        delta = 0xFFFF;
+    }
+    int32_t y = p[2 * segment + 1] + (is_negative ? -(int32_t)delta : (int32_t)delta);
+    return saturateInt16(y);
+}
+
+int16_t SensorClass::applyCalibration(int16_t value) const{
+    switch (myCalibration.type)
+    {
+    case CalibrationType::polynomial:
+        return evalPolynomial(value);
+    case CalibrationType::piecewiseLinear:
+        return evalPiecewiseLinear(value);
+    default:
+        return value;
+    }
+}
+
+float SensorClass::applyCalibrationFloat(float value) const{
+    const int16_t (&c)[2 * MAX_CALIBRATION_POINTS] = myCalibration.values;
+    //The curve is defined on the fixed point values
+    float x = value * fixedScale;
+    float y = x;
+    switch (myCalibration.type)
+    {
+    case CalibrationType::polynomial:
+    {
+        //Same scaling as evalPolynomial: x as fraction of 32768, coefficients in Q14, result in Q15
+        float fraction = x / 32768.0F;
+        float sum = c[myCalibration.count - 1];
+        for (int8_t i = myCalibration.count - 2; i >= 0; i--)
+        {
+            sum = sum * fraction + c[i];
+        }
+        y = sum * 2.0F;
+        break;
+    }
+    case CalibrationType::piecewiseLinear:
+    {
+        uint8_t segment = {0};
+        while (segment < myCalibration.count - 2 && x >= c[2 * (segment + 1)])
+        {
+            segment++;
+        }
+        y = c[2 * segment + 1] + (x - c[2 * segment]) * (calibrationSlopes[segment] / 65536.0F);
+        break;
+    }
+    default:
+        return value;
+    }
+    return y / fixedScale;
+}
+
+bool SensorClass::saveCalibration(uint8_t slot){
+    if ((uint32_t)(slot + 1) * sizeof(CalibrationCurve) > SIZE_CALIBRATION_AREA)
+    {
+        SerialMon.println("[ERROR]: Calibration slot out of range");
+        return false;
+    }
+    //Minus last element, cause we do not need the last element as it is the CRC we calculate
+    myCalibration.crc = CRC8.Compute_CRC8((uint8_t *)&myCalibration, sizeof(myCalibration) - 1);
+    if (!EEPROM_SPI.isInitialized())
+    {
+        EEPROM_SPI.begin();
+    }
+    if (!EEPROM_SPI.putEEPROMDataVerified(ADDRESS_CALIBRATION + slot * sizeof(CalibrationCurve), myCalibration))
+    {
+        SerialMon.println("[ERROR]: Failed to write calibration curve to EEPROM");
+        return false;
+    }
+    return true;
+}
+
+bool SensorClass::loadCalibration(uint8_t slot){
+    if ((uint32_t)(slot + 1) * sizeof(CalibrationCurve) > SIZE_CALIBRATION_AREA)
+    {
+        SerialMon.println("[ERROR]: Calibration slot out of range");
+        return false;
+    }
+    if (!EEPROM_SPI.isInitialized())
+    {
+        EEPROM_SPI.begin();
+    }
+    CalibrationCurve curve;
+    EEPROM_SPI.getEEPROMData(ADDRESS_CALIBRATION + slot * sizeof(CalibrationCurve), curve);
+    if (CRC8.Compute_CRC8((uint8_t *)&curve, sizeof(curve)) != 0)
+    {
+        SerialMon.println("[WARNING]: No valid calibration curve on EEPROM. Sensor is not calibrated");
+        setCalibration(CalibrationCurve());
+        return false;
+    }
+    return setCalibration(curve);
+}
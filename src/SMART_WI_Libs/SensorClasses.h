@@ -6,6 +6,14 @@ With the analog current value the measured physical parameters can be converted.
 #define SensorClasses_h
 #include <stdlib.h>
 #include "SerialMon.h"
+#include "CRC8.h"
+#include "EEPROM_SPI.h"
+
+const uint16_t RAW_LUT_SIZE = {4096};           //Number of values of a 12 bit input
+const uint8_t MAX_FIXED_POINT_DECIMALS = {4};
+const uint8_t MAX_CALIBRATION_POINTS = {8};         //Max number of points of a piecewise linear calibration curve
+const uint8_t MAX_POLYNOMIAL_COEFFICIENTS = {4};    //Max number of coefficients of a polynomial calibration curve (cubic)
+const int16_t CALIBRATION_Q14_ONE = {16384};        //1.0 of the polynomial coefficients in Q14
 
 /**
  * @brief Enum for the output signal type
@@ -24,6 +32,39 @@ public:
     };
 };
 
+/**
+ * @brief Enum for the type of the calibration curve
+ * @param noCalibration     linear mapping of the measuring range only
+ * @param polynomial        polynomial y = c0 + c1*x + c2*x^2 + c3*x^3
+ * @param piecewiseLinear   linear interpolation between calibration points
+ * 
+ */
+class CalibrationType
+{
+public:
+    enum calibrationType{
+        noCalibration,
+        polynomial,
+        piecewiseLinear
+    };
+};
+
+/**
+ * @brief Calibration curve of a sensor, as it is saved on the EEPROM. \n
+ * The curve maps the fixed point values of SensorClass::convertRawBatch to the corrected values. 
+ * The float conversions apply it to the measured value * 10^decimals of SensorClass::setFixedPointDecimals (0 decimals by default). 
+ * For the polynomial, x and y are the fixed point values as fractions of 32768 and the coefficients are in Q14 (16384 = 1.0).
+ * For the piecewise linear curve, values holds the points x0, y0, x1, y1, ... as fixed point values with ascending x
+ * 
+ */
+struct __attribute__((packed)) CalibrationCurve
+{
+    uint8_t type = {CalibrationType::noCalibration};
+    uint8_t count = {0};                                //Number of coefficients or points
+    int16_t values[2 * MAX_CALIBRATION_POINTS] = {0};
+    uint8_t crc = {0};
+};
+
 /**
  * @brief Struct for the measuring range of the sensor
  * @param minOutputValue    min measuring value
@@ -100,6 +141,25 @@ class SensorClass : public OutputSignalType, public SensorType{
          */
         void calcZeroValue();
 
+        /**
+         * @brief Fold signal scaling, resolution, zero value and offsets into the coefficients of the conversion
+         * value = convGain * raw + convOffset
+         * 
+         */
+        void calcConversion();
+
+        /**
+         * @brief Evaluate the polynomial calibration curve with Horner's scheme in fixed point
+         * 
+         */
+        int16_t evalPolynomial(int16_t x) const;
+
+        /**
+         * @brief Evaluate the piecewise linear calibration curve, the outer segments are extrapolated
+         * 
+         */
+        int16_t evalPiecewiseLinear(int16_t x) const;
+
     public:
 
         sensorType mySensorType;                //enum for sensor type
@@ -205,6 +265,115 @@ class SensorClass : public OutputSignalType, public SensorType{
          */
         void printValues();
 
+        /**
+         * @brief Set the scaling of the raw input (e.g. 12 bit RS485 value) to the signal value. \n
+         * For a current signal over the measuring resistance: signalPerCount = refVoltageMax / ADCResolution / resistance * 1000 (mA)
+         * 
+         * @param signalPerCount        signal value (mA or V) of one count of the raw input
+         * @param signalAtZeroCount     signal value (mA or V) at raw input 0
+         */
+        void setRawScaling(float signalPerCount, float signalAtZeroCount = 0.0F);
+
+        /**
+         * @brief Convert a raw input to the measured value with one multiply-add and the calibration curve: 
+         * value = +-(signal - signalOffset - zeroValue) * resolution + measuringOffset
+         * 
+         * @param raw raw input value
+         * @return float measured value (measured unit)
+         */
+        float convertRaw(uint16_t raw) const;
+
+        /**
+         * @brief Convert a batch of raw input values to measured values incl. calibration curve
+         * 
+         * @param raw       raw input values
+         * @param values    [out] measured values
+         * @param count     number of values
+         */
+        void convertRawBatch(const uint16_t raw[], float values[], uint16_t count) const;
+
+        /**
+         * @brief Set up the integer conversion to fixed point values (measured value * 10^decimals) without float operations. 
+         * 
+         * @param decimals number of decimals of the fixed point values
+         * @return true if every raw value of 12 bit fits into int16
+         * @return false if not, then the integer conversion is not available
+         */
+        bool setFixedPointDecimals(uint8_t decimals);
+
+        /**
+         * @brief Fill a lookup table with the fixed point value of every 12 bit raw value and use it for the integer conversion. 
+         * The table needs 8 KB RAM, so it is up to the caller to provide it
+         * 
+         * @param lut [out] table, which is used by convertRawBatch until the conversion is changed
+         * @return true if the table has been filled
+         * @return false if setFixedPointDecimals has not been successful
+         */
+        bool buildLUT(int16_t (&lut)[RAW_LUT_SIZE]);
+
+        /**
+         * @brief Convert a batch of raw input values to fixed point values with the lookup table, 
+         * or with an integer multiply-add if there is no table
+         * 
+         * @param raw       raw input values (12 bit), larger values are converted as full scale
+         * @param values    [out] measured values * 10^decimals
+         * @param count     number of values
+         * @return true if the values have been converted
+         * @return false if setFixedPointDecimals has not been successful
+         */
+        bool convertRawBatch(const uint16_t raw[], int16_t values[], uint16_t count) const;
+
+        /**
+         * @brief Set the calibration curve, which corrects the fixed point values of convertRawBatch and buildLUT. 
+         * A lookup table has to be built again afterwards
+         * 
+         * @param curve calibration curve, the CRC value is not checked
+         * @return true if the curve is valid,
+         * @return false if not (too many points, x not ascending), then there is no calibration
+         */
+        bool setCalibration(const CalibrationCurve &curve);
+
+        /**
+         * @brief Get the calibration curve
+         * 
+         * @return const CalibrationCurve& 
+         */
+        const CalibrationCurve &getCalibration() const;
+
+        /**
+         * @brief Correct a fixed point value with the calibration curve
+         * 
+         * @param value measured value * 10^decimals
+         * @return int16_t corrected value * 10^decimals, the value itself if there is no calibration
+         */
+        int16_t applyCalibration(int16_t value) const;
+
+        /**
+         * @brief Correct a measured value with the calibration curve, evaluated in float on value * 10^decimals
+         * 
+         * @param value measured value (measured unit)
+         * @return float corrected value (measured unit), the value itself if there is no calibration
+         */
+        float applyCalibrationFloat(float value) const;
+
+        /**
+         * @brief Save the calibration curve incl. CRC value on the SPI EEPROM
+         * 
+         * @param slot number of the sensor slot in the calibration area
+         * @return true if writing was successful,
+         * @return false if not or the slot is out of range
+         */
+        bool saveCalibration(uint8_t slot);
+
+        /**
+         * @brief Load the calibration curve from the SPI EEPROM
+         * 
+         * @param slot number of the sensor slot in the calibration area
+         * @return true if a valid curve has been loaded,
+         * @return false if the curve is currupted or the slot is empty, then there is no calibration
+         */
+        bool loadCalibration(uint8_t slot);
+
     protected:
         float res = {0.0};                  //Resolution of the sensor
         float deltaValue = {0.0};           //Range of the sensor
@@ -213,6 +382,19 @@ class SensorClass : public OutputSignalType, public SensorType{
         MeasuringRange myMeasuringRange;    //Measuring range of the sensor
         SignalRange mySignalRange;          //Signal range of the sensor   
 
+        float signalPerCount = {1.0};       //Signal value of one count of the raw input
+        float signalAtZeroCount = {0.0};    //Signal value at raw input 0
+        float convGain = {0.0};             //Measured value of one count of the raw input
+        float convOffset = {0.0};           //Measured value at raw input 0
+        int32_t fixedGain = {0};            //convGain * 10^decimals in Q15
+        int32_t fixedOffset = {0};          //convOffset * 10^decimals in Q15
+        float fixedScale = {1.0};           //10^decimals of the fixed point values, the calibration curve refers to
+        bool is_fixedPointValid = false;
+        const int16_t *rawLUT = nullptr;    //Lookup table of the fixed point values, if it has been built
+
+        CalibrationCurve myCalibration;     //Calibration curve of the sensor
+        int32_t calibrationSlopes[MAX_CALIBRATION_POINTS - 1] = {0};   //Slopes of the piecewise linear segments in Q16
+
 };
 
 #endif
\ No newline at end of file
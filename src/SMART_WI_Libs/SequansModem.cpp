@@ -16,6 +16,12 @@ Created by Csaba Freiberger 02.2023*/
 
 //staticvolatile bool SequansModem::gprs_connected = false;
 
+/**
+ * @brief Link state cache, written by the result code callbacks and by the AT commands for CEREG and CSQ
+ * 
+ */
+static volatile LinkState linkState;
+
 /**
  * @brief Lambda function for resetting Watchdog in functions which need more than 8s
  * 
@@ -63,6 +69,7 @@ bool SequansModem::restart(){
             return false;
         }else{
             Watchdog.reset();
+            invalidateLinkState();
             if(SequansController.writeCommand("AT+CFUN=1")!=ResponseResult::OK){
                 Watchdog.reset();
                 Serial3.println(F("Command (CFUN) response NOT OK"));
@@ -107,6 +114,7 @@ bool SequansModem::restart(){
             return true;
         }
         
+        invalidateLinkState();
         if(SequansController.writeCommand("AT+CFUN=1")!=ResponseResult::OK){
             Watchdog.reset();
             Serial3.println(F("Command (CFUN) response NOT OK"));
@@ -157,6 +165,7 @@ bool SequansModem::reset(){
 
 void SequansModem::end(){
     Lte.end();
+    invalidateLinkState();
 }
 
 bool SequansModem::testAT(){
@@ -178,16 +187,24 @@ bool SequansModem::changeOparatingMode(){
     }
 
     /*Check which modem firmware version is beeing used, as changing to NB-IOT is only possible for from v.8.2.0.2*/
-    String modemInfo = getModemInfo();
-    int startFirmwareversion = modemInfo.indexOf(" UE");
+    char modemInfo[100] = "";
+    getModemInfo(modemInfo, sizeof(modemInfo));
+    const char* firmwareVersion = strstr(modemInfo, " UE");
 
     bool newestFirmwareVersion = false;
-    if (startFirmwareversion>=0){
-        String firmwareVersion = modemInfo.substring(startFirmwareversion+3, startFirmwareversion+10);
-        /*Get from substring the first thre numbers of the firmware version*/
-        firmwareVersion.replace(".","");
+    if (firmwareVersion != nullptr){
+        /*Get the digits of the firmware version without the dots, e.g. 8202 of UE8.2.0.2*/
+        int32_t version = {0};
+        for (const char* c = firmwareVersion + 3; c < firmwareVersion + 10 && *c != '\0'; c++)
+        {
+            if (isdigit((unsigned char)*c)){
+                version = version * 10 + (*c - '0');
+            }else if (*c != '.'){
+                break;
+            }
+        }
 
-        if (firmwareVersion.toInt()>=8202){
+        if (version>=8202){
             newestFirmwareVersion = true;
             Serial3.println(F("modem has NB-IoT enabled"));
         }else{
@@ -272,6 +289,7 @@ bool SequansModem::changeOparatingMode(){
         default: {
             Serial3.print(F("The modem has somting else: "));
             Serial3.println(opMode);
+            invalidateLinkState();
             SequansController.writeCommand("AT+CFUN=1");
             return true;
             break;
@@ -281,70 +299,57 @@ bool SequansModem::changeOparatingMode(){
     return false;
 }
 
-String SequansModem::getModemInfo(){
-    String res="";
-    char resbuf[100];
-    SequansController.writeCommand(AT_GET_MODEM_INFO,resbuf,sizeof(resbuf));
-    res = resbuf;
-    res.replace("\r\nOK\r\n", "");
-    res.replace("\rOK\r", "");
-    res.replace("\r\n", " ");
-    res.replace("\r", " ");
-    res.trim();
+bool SequansModem::getModemInfo(char* info, size_t size){
+    char resbuf[100] = "";
+    ResponseResult result = SequansController.writeCommand(AT_GET_MODEM_INFO,resbuf,sizeof(resbuf));
+    ATResponseParser::getText(resbuf, info, size);
+    return result == ResponseResult::OK;
+}
 
-    return res;
+String SequansModem::getModemInfo(){
+    char info[100] = "";
+    getModemInfo(info, sizeof(info));
+    return String(info);
 }
 
 SimStatus SequansModem::getSimStatus(uint32_t timeout_ms){
-    String res="";
     char resbuf[100];
+    char res[16];
 
     for(uint32_t start = millis(); millis()-start<timeout_ms;){
+        resbuf[0] = '\0';
         SequansController.writeCommand("AT+CPIN?",resbuf,sizeof(resbuf));
-        res = resbuf;
-        res.replace("\r\n+CPIN: ", "");
-        res.replace("+CPIN: ","");
-        res.trim();
     
-        if (res.equals("READY"))
+        if (ATResponseParser::getValue(resbuf, "CPIN", 0, res, sizeof(res)))
         {
-            return SIM_READY;
-        }else if (res.equals("SIM PIN"))
-        {
-            return SIM_LOCKED;
-        }else if (res.equals("SIM PUK"))
-        {
-            return SIM_LOCKED;
-        }else if (res.equals("SIM PIN2"))
+            if (strcmp(res, "READY") == 0)
+            {
+                return SIM_READY;
+            }else if (strcmp(res, "SIM PIN") == 0 || strcmp(res, "SIM PUK") == 0 || strcmp(res, "SIM PIN2") == 0)
+            {
+                return SIM_LOCKED;
+            }
+        }else if (ATResponseParser::isError(resbuf))
         {
-            return SIM_LOCKED;
-        }else if(res.equals("ERROR")){
             return SIM_ERROR;
-        }  
+        }
     }
     return SIM_TIMEOUT;
 }
 
 bool SequansModem::simUnlock(const char* pin){
-    String atCommand = "AT+CPIN=\"";
-    atCommand = atCommand+pin+"\"";
-    const char* atCommandCPIN = atCommand.c_str();
-    String res="";
-    char resbuf[100];
-    SequansController.writeCommand(atCommandCPIN,resbuf,sizeof(resbuf));
-    Serial3.print(F("CPIN resbuf: "));
-    Serial3.println(resbuf);
-    res = resbuf;
-    res.replace("\r\nOK\r\n", "");
-    res.replace("\rOK\r", "");
-    res.replace("\r\n", " ");
-    res.replace("\r", " ");
-    res.trim();
-
-    if (res.equals("ERROR"))
+    char atCommandCPIN[32];
+    if (!ATResponseParser::formatCommand(atCommandCPIN, sizeof(atCommandCPIN), "AT+CPIN=\"%s\"", pin))
     {
+        Serial3.println(F("[ERROR]: SIM PIN too long"));
         return false;
-    }else return true;   
+    }
+    char resbuf[100] = "";
+    ResponseResult result = SequansController.writeCommand(atCommandCPIN,resbuf,sizeof(resbuf));
+    Serial3.print(F("CPIN resbuf: "));
+    Serial3.println(resbuf);
+
+    return result == ResponseResult::OK && !ATResponseParser::isError(resbuf);
 }
 
 bool SequansModem::gprsConnect(const char* apn, const char* user,
@@ -371,37 +376,50 @@ void SequansModem::GprsStatus(char * buffer){
     
 }
 
-String SequansModem::getLocalIP(){
-    char res[16] = "";
-    char resbuf[50] = "";
+bool SequansModem::getLocalIP(char* ip, size_t size){
+    char resbuf[80] = "";
+    ip[0] = '\0';
     if (SequansController.writeCommand("AT+CGPADDR=1", resbuf, sizeof(resbuf))!=ResponseResult::OK) { 
         Serial3.println(F("Command (CGPADDR) response NOT OK")); 
-        return ""; 
+        return false; 
     }
-    // Serial3.print(F("+CGPADDR resbuf: "));
-    // Serial3.println(resbuf);
-    if(!SequansController.extractValueFromCommandResponse(resbuf, 1, res, sizeof(res), 0)){
+    //Response has the form +CGPADDR: <cid>,"<ip4 Address>"[,"<ip6 Address>"]
+    if(!ATResponseParser::getValue(resbuf, "CGPADDR", 1, ip, size)){
         Serial3.println(F("[ERROR]: Failed to extract response from CGPADDR!"));
-        return "";
+        return false;
     }
-    //Serial3.print(F("+CGPADDR resC: "));
-    //Serial3.println(res);
-    String localIP = res;
-    localIP.trim();
-    return localIP;
+    return ip[0] != '\0';
+}
+
+String SequansModem::getLocalIP(){
+    char localIP[16] = "";
+    getLocalIP(localIP, sizeof(localIP));
+    return String(localIP);
 }
 
 bool SequansModem::isGprsConnected(){
-    char res[24] = "";
     char resbuf[48] = "";
-    String PACKET_SERVICE = "CGATT";
     uint16_t timeout_ms = 1000;
 
     while(SequansController.writeCommand("AT+CGATT?", resbuf, sizeof(resbuf)) != ResponseResult::OK && --timeout_ms != 0){
         Watchdog.reset();
         delay(50);
     }
-    SequansController.extractValueFromCommandResponse(resbuf,0,res,sizeof(res));
+    return checkGprsResponse(resbuf);
+}
+
+bool SequansModem::pollGprsConnected(){
+    char resbuf[48] = "";
+    if (SequansController.writeCommand("AT+CGATT?", resbuf, sizeof(resbuf)) != ResponseResult::OK)
+    {
+        return false;
+    }
+    return checkGprsResponse(resbuf);
+}
+
+bool SequansModem::checkGprsResponse(char * resbuf){
+    char res[24] = "";
+    ATResponseParser::getValue(resbuf, "CGATT", 0, res, sizeof(res));
     // res = resbuf;
     // res.replace("\r\n+"+PACKET_SERVICE+": \r\n","");
     // res.replace("\r\n+"+PACKET_SERVICE+": \n","");
@@ -414,14 +432,8 @@ bool SequansModem::isGprsConnected(){
     GprsStatus(res);
     /*Check not only if PDP is attached but also if it is connected to an IP-Address*/
     if (gprs_connected){
-        String localIP = getLocalIP();
-        if (localIP != "" && localIP != "0.0.0.0")
-        {
-            return true;
-        }else
-        {
-            return false;
-        } 
+        char localIP[16] = "";
+        return getLocalIP(localIP, sizeof(localIP)) && strcmp(localIP, "0.0.0.0") != 0;
     }
     
     return false;//gprs_connected;
@@ -502,6 +514,10 @@ bool SequansModem::isNetworkConnected(){
                 const char stat = res[0]; 
                 //Serial3.print(F("CEREG stat: "));
                 //Serial3.println(stat);
+                if (isdigit((unsigned char)stat))
+                {
+                    setRegistration(stat - '0');
+                }
 
                 if (stat == STAT_REGISTERED_HOME_NETWORK || stat == STAT_REGISTERED_ROAMING)
                 {
@@ -515,6 +531,33 @@ bool SequansModem::isNetworkConnected(){
     }
 }
 
+bool SequansModem::isNetworkRegistered(){
+    char resbuf[50] = "";
+    char res[16] = "";
+    if(SequansController.writeCommand("AT+CEREG?", resbuf, sizeof(resbuf))!=ResponseResult::OK){
+        return false;
+    }
+    //Response has the form +CEREG: <n>,<stat>[,...]
+    if(!ATResponseParser::getValue(resbuf, "CEREG", 1, res, sizeof(res))){
+        return false;
+    }
+    const char stat = res[0];
+    if (isdigit((unsigned char)stat))
+    {
+        setRegistration(stat - '0');
+    }
+    return stat == STAT_REGISTERED_HOME_NETWORK || stat == STAT_REGISTERED_ROAMING;
+}
+
+bool SequansModem::enableRadio(){
+    invalidateLinkState();
+    if(SequansController.writeCommand(AT_CONNECT)!=ResponseResult::OK){
+        Serial3.println(F("Command (CFUN) response NOT OK"));
+        return false;
+    }
+    return true;
+}
+
 int16_t SequansModem::getSignalQuality(){
     char resbuf[24] = "";
     char res[12] = "";
@@ -530,37 +573,301 @@ int16_t SequansModem::getSignalQuality(){
 
     //Convert char array in to int and terurn it
     
-    sscanf(res, "%d", &iRes);
+    if (sscanf(res, "%d", &iRes) == 1)
+    {
+        setSignalQuality(iRes);
+    }
 
     return iRes;
 }
 
-String SequansModem::getOperator(){
-    // char res[30];
-    // char resbuf[50];
-    // SequansController.writeCommand("AT+COPS?",resbuf, sizeof(resbuf));
-    // SequansController.extractValueFromCommandResponse(resbuf,2,res,sizeof(res));
-    //Use function from LteClass
-    String currentOperator = Lte.getOperator();
+bool SequansModem::enableLinkStateURC(){
+    SequansController.registerCallback(CEREG_CALLBACK, onCEREG);
+    SequansController.registerCallback("CSQ", onCSQ);
+    //n=2 sends +CEREG on every change of the registration status, incl. the location
+    return SequansController.writeCommand("AT+CEREG=2") == ResponseResult::OK;
+}
 
-    return currentOperator;
+void SequansModem::disableLinkStateURC(){
+    SequansController.unregisterCallback(CEREG_CALLBACK);
+    SequansController.unregisterCallback("CSQ");
+}
+
+/**
+ * @brief Skips the separator between the name of a result code and its values
+ * 
+ */
+static const char* skipURCSeparator(const char* urcData){
+    while (*urcData == ':' || *urcData == ' ')
+    {
+        urcData++;
+    }
+    return urcData;
+}
+
+void SequansModem::onCEREG(char * urcData){
+    const char* values = skipURCSeparator(urcData);
+    //The response of AT+CEREG? is <n>,<stat>[,...], the unsolicited result code <stat>[,"<tac>",...]
+    const char* second = strchr(values, ',');
+    uint8_t index = (second != nullptr && second[1] != '"') ? 1 : 0;
+    char stat[4] = "";
+    if (ATResponseParser::getValue(values, nullptr, index, stat, sizeof(stat)) && isdigit((unsigned char)stat[0]))
+    {
+        setRegistration(stat[0] - '0');
+    }
+}
+
+void SequansModem::onCSQ(char * urcData){
+    int32_t signalQuality = {0};
+    if (ATResponseParser::getInt(skipURCSeparator(urcData), nullptr, 0, signalQuality))
+    {
+        setSignalQuality(signalQuality);
+    }
+}
+
+void SequansModem::setRegistration(uint8_t stat){
+    //Save and restore the interrupt flag, as the callbacks may be called from the UART interrupt
+    uint8_t oldSREG = SREG;
+    cli();
+    linkState.registration = stat;
+    linkState.registrationUpdated = millis();
+    SREG = oldSREG;
+}
+
+void SequansModem::setSignalQuality(int16_t signalQuality){
+    uint8_t oldSREG = SREG;
+    cli();
+    linkState.signalQuality = signalQuality;
+    linkState.signalUpdated = millis();
+    SREG = oldSREG;
+}
+
+void SequansModem::invalidateLinkState(){
+    uint8_t oldSREG = SREG;
+    cli();
+    linkState.registration = REGISTRATION_UNKNOWN;
+    linkState.registrationUpdated = 0;
+    linkState.signalQuality = SIGNAL_QUALITY_UNKNOWN;
+    linkState.signalUpdated = 0;
+    SREG = oldSREG;
+}
+
+LinkState SequansModem::getLinkState(){
+    LinkState state;
+    uint8_t oldSREG = SREG;
+    cli();
+    state.signalQuality = linkState.signalQuality;
+    state.registration = linkState.registration;
+    state.signalUpdated = linkState.signalUpdated;
+    state.registrationUpdated = linkState.registrationUpdated;
+    SREG = oldSREG;
+    return state;
+}
+
+int16_t SequansModem::getCachedSignalQuality(uint32_t maxAge_ms){
+    LinkState state = getLinkState();
+    if (state.signalUpdated == 0 || millis() - state.signalUpdated > maxAge_ms)
+    {
+        return getSignalQuality();
+    }
+    return state.signalQuality;
+}
+
+bool SequansModem::isNetworkRegisteredCached(uint32_t maxAge_ms){
+    LinkState state = getLinkState();
+    if (state.registrationUpdated == 0 || millis() - state.registrationUpdated > maxAge_ms)
+    {
+        return isNetworkRegistered();
+    }
+    return state.registration == STAT_REGISTERED_HOME_NETWORK - '0' || state.registration == STAT_REGISTERED_ROAMING - '0';
+}
+
+/**
+ * @brief Units of the 3GPP timer codings, in the order of their length. The code is written to bits 8 to 6
+ * of the timer, the value (0 to 31) to bits 5 to 1
+ * 
+ */
+struct TimerUnit {
+    uint8_t code;
+    uint32_t seconds;
+};
+
+//GPRS Timer 3 (T3412 extended, periodic TAU), 3GPP TS 24.008 10.5.7.4a
+static const TimerUnit periodicTauUnits[] = {
+    {0b011, 2}, {0b100, 30}, {0b101, 60}, {0b000, 600}, {0b001, 3600}, {0b010, 36000}, {0b110, 1152000}
+};
+//GPRS Timer 2 (T3324, active time), 3GPP TS 24.008 10.5.7.4
+static const TimerUnit activeTimeUnits[] = {
+    {0b000, 2}, {0b001, 60}, {0b010, 360}
+};
+
+const uint8_t TIMER_MAX_VALUE = {31};
+const uint8_t TIMER_CODE_DEACTIVATED = {0b111};
+
+/**
+ * @brief Encodes a time into the 8 bit string of a 3GPP timer, with the smallest unit which reaches the time
+ * 
+ * @param bits[out] buffer for at least 9 chars
+ */
+static void encodeTimer(uint32_t seconds, const TimerUnit* units, uint8_t numUnits, char* bits){
+    uint8_t code = units[numUnits - 1].code;
+    uint8_t value = TIMER_MAX_VALUE;
+    for (uint8_t i = 0; i < numUnits; i++)
+    {
+        //Round up, so the timer is never shorter than requested
+        uint32_t steps = (seconds + units[i].seconds - 1) / units[i].seconds;
+        if (steps <= TIMER_MAX_VALUE)
+        {
+            code = units[i].code;
+            value = steps;
+            break;
+        }
+    }
+    uint8_t timer = (code << 5) | value;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        bits[i] = (timer & (0x80 >> i)) ? '1' : '0';
+    }
+    bits[8] = '\0';
+}
+
+/**
+ * @brief Decodes the 8 bit string of a 3GPP timer
+ * 
+ * @return true if the timer is valid and not deactivated
+ */
+static bool decodeTimer(const char* bits, const TimerUnit* units, uint8_t numUnits, uint32_t &seconds){
+    if (strlen(bits) != 8)
+    {
+        return false;
+    }
+    uint8_t timer = {0};
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        if (bits[i] != '0' && bits[i] != '1')
+        {
+            return false;
+        }
+        timer = (timer << 1) | (bits[i] - '0');
+    }
+    uint8_t code = timer >> 5;
+    if (code == TIMER_CODE_DEACTIVATED)
+    {
+        return false;
+    }
+    for (uint8_t i = 0; i < numUnits; i++)
+    {
+        if (units[i].code == code)
+        {
+            seconds = (timer & TIMER_MAX_VALUE) * units[i].seconds;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SequansModem::setPowerSaveMode(bool enable, uint32_t periodicTau_s, uint32_t activeTime_s){
+    if (!enable)
+    {
+        return SequansController.writeCommand("AT+CPSMS=0") == ResponseResult::OK;
+    }
+    char periodicTau[9];
+    char activeTime[9];
+    encodeTimer(periodicTau_s, periodicTauUnits, sizeof(periodicTauUnits) / sizeof(periodicTauUnits[0]), periodicTau);
+    encodeTimer(activeTime_s, activeTimeUnits, sizeof(activeTimeUnits) / sizeof(activeTimeUnits[0]), activeTime);
+    char command[40];
+    ATResponseParser::formatCommand(command, sizeof(command), "AT+CPSMS=1,,,\"%s\",\"%s\"", periodicTau, activeTime);
+    if(SequansController.writeCommand(command)!=ResponseResult::OK){
+        Serial3.println(F("Command (CPSMS) response NOT OK"));
+        return false;
+    }
+    return true;
+}
+
+bool SequansModem::getPowerSaveTimers(uint32_t &periodicTau_s, uint32_t &activeTime_s){
+    char resbuf[96] = "";
+    char timer[12] = "";
+    //n=4 adds the granted PSM timers to +CEREG, the stat is still the second value for the link state callback
+    if(SequansController.writeCommand("AT+CEREG=4")!=ResponseResult::OK){
+        return false;
+    }
+    if(SequansController.writeCommand("AT+CEREG?", resbuf, sizeof(resbuf))!=ResponseResult::OK){
+        return false;
+    }
+    //+CEREG: <n>,<stat>,<tac>,<ci>,<AcT>,<cause_type>,<reject_cause>,<Active-Time>,<Periodic-TAU>
+    if(!ATResponseParser::getValue(resbuf, "CEREG", 7, timer, sizeof(timer))
+        || !decodeTimer(timer, activeTimeUnits, sizeof(activeTimeUnits) / sizeof(activeTimeUnits[0]), activeTime_s)){
+        return false;
+    }
+    if(!ATResponseParser::getValue(resbuf, "CEREG", 8, timer, sizeof(timer))
+        || !decodeTimer(timer, periodicTauUnits, sizeof(periodicTauUnits) / sizeof(periodicTauUnits[0]), periodicTau_s)){
+        return false;
+    }
+    return true;
+}
+
+bool SequansModem::setEDRX(bool enable, uint8_t cycle, uint8_t actType){
+    if (!enable)
+    {
+        return SequansController.writeCommand("AT+CEDRXS=0") == ResponseResult::OK;
+    }
+    char command[32];
+    ATResponseParser::formatCommand(command, sizeof(command), "AT+CEDRXS=1,%u,\"%u%u%u%u\"", actType,
+        (cycle >> 3) & 1, (cycle >> 2) & 1, (cycle >> 1) & 1, cycle & 1);
+    if(SequansController.writeCommand(command)!=ResponseResult::OK){
+        Serial3.println(F("Command (CEDRXS) response NOT OK"));
+        return false;
+    }
+    return true;
+}
+
+bool SequansModem::isEDRXGranted(){
+    char resbuf[64] = "";
+    char value[8] = "";
+    int32_t actType = {0};
+    if(SequansController.writeCommand("AT+CEDRXRDP", resbuf, sizeof(resbuf))!=ResponseResult::OK){
+        return false;
+    }
+    //+CEDRXRDP: <AcT-type>[,<Requested_eDRX>[,<NW-provided_eDRX>[,<Paging_time_window>]]], AcT-type 0 if not used
+    if(!ATResponseParser::getInt(resbuf, "CEDRXRDP", 0, actType) || actType == 0){
+        return false;
+    }
+    return ATResponseParser::getValue(resbuf, "CEDRXRDP", 2, value, sizeof(value)) && value[0] != '\0';
+}
+
+bool SequansModem::getOperator(char* name, size_t size){
+    char resbuf[64] = "";
+    name[0] = '\0';
+    //Operator as long alphanumeric name
+    if(SequansController.writeCommand("AT+COPS=3,0")!=ResponseResult::OK){
+        return false;
+    }
+    if(SequansController.writeCommand("AT+COPS?", resbuf, sizeof(resbuf))!=ResponseResult::OK){
+        return false;
+    }
+    //Response has the form +COPS: <mode>[,<format>,"<operator>",<AcT>], without operator if not registered
+    return ATResponseParser::getValue(resbuf, "COPS", 2, name, size) && name[0] != '\0';
+}
+
+String SequansModem::getOperator(){
+    char currentOperator[32] = "";
+    getOperator(currentOperator, sizeof(currentOperator));
+    return String(currentOperator);
 }
 
 bool SequansModem::getNetworkTime(int* year, int* month, int* day, int* hour,
                                     int* minute, int* second, float* timezone){
-    uint16_t iyear = {0};
-    uint16_t imonth = {0};
-    uint16_t iday = {0};
-    uint16_t ihour = {0};
-    uint16_t iminute = {0};
-    uint16_t isecond = {0};
-    uint16_t itimeZone = {0};
-    char sgn;
-    uint32_t date[6] = {0U, 0U, 0U, 0U, 0U, 0U};           //date has the six values of year, month, day, hour, min, sec
+    int iyear = {0};
+    int imonth = {0};
+    int iday = {0};
+    int ihour = {0};
+    int iminute = {0};
+    int isecond = {0};
+    int itimeZone = {0};
+    char sgn = {0};
     
     char responseBuffer[48] = ""; //= {"+CCLK: \"19/04/26,17:14:55+32\" OK"};
-    char buffer[2] = "";
-    String bufferString = "";
+    char dateTime[24] = "";
 
     /*Clear buffer from other AT command responses*/
     SequansController.clearReceiveBuffer();
@@ -571,72 +878,16 @@ bool SequansModem::getNetworkTime(int* year, int* month, int* day, int* hour,
     if(!SequansController.waitForURC("CCLK", responseBuffer, sizeof(responseBuffer), 7000U, wdtReset, 1000U)){
         return false;
     }
-    /*responseBuffer is the received command from modem in form +CCLK: "yy/MM/dd,hh:mm:ss zz"*/
-    //Cut of received String till \"
-    // Do the replaces twice so we cover both \r and \r\n type endings
-    bufferString = responseBuffer;
-    // Serial3.print(F("bufferstring: "));
-    // Serial3.println(bufferString);
-
-    bufferString.replace(" \"","");
-    bufferString.replace("\"","");
-    
-    //Put cutted String back in to responseBuffer
-    bufferString.toCharArray(responseBuffer,sizeof(responseBuffer)/sizeof(responseBuffer[0]));
-
-    // Serial3.println(F("responseBuffer: "));
-    // Serial3.println(responseBuffer);
-
-    //counter i is the position for responseBuffer array
-    size_t i = {0};
-    /*Put the number from response in to the date array*/
-    for (size_t j = {0}; j < sizeof(date)/sizeof(date[0]) ; j++)
+    /*responseBuffer is the received command from modem in form +CCLK: "yy/MM/dd,hh:mm:ss+zz", zz in quarter hours*/
+    if (!ATResponseParser::getValue(responseBuffer, nullptr, 0, dateTime, sizeof(dateTime)))
     {
-        /*buffer is for the two numbers of the date sequence*/
-        for (size_t k = 0; k < sizeof(buffer)/sizeof(buffer[0]); k++)
-        {
-            buffer[k] = responseBuffer[i];
-            // Serial3.print(F("buffer[k]"));
-            // Serial3.println(buffer[k]);
-            i++;
-        }
-        /*Convert char array buffer to an integer value and put it in date array*/
-        sscanf(buffer,"%lu", &date[j]);
-        if (j<5)
-        {
-            //To skip the '/' ',' and ':' characters in responseBuffer
-            i++;
-        }
+        return false;
+    }
+    if (sscanf(dateTime, "%2d/%2d/%2d,%2d:%2d:%2d%c%2d", &iyear, &imonth, &iday, &ihour, &iminute, &isecond, &sgn, &itimeZone) != 8)
+    {
+        /*Something went wrong and the buffer did not have the format "yy/MM/dd,hh:mm:ss+zz"*/
+        return false;
     }
-    
-    //Set date and time from date array
-    iyear = date[0];
-    // Serial3.print(F("iyear:") );
-    // Serial3.println(iyear);
-    imonth = date[1];
-    // Serial3.print(F("imonth:") );
-    // Serial3.println(imonth);
-    iday = date[2];
-    // Serial3.print(F("iday:") );
-    // Serial3.println(iday);
-    ihour = date[3];
-    // Serial3.print(F("ihour:") );
-    // Serial3.println(ihour);
-    iminute = date[4];
-    // Serial3.print(F("iminute:") );
-    // Serial3.println(iminute);
-    isecond = date[5];
-    // Serial3.print(F("isecond:") );
-    // Serial3.println(isecond);
-    //Set sgn of zz a.k.a. timezone
-    sgn = responseBuffer[i];
-    // Serial3.print(F("sgn:") );
-    // Serial3.println(sgn);
-    //Set timezone
-    buffer[0] = responseBuffer[i+1];
-    buffer[1] = responseBuffer[i+2];
-    /*Convert char array buffer to an integer value and put it in itimeZone*/
-    sscanf(buffer,"%u",&itimeZone);
     //To get a hole hour
     itimeZone = itimeZone/4;
 
@@ -653,7 +904,6 @@ bool SequansModem::getNetworkTime(int* year, int* month, int* day, int* hour,
     *hour = ihour;
     *minute = iminute;
     *second = isecond;
-    //*timezone = itimeZone*(-1.0);
     if (sgn == '+')
     {
         *timezone = (float)itimeZone;
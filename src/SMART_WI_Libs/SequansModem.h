@@ -7,6 +7,7 @@ Created by Csaba Freiberger 02.2023*/
 #if defined (DXCORE)
 #include "sequans_controller.h"
 #include "lte.h"
+#include "ATResponseParser.h"
 
 /**
  * @brief enumaration for setting the Sim status
@@ -19,10 +20,61 @@ enum SimStatus {
   SIM_TIMEOUT          = 3,
 };
 
+const uint32_t LINK_STATE_MAX_AGE_MS = {60000};    //Default max age of the cached link state, before it is refreshed with an AT command
+const int16_t SIGNAL_QUALITY_UNKNOWN = {99};       //CSQ value if the signal is not known or not detectable
+const uint8_t REGISTRATION_UNKNOWN = {0xFF};
+
+const uint8_t EDRX_ACT_LTE_M = {4};                //AcT type of AT+CEDRXS for LTE-M (E-UTRAN WB-S1)
+const uint8_t EDRX_ACT_NB_IOT = {5};               //AcT type of AT+CEDRXS for NB-IoT (E-UTRAN NB-S1)
+//eDRX cycle codes of 3GPP TS 24.008 for LTE-M, e.g. EDRX_CYCLE_81_92_S is a paging cycle of 81.92s
+const uint8_t EDRX_CYCLE_20_48_S = {0x2};
+const uint8_t EDRX_CYCLE_40_96_S = {0x3};
+const uint8_t EDRX_CYCLE_81_92_S = {0x5};
+const uint8_t EDRX_CYCLE_163_84_S = {0x9};
+const uint8_t EDRX_CYCLE_327_68_S = {0xA};
+const uint8_t EDRX_CYCLE_655_36_S = {0xB};
+const uint8_t EDRX_CYCLE_1310_72_S = {0xC};
+const uint8_t EDRX_CYCLE_2621_44_S = {0xD};
+
+/**
+ * @brief Cached link state of the modem, updated by the +CEREG and +CSQ result codes
+ * 
+ */
+struct LinkState {
+  int16_t signalQuality = {SIGNAL_QUALITY_UNKNOWN};  //rssi of +CSQ
+  uint8_t registration = {REGISTRATION_UNKNOWN};     //stat of +CEREG, 1 home network, 5 roaming
+  unsigned long signalUpdated = {0};                 //millis() of the last update, 0 if never updated
+  unsigned long registrationUpdated = {0};
+};
+
 class SequansModem
 {
 private:
      volatile bool gprs_connected = false;
+
+    /**
+     * @brief Evaluates the response of AT+CGATT? and checks if the PDP context has an IP address
+     * 
+     * @param resbuf response of the modem
+     * @return true if gprs is connected
+     */
+    bool checkGprsResponse(char * resbuf);
+
+    /**
+     * @brief Updates the cached link state, called with the data of the result codes
+     * 
+     */
+    static void onCEREG(char * urcData);
+    static void onCSQ(char * urcData);
+    static void setRegistration(uint8_t stat);
+    static void setSignalQuality(int16_t signalQuality);
+
+    /**
+     * @brief Marks the cached link state as never updated, so the next cached query asks the modem.
+     * Called before the radio is switched on and when the modem is ended, as the old state is not valid anymore
+     * 
+     */
+    static void invalidateLinkState();
 public:
     /**
      * @brief Constructor for Sequans modem
@@ -80,6 +132,15 @@ public:
     /**
      * @brief Get the Modem Info object
      * 
+     * @param info[out] buffer for the modem manufacturer, model and UE version
+     * @param size size of the buffer
+     * @return true if the modem responded
+     */
+    bool getModemInfo(char* info, size_t size);
+
+    /**
+     * @brief Get the Modem Info object. Allocates a String, prefer getModemInfo(char*, size_t)
+     * 
      * @return String of the modem manufacturer, model and UE version
      */
     String getModemInfo();
@@ -122,6 +183,15 @@ public:
      */
     bool isGprsConnected();
 
+    /**
+     * @brief Checks once with AT+CGATT? if the gprs is connected. In contrast to isGprsConnected()
+     * the command is not repeated, so the call does not block the main loop
+     * 
+     * @return true if gprs is connected,
+     * @return false if not or if the modem did not respond
+     */
+    bool pollGprsConnected();
+
     /**
      * @brief Checks the status of the gprs after the ifGprsConnected() member fuction
      * 
@@ -132,6 +202,15 @@ public:
     /**
      * @brief Get the Local IP Address from PDP
      * 
+     * @param ip[out] buffer for the ip4 Address, at least 16 bytes
+     * @param size size of the buffer
+     * @return true if the modem has an IP Address
+     */
+    bool getLocalIP(char* ip, size_t size);
+
+    /**
+     * @brief Get the Local IP Address from PDP. Allocates a String, prefer getLocalIP(char*, size_t)
+     * 
      * @return ip4 Address 
      */
     String getLocalIP();
@@ -158,6 +237,22 @@ public:
      */
     bool isNetworkConnected();
 
+    /**
+     * @brief Checks the network registration once with AT+CEREG?. In contrast to isNetworkConnected()
+     * it does not wait for the CEREG URC, so the call does not block the main loop
+     * 
+     * @return true if registered to the home network or roaming,
+     * @return false if not
+     */
+    bool isNetworkRegistered();
+
+    /**
+     * @brief Sets the modem to full functionality with AT+CFUN=1, without waiting for the network registration
+     * 
+     * @return true if the modem accepted the command
+     */
+    bool enableRadio();
+
     /**
      * @brief Get the Signal Quality of the modem
      * 
@@ -166,7 +261,94 @@ public:
     int16_t getSignalQuality();
 
     /**
-     * @brief Get the network operator for the modem
+     * @brief Enables the +CEREG result codes and registers callbacks, which update the cached link state
+     * whenever the modem sends +CEREG or +CSQ, also as response of AT+CSQ
+     * 
+     * @return true if the modem accepted AT+CEREG=2
+     */
+    bool enableLinkStateURC();
+
+    /**
+     * @brief Unregisters the callbacks of enableLinkStateURC()
+     * 
+     */
+    void disableLinkStateURC();
+
+    /**
+     * @brief Get the cached link state without any AT command
+     * 
+     * @return copy of the link state
+     */
+    LinkState getLinkState();
+
+    /**
+     * @brief Get the cached signal quality. Only if it is older than maxAge_ms, it is refreshed with AT+CSQ
+     * 
+     * @param maxAge_ms max age of the cached value
+     * @return int16_t value of signal strength indication, SIGNAL_QUALITY_UNKNOWN if not known or not detectable
+     */
+    int16_t getCachedSignalQuality(uint32_t maxAge_ms = LINK_STATE_MAX_AGE_MS);
+
+    /**
+     * @brief Get the cached network registration. Only if it is older than maxAge_ms, it is refreshed
+     * with isNetworkRegistered()
+     * 
+     * @param maxAge_ms max age of the cached value
+     * @return true if registered to the home network or roaming
+     */
+    bool isNetworkRegisteredCached(uint32_t maxAge_ms = LINK_STATE_MAX_AGE_MS);
+
+    /**
+     * @brief Requests the power saving mode (PSM) with AT+CPSMS. The modem stays reachable for the active time
+     * after the last transfer and then sleeps till the next periodic tracking area update or till data is sent.
+     * The timers are rounded up to the next value the 3GPP timer coding can express.
+     * 
+     * @param enable false disables PSM, the timers are ignored then
+     * @param periodicTau_s requested periodic tracking area update (T3412 extended) in s, max 9920h
+     * @param activeTime_s requested active time (T3324) in s, max 186min
+     * @return true if the modem accepted the command
+     */
+    bool setPowerSaveMode(bool enable, uint32_t periodicTau_s = 0, uint32_t activeTime_s = 0);
+
+    /**
+     * @brief Reads the PSM timers granted by the network with AT+CEREG=4 and AT+CEREG?.
+     * The +CEREG result codes stay enabled afterwards, also with the timers.
+     * 
+     * @param periodicTau_s[out] granted periodic tracking area update in s
+     * @param activeTime_s[out] granted active time in s
+     * @return true if the network granted PSM
+     */
+    bool getPowerSaveTimers(uint32_t &periodicTau_s, uint32_t &activeTime_s);
+
+    /**
+     * @brief Requests extended discontinuous reception (eDRX) with AT+CEDRXS. The modem listens for paging only
+     * once per cycle, but stays registered and reachable.
+     * 
+     * @param enable false disables eDRX
+     * @param cycle one of the EDRX_CYCLE_ codes
+     * @param actType EDRX_ACT_LTE_M or EDRX_ACT_NB_IOT, has to match the operating mode of the modem
+     * @return true if the modem accepted the command
+     */
+    bool setEDRX(bool enable, uint8_t cycle = EDRX_CYCLE_81_92_S, uint8_t actType = EDRX_ACT_LTE_M);
+
+    /**
+     * @brief Checks with AT+CEDRXRDP if the network granted eDRX
+     * 
+     * @return true if eDRX is used on the current cell
+     */
+    bool isEDRXGranted();
+
+    /**
+     * @brief Get the network operator for the modem with AT+COPS?
+     * 
+     * @param name[out] buffer for the name of the operator
+     * @param size size of the buffer
+     * @return true if the modem is registered to an operator
+     */
+    bool getOperator(char* name, size_t size);
+
+    /**
+     * @brief Get the network operator for the modem. Allocates a String, prefer getOperator(char*, size_t)
      * 
      * @return String of current network operator
      */
@@ -0,0 +1,219 @@
+/**
+ * @file TaskScheduler.cpp
+ * @brief TaskSchedulerClass member function definitions
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#if defined (DXCORE)
+
+#include "TaskScheduler.h"
+
+const uint16_t TASK_RECORD_MAGIC = {0x5AC3};
+
+/**
+ * @brief Task which was running or overran, kept over a watchdog reset
+ *
+ */
+struct TaskResetRecord
+{
+    uint16_t magic;
+    uint8_t task;
+    uint8_t taskInverted;       //Complement of task, so random RAM content after power on is not taken as record
+    char name[TASK_NAME_SIZE];
+};
+
+//Not initialized at startup, so it still contains the record of the run before the reset
+static TaskResetRecord resetRecord __attribute__((section(".noinit")));
+
+TaskSchedulerClass &TaskScheduler = TaskSchedulerClass::instance();
+
+uint8_t TaskSchedulerClass::addTask(const char *_name, TaskFunction _function, uint32_t _interval_ms, uint32_t _deadline_ms){
+    if (numTasks >= TASK_MAX_TASKS)
+    {
+        Serial3.println(F("[ERROR]: Too many tasks, task not added"));
+        return TASK_NONE;
+    }
+    ScheduledTask &task = tasks[numTasks];
+    task.name = _name;
+    task.function = _function;
+    task.interval_ms = _interval_ms;
+    task.deadline_ms = _deadline_ms;
+    unsigned long now = millis();
+    //Due with the next call of run()
+    task.lastStart = now - _interval_ms;
+    task.lastCheckIn = now;
+    return numTasks++;
+}
+
+void TaskSchedulerClass::begin(int _watchdogTimeout_ms){
+    resetTaskName[0] = '\0';
+    //The record also survives a software or external reset, so it is only reported after a watchdog reset
+    bool is_watchdogReset = RSTCTRL.RSTFR & RSTCTRL_WDRF_bm;
+    //Cleared by writing 1, else the flag would still be set after the next reset of another type
+    RSTCTRL.RSTFR = RSTCTRL_WDRF_bm;
+    if (is_watchdogReset && resetRecord.magic == TASK_RECORD_MAGIC && resetRecord.task != TASK_NONE
+        && resetRecord.taskInverted == (uint8_t)~resetRecord.task)
+    {
+        memcpy(resetTaskName, resetRecord.name, TASK_NAME_SIZE);
+        resetTaskName[TASK_NAME_SIZE - 1] = '\0';
+        Serial3.print(F("[WARNING]: Last reset while this task was running or overran: "));
+        Serial3.println(resetTaskName);
+    }
+    recordTask(TASK_NONE);
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < numTasks; i++)
+    {
+        tasks[i].lastCheckIn = now;
+    }
+    lastTaskEnd = now;
+    Watchdog.setKickCondition(superviseTasks);
+    Watchdog.enable(_watchdogTimeout_ms);
+}
+
+void TaskSchedulerClass::end(){
+    Watchdog.setKickCondition(nullptr);
+}
+
+bool TaskSchedulerClass::isOnTime(uint8_t _id, unsigned long _now){
+    const ScheduledTask &task = tasks[_id];
+    if (_id == currentTask)
+    {
+        return _now - task.lastCheckIn <= task.deadline_ms;
+    }
+    //Tasks which had to wait for another task are measured from its end, its deadline covers the wait
+    unsigned long lastCheckIn = task.lastCheckIn;
+    if (_now - lastTaskEnd < _now - lastCheckIn)
+    {
+        lastCheckIn = lastTaskEnd;
+    }
+    return _now - lastCheckIn <= task.interval_ms + task.deadline_ms;
+}
+
+void TaskSchedulerClass::setOverrunTask(uint8_t _id){
+    if (overrunTask == _id)
+    {
+        return;
+    }
+    overrunTask = _id;
+    tasks[_id].overruns++;
+    recordTask(_id);
+    Serial3.print(F("[WARNING]: Task overran its deadline: "));
+    Serial3.println(tasks[_id].name);
+}
+
+void TaskSchedulerClass::recordTask(uint8_t _id){
+    resetRecord.magic = TASK_RECORD_MAGIC;
+    resetRecord.task = _id;
+    resetRecord.taskInverted = ~_id;
+    if (_id != TASK_NONE)
+    {
+        strncpy(resetRecord.name, tasks[_id].name, TASK_NAME_SIZE - 1);
+        resetRecord.name[TASK_NAME_SIZE - 1] = '\0';
+    }
+}
+
+bool TaskSchedulerClass::superviseTasks(void){
+    TaskSchedulerClass &scheduler = TaskSchedulerClass::instance();
+    unsigned long now = millis();
+    if (scheduler.currentTask != TASK_NONE)
+    {
+        //The other tasks cannot run meanwhile, the deadline of the running task limits how long it blocks them
+        if (!scheduler.isOnTime(scheduler.currentTask, now))
+        {
+            scheduler.setOverrunTask(scheduler.currentTask);
+            return false;
+        }
+    }else{
+        for (uint8_t i = 0; i < scheduler.numTasks; i++)
+        {
+            if (!scheduler.isOnTime(i, now))
+            {
+                scheduler.setOverrunTask(i);
+                return false;
+            }
+        }
+    }
+    if (scheduler.overrunTask != TASK_NONE)
+    {
+        scheduler.overrunTask = TASK_NONE;
+        scheduler.recordTask(scheduler.currentTask);
+    }
+    return true;
+}
+
+void TaskSchedulerClass::run(){
+    for (uint8_t i = 0; i < numTasks; i++)
+    {
+        ScheduledTask &task = tasks[i];
+        unsigned long now = millis();
+        if (now - task.lastStart < task.interval_ms)
+        {
+            continue;
+        }
+        task.lastStart = now;
+        task.lastCheckIn = now;
+        currentTask = i;
+        recordTask(i);
+
+        task.function();
+
+        now = millis();
+        if (now - task.lastStart > task.maxRuntime_ms)
+        {
+            task.maxRuntime_ms = now - task.lastStart;
+        }
+        //Also catches overruns of tasks, which never called Watchdog.reset() or checkIn()
+        if (now - task.lastCheckIn > task.deadline_ms)
+        {
+            setOverrunTask(i);
+        }
+        task.lastCheckIn = now;
+        lastTaskEnd = now;
+        currentTask = TASK_NONE;
+        recordTask(overrunTask);
+        Watchdog.reset();
+    }
+    Watchdog.reset();
+}
+
+void TaskSchedulerClass::checkIn(){
+    if (currentTask != TASK_NONE)
+    {
+        tasks[currentTask].lastCheckIn = millis();
+    }
+    Watchdog.reset();
+}
+
+uint8_t TaskSchedulerClass::getOverrunTask(){
+    return overrunTask;
+}
+
+const char *TaskSchedulerClass::getResetTaskName(){
+    return resetTaskName;
+}
+
+const ScheduledTask *TaskSchedulerClass::getTask(uint8_t _id){
+    if (_id >= numTasks)
+    {
+        return nullptr;
+    }
+    return &tasks[_id];
+}
+
+void TaskSchedulerClass::printStatistics(){
+    for (uint8_t i = 0; i < numTasks; i++)
+    {
+        Serial3.print(F("Task "));
+        Serial3.print(tasks[i].name);
+        Serial3.print(F(": max runtime ms: "));
+        Serial3.print(tasks[i].maxRuntime_ms);
+        Serial3.print(F(", overruns: "));
+        Serial3.println(tasks[i].overruns);
+    }
+}
+
+#endif
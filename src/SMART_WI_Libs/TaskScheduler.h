@@ -0,0 +1,169 @@
+/**
+ * @file TaskScheduler.h
+ * @brief Cooperative scheduler for periodic tasks, which kicks the watchdog only while every task meets its deadline
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Every task is a function, which is called every interval_ms by run() and has to return or call checkIn()
+ * within deadline_ms. While a task is running, Watchdog.reset() only kicks the watchdog if the running task
+ * checked in within its deadline, so the resets in blocking code (e.g. MQTTClient::connect) do not keep a hanging
+ * task alive. Between the tasks the watchdog is only kicked if every task ran within its interval and deadline.
+ * The task which overran is kept in RAM, which is not initialized at startup, so it is reported after the
+ * watchdog reset by begin().
+ *
+ * Example:
+ *      TaskScheduler.addTask("rs485", pollRS485, 1000, 2000);
+ *      TaskScheduler.addTask("modem", processModem, 100, 5000);
+ *      TaskScheduler.begin(WATCHDOG_TIMEOUT);
+ *      loop(){
+ *          TaskScheduler.run();
+ *      }
+ *
+ */
+#if defined (DXCORE)
+#ifndef TaskScheduler_h
+#define TaskScheduler_h
+
+    #include <Arduino.h>
+    #include "watchdogAVR.h"
+
+    const uint8_t TASK_MAX_TASKS = {8};
+    const uint8_t TASK_NAME_SIZE = {12};        //Size of a task name in the reset record incl. '\0'
+    const uint8_t TASK_NONE = {0xFF};           //Task id if no task is running or overran
+
+    typedef void (*TaskFunction)(void);
+
+    /**
+     * @brief Periodic task and its runtime statistics
+     *
+     */
+    struct ScheduledTask
+    {
+        const char *name = {nullptr};
+        TaskFunction function = {nullptr};
+        uint32_t interval_ms = {0};             //Time between the starts of two runs
+        uint32_t deadline_ms = {0};             //Max time between two check-ins while running
+        unsigned long lastStart = {0};
+        unsigned long lastCheckIn = {0};        //End of the last run or last call of checkIn()
+        uint32_t maxRuntime_ms = {0};
+        uint16_t overruns = {0};                //Number of runs, which exceeded the deadline
+    };
+
+    class TaskSchedulerClass
+    {
+    private:
+        ScheduledTask tasks[TASK_MAX_TASKS];
+        uint8_t numTasks = {0};
+        uint8_t currentTask = {TASK_NONE};
+        uint8_t overrunTask = {TASK_NONE};      //Task which prevents the watchdog from being kicked
+        unsigned long lastTaskEnd = {0};        //millis() when the last task returned
+        char resetTaskName[TASK_NAME_SIZE] = {0};
+
+        /**
+         * @brief Hide constructor in order to enforce a single instance of the class.
+         *
+         */
+        TaskSchedulerClass(){};
+
+        /**
+         * @return true if the task checked in within its deadline, or within interval and deadline if it is not running.
+         * Waiting for another task does not count for tasks which are not running
+         */
+        bool isOnTime(uint8_t _id, unsigned long _now);
+
+        /**
+         * @brief Saves the task which prevents the watchdog from being kicked and prints it once
+         *
+         */
+        void setOverrunTask(uint8_t _id);
+
+        /**
+         * @brief Saves the task in the reset record, which survives a watchdog reset
+         *
+         */
+        void recordTask(uint8_t _id);
+
+        /**
+         * @brief Kick condition of the watchdog
+         *
+         * @return true if every task is on time
+         */
+        static bool superviseTasks(void);
+
+    public:
+        /**
+         * @brief  Singleton instance.
+         *
+         * @return TaskSchedulerClass&
+         */
+        static TaskSchedulerClass& instance(void){
+            static TaskSchedulerClass instance;
+            return instance;
+        }
+
+        /**
+         * @brief Add a periodic task. The first run is done with the next call of run()
+         *
+         * @param _name name of the task for the reports, the string has to be kept
+         * @param _function function of the task
+         * @param _interval_ms time between the starts of two runs
+         * @param _deadline_ms max runtime of one run or max time between two calls of checkIn()
+         * @return uint8_t id of the task, TASK_NONE if TASK_MAX_TASKS tasks have been added already
+         */
+        uint8_t addTask(const char *_name, TaskFunction _function, uint32_t _interval_ms, uint32_t _deadline_ms);
+
+        /**
+         * @brief Report the task of a previous watchdog reset, enable the watchdog and start the supervision.
+         * Clears the watchdog reset flag in RSTCTRL.RSTFR
+         *
+         * @param _watchdogTimeout_ms timeout of the watchdog in ms, max 8.2s
+         */
+        void begin(int _watchdogTimeout_ms);
+
+        /**
+         * @brief Stop the supervision, Watchdog.reset() kicks the watchdog unconditionally again
+         *
+         */
+        void end();
+
+        /**
+         * @brief Run every task which is due and kick the watchdog if every task is on time.
+         * Has to be called cyclically in the main loop
+         *
+         */
+        void run();
+
+        /**
+         * @brief Check in from within a long running task, its deadline starts again
+         *
+         */
+        void checkIn();
+
+        /**
+         * @return Id of the task which overran its deadline, TASK_NONE if every task is on time
+         */
+        uint8_t getOverrunTask();
+
+        /**
+         * @return Name of the task which was running or overran at the last watchdog reset, empty if there was none
+         */
+        const char *getResetTaskName();
+
+        /**
+         * @return Task with its statistics, nullptr if the id does not exist
+         */
+        const ScheduledTask *getTask(uint8_t _id);
+
+        /**
+         * @brief Print the max runtime and the number of overruns of every task to Serial3
+         *
+         */
+        void printStatistics();
+    };
+
+    extern TaskSchedulerClass &TaskScheduler;
+
+#endif
+#endif
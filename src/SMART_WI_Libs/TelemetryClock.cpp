@@ -0,0 +1,98 @@
+/**
+ * @file TelemetryClock.cpp
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "TelemetryClock.h"
+
+TelemetryClockClass &TelemetryClock = TelemetryClockClass::instance();
+
+uint32_t TelemetryClockClass::toEpoch(int year, int month, int day, int hour, int minute, int second){
+  //Days from civil algorithm, the year begins in March so the leap day is the last day of the year
+  int32_t y = year - (month <= 2 ? 1 : 0);
+  int32_t era = y / 400;
+  int32_t yearOfEra = y - era * 400;
+  int32_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  int32_t days = era * 146097 + dayOfEra - 719468;
+  return (uint32_t)days * 86400UL + (uint32_t)hour * 3600UL + (uint32_t)minute * 60UL + (uint32_t)second;
+}
+
+uint32_t TelemetryClockClass::correctedElapsedMs(uint32_t _now_ms){
+  uint32_t elapsed_ms = _now_ms - syncMillis;
+  return elapsed_ms + (int32_t)(((int64_t)elapsed_ms * driftPpm) / 1000000L);
+}
+
+bool TelemetryClockClass::setNetworkTime(int year, int month, int day, int hour, int minute, int second, float timezone){
+  //The modem returns 1980 or 2000 if it has not received the time from the network yet
+  if (year < 2020 || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+  {
+    Serial3.println(F("[WARNING]: Implausible network time. Clock is not synchronized"));
+    return false;
+  }
+  //The modem returns the local time, so subtract the time zone to get UTC
+  int32_t offset_s = (int32_t)(timezone * 3600.0F);
+  setEpoch(toEpoch(year, month, day, hour, minute, second) - offset_s);
+  return true;
+}
+
+void TelemetryClockClass::setEpoch(uint32_t _epoch){
+  uint32_t now_ms = millis();
+  if (is_synchronized && _epoch > syncEpoch)
+  {
+    //Measure the drift of millis() against the network time, only over a long enough time span
+    uint32_t net_elapsed_s = _epoch - syncEpoch;
+    uint32_t elapsed_ms = now_ms - syncMillis;
+    if (net_elapsed_s >= MIN_DRIFT_MEASURE_TIME_S && elapsed_ms > 0)
+    {
+      int64_t deviation_ms = (int64_t)net_elapsed_s * 1000LL - elapsed_ms;
+      int32_t measuredPpm = (int32_t)((deviation_ms * 1000000LL) / elapsed_ms);
+      if (measuredPpm > -MAX_CLOCK_DRIFT_PPM && measuredPpm < MAX_CLOCK_DRIFT_PPM)
+      {
+        driftPpm = measuredPpm;
+      }
+    }
+  }
+  syncEpoch = _epoch;
+  syncMillis = now_ms;
+  is_synchronized = true;
+}
+
+bool TelemetryClockClass::isSynchronized(){
+  return is_synchronized;
+}
+
+uint32_t TelemetryClockClass::now(){
+  if (!is_synchronized)
+  {
+    return 0;
+  }
+  return syncEpoch + correctedElapsedMs(millis()) / 1000;
+}
+
+uint32_t TelemetryClockClass::uptime(){
+  uint32_t now_ms = millis();
+  if (now_ms < lastUptimeMillis)
+  {
+    millisOverflows++;
+  }
+  lastUptimeMillis = now_ms;
+  return (((uint64_t)millisOverflows << 32) + now_ms) / 1000;
+}
+
+uint32_t TelemetryClockClass::uptimeToEpoch(uint32_t _uptime_s){
+  if (!is_synchronized)
+  {
+    return 0;
+  }
+  return now() - (uptime() - _uptime_s);
+}
+
+int32_t TelemetryClockClass::getDriftPpm(){
+  return driftPpm;
+}
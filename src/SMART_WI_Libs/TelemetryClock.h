@@ -0,0 +1,129 @@
+/**
+ * @file TelemetryClock.h
+ * @brief Wall clock for timestamping telemetry data. It is synchronized with the network time of the modem
+ * (e.g. SequansModem::getNetworkTime) and runs on millis() in between, corrected by the measured drift.
+ * Till the first synchronization, data can be timestamped with the uptime, which is converted to Unix time later.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Example:
+ *      int year, month, day, hour, minute, second;
+ *      float timezone;
+ *      if (modem.getNetworkTime(&year, &month, &day, &hour, &minute, &second, &timezone)){
+ *          TelemetryClock.setNetworkTime(year, month, day, hour, minute, second, timezone);
+ *      }
+ *      uint32_t timestamp = TelemetryClock.now();
+ *
+ */
+
+#ifndef TelemetryClock_h
+#define TelemetryClock_h
+
+    #include <Arduino.h>
+
+    const int32_t MAX_CLOCK_DRIFT_PPM = {50000};        //Drift values above are treated as a wrong synchronization
+    const uint32_t MIN_DRIFT_MEASURE_TIME_S = {600};     //Min time between two synchronizations to measure the drift
+
+    class TelemetryClockClass
+    {
+    private:
+        uint32_t syncEpoch = {0};       //Unix time in s (UTC) of the last synchronization
+        uint32_t syncMillis = {0};      //millis() of the last synchronization
+        int32_t driftPpm = {0};         //Measured deviation of millis() to the network time in ppm
+        bool is_synchronized = false;
+        uint32_t lastUptimeMillis = {0};    //millis() of the last call of uptime(), to detect its overflow
+        uint16_t millisOverflows = {0};     //Number of overflows of millis() since boot
+
+        /**
+         * @brief Hide constructor in order to enforce a single instance of the class.
+         *
+         */
+        TelemetryClockClass(){};
+
+        /**
+         * @brief Get the elapsed time since the last synchronization in ms, corrected by the drift
+         *
+         * @param _now_ms current millis()
+         * @return uint32_t
+         */
+        uint32_t correctedElapsedMs(uint32_t _now_ms);
+
+    public:
+        /**
+         * @brief  Singleton instance.
+         *
+         * @return TelemetryClockClass&
+         */
+        static TelemetryClockClass& instance(void){
+            static TelemetryClockClass instance;
+            return instance;
+        }
+
+        /**
+         * @brief Synchronize the clock with the network time as it is returned by SequansModem::getNetworkTime
+         *
+         * @param year four digit year
+         * @param month 1..12
+         * @param day 1..31
+         * @param hour local hour
+         * @param minute
+         * @param second
+         * @param timezone offset of the local time to UTC in hours
+         * @return true if the time is plausible and has been taken over,
+         * @return false if not
+         */
+        bool setNetworkTime(int year, int month, int day, int hour, int minute, int second, float timezone);
+
+        /**
+         * @brief Synchronize the clock with a Unix time
+         *
+         * @param _epoch Unix time in s (UTC)
+         */
+        void setEpoch(uint32_t _epoch);
+
+        /**
+         * @return True if the clock has been synchronized at least once
+         */
+        bool isSynchronized();
+
+        /**
+         * @brief Get the current time
+         *
+         * @return uint32_t Unix time in s (UTC), 0 if the clock has never been synchronized
+         */
+        uint32_t now();
+
+        /**
+         * @brief Get the time since boot, the fallback timestamp as long as the clock is not synchronized.
+         * Has to be called at least once in 49 days to count the overflows of millis()
+         *
+         * @return uint32_t uptime in s
+         */
+        uint32_t uptime();
+
+        /**
+         * @brief Convert an uptime of this boot to Unix time
+         *
+         * @param _uptime_s uptime in s, as returned by uptime()
+         * @return uint32_t Unix time in s (UTC), 0 if the clock has never been synchronized
+         */
+        uint32_t uptimeToEpoch(uint32_t _uptime_s);
+
+        /**
+         * @return Measured deviation of millis() to the network time in ppm
+         */
+        int32_t getDriftPpm();
+
+        /**
+         * @brief Convert a date to Unix time
+         *
+         * @return uint32_t Unix time in s
+         */
+        static uint32_t toEpoch(int year, int month, int day, int hour, int minute, int second);
+    };
+
+    extern TelemetryClockClass &TelemetryClock;
+
+#endif
@@ -0,0 +1,219 @@
+/**
+ * @file TelemetryRecord.cpp
+ * @brief
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "TelemetryRecord.h"
+#include "TempTelemetry.h"
+#include "CRC8.h"
+
+/**
+ * @brief Powers of ten for the fixed point conversion
+ */
+static const float DECIMAL_FACTOR[TELEM_MAX_DECIMALS + 1] = {1.0F, 10.0F, 100.0F, 1000.0F, 10000.0F};
+
+float &TelemetryRecordCodec::channel(TelemetryData &telemetry, uint8_t index){
+  switch (index)
+  {
+  case 0:   return telemetry.temp1;
+  case 1:   return telemetry.temp2;
+  case 2:   return telemetry.deflection;
+  case 3:   return telemetry.deflection2;
+  case 4:   return telemetry.pressure;
+  default:  return telemetry.picTemp;
+  }
+}
+
+float TelemetryRecordCodec::channel(const TelemetryData &telemetry, uint8_t index){
+  return channel(const_cast<TelemetryData &>(telemetry), index);
+}
+
+int16_t TelemetryRecordCodec::toFixedPoint(float value, uint8_t decimals){
+  float scaled = value * DECIMAL_FACTOR[decimals];
+  //NaN and values out of range are marked as invalid instead of saturating them
+  if (isnan(scaled) || scaled >= 32767.5F || scaled <= -32767.5F)
+  {
+    return TELEM_FIXED_POINT_INVALID;
+  }
+  return (int16_t)(scaled < 0.0F ? scaled - 0.5F : scaled + 0.5F);
+}
+
+float TelemetryRecordCodec::fromFixedPoint(int16_t value, uint8_t decimals){
+  if (value == TELEM_FIXED_POINT_INVALID)
+  {
+    return NAN;
+  }
+  return value / DECIMAL_FACTOR[decimals];
+}
+
+void TelemetryRecordCodec::initHeader(TelemetryPageHeader &header, const char *deviceID, uint32_t baseTimestamp, bool is_timeSynchronized, uint32_t baseSequence,
+                                      uint8_t channelMask, uint8_t fixedMask, const uint8_t (&decimals)[TELEM_NUM_CHANNELS]){
+  header.magic = TELEM_PAGE_MAGIC;
+  header.version = TELEM_RECORD_VERSION;
+  header.channelMask = channelMask & TELEM_ALL_CHANNELS;
+  header.fixedMask = fixedMask & header.channelMask;
+  for (uint8_t i = 0; i < TELEM_NUM_CHANNELS; i++)
+  {
+    header.decimals[i] = (decimals[i] > TELEM_MAX_DECIMALS) ? TELEM_MAX_DECIMALS : decimals[i];
+  }
+  header.timeStep = TELEM_DEFAULT_TIME_STEP;
+  header.timeFlags = is_timeSynchronized ? 0 : TELEM_TIME_UPTIME;
+  header.baseTimestamp = baseTimestamp;
+  header.baseSequence = baseSequence;
+  snprintf(header.deviceID, SIZE_DEVICE_ID, "%s", deviceID);
+  updateHeaderCRC(header);
+}
+
+void TelemetryRecordCodec::updateHeaderCRC(TelemetryPageHeader &header){
+  //Minus last element, cause we do not need the last element as it is the CRC we calculate
+  header.crc = CRC8.Compute_CRC8((uint8_t *)&header, sizeof(header) - 1);
+}
+
+bool TelemetryRecordCodec::isValidHeader(const TelemetryPageHeader &header){
+  if (header.magic != TELEM_PAGE_MAGIC || header.version != TELEM_RECORD_VERSION)
+  {
+    return false;
+  }
+  if (header.timeStep == 0 || (header.fixedMask & ~header.channelMask) != 0)
+  {
+    return false;
+  }
+  return CRC8.Compute_CRC8((uint8_t *)&header, sizeof(header)) == 0;
+}
+
+uint8_t TelemetryRecordCodec::recordSize(const TelemetryPageHeader &header){
+  uint8_t size = sizeof(uint16_t) + 1;  //delta timestamp and CRC
+  for (uint8_t i = 0; i < TELEM_NUM_CHANNELS; i++)
+  {
+    if (header.channelMask & (1 << i))
+    {
+      size += (header.fixedMask & (1 << i)) ? sizeof(int16_t) : sizeof(float);
+    }
+  }
+  return size;
+}
+
+void TelemetryRecordCodec::encode(const TelemetryPageHeader &header, const TelemetryData &telemetry, uint8_t *record){
+  uint8_t index = {0};
+  //Delta timestamp to the base of the page, times which can not be represented are marked as unknown
+  uint16_t deltaTime = TELEM_DELTA_TIME_UNKNOWN;
+  bool is_sameTimeBase = telemetry.is_timeSynchronized == !(header.timeFlags & TELEM_TIME_UPTIME);
+  if (is_sameTimeBase && telemetry.timestamp != 0 && header.baseTimestamp != 0 && telemetry.timestamp >= header.baseTimestamp)
+  {
+    uint32_t delta = (telemetry.timestamp - header.baseTimestamp) / header.timeStep;
+    if (delta < TELEM_DELTA_TIME_UNKNOWN)
+    {
+      deltaTime = delta;
+    }
+  }
+  memcpy(&record[index], &deltaTime, sizeof(deltaTime));
+  index += sizeof(deltaTime);
+
+  for (uint8_t i = 0; i < TELEM_NUM_CHANNELS; i++)
+  {
+    if (!(header.channelMask & (1 << i)))
+    {
+      continue;
+    }
+    if (header.fixedMask & (1 << i))
+    {
+      int16_t value = toFixedPoint(channel(telemetry, i), header.decimals[i]);
+      memcpy(&record[index], &value, sizeof(value));
+      index += sizeof(value);
+    }else{
+      float value = channel(telemetry, i);
+      memcpy(&record[index], &value, sizeof(value));
+      index += sizeof(value);
+    }
+  }
+  record[index] = CRC8.Compute_CRC8(record, index);
+}
+
+bool TelemetryRecordCodec::isDeltaTimeOverflow(const TelemetryPageHeader &header, const TelemetryData &telemetry){
+  bool is_sameTimeBase = telemetry.is_timeSynchronized == !(header.timeFlags & TELEM_TIME_UPTIME);
+  if (!is_sameTimeBase || telemetry.timestamp == 0 || header.baseTimestamp == 0 || telemetry.timestamp < header.baseTimestamp)
+  {
+    return false;
+  }
+  return (telemetry.timestamp - header.baseTimestamp) / header.timeStep >= TELEM_DELTA_TIME_UNKNOWN;
+}
+
+bool TelemetryRecordCodec::decode(const TelemetryPageHeader &header, const uint8_t *record, uint32_t recordIndex, TelemetryData &telemetry){
+  uint8_t size = recordSize(header);
+  if (CRC8.Compute_CRC8((uint8_t *)record, size) != 0)
+  {
+    return false;
+  }
+
+  uint8_t index = {0};
+  uint16_t deltaTime = {0};
+  memcpy(&deltaTime, &record[index], sizeof(deltaTime));
+  index += sizeof(deltaTime);
+  if (deltaTime == TELEM_DELTA_TIME_UNKNOWN)
+  {
+    telemetry.timestamp = {0};
+    telemetry.is_timeSynchronized = false;
+  }else{
+    telemetry.timestamp = header.baseTimestamp + (uint32_t)deltaTime * header.timeStep;
+    telemetry.is_timeSynchronized = !(header.timeFlags & TELEM_TIME_UPTIME);
+  }
+  telemetry.sequence = header.baseSequence + recordIndex;
+
+  for (uint8_t i = 0; i < TELEM_NUM_CHANNELS; i++)
+  {
+    if (!(header.channelMask & (1 << i)))
+    {
+      channel(telemetry, i) = 0.0F;
+      continue;
+    }
+    if (header.fixedMask & (1 << i))
+    {
+      int16_t value = {0};
+      memcpy(&value, &record[index], sizeof(value));
+      index += sizeof(value);
+      channel(telemetry, i) = fromFixedPoint(value, header.decimals[i]);
+    }else{
+      memcpy(&channel(telemetry, i), &record[index], sizeof(float));
+      index += sizeof(float);
+    }
+  }
+  snprintf(telemetry.deviceID, SIZE_DEVICE_ID, "%s", header.deviceID);
+  telemetry.crcValue = CRC8.Compute_CRC8((uint8_t *)&telemetry, sizeof(TelemetryData) - 1);
+  return true;
+}
+
+void TelemetryRecordCodec::encodeLegacy(const TelemetryData &telemetry, LegacyTelemetryRecord &record){
+  record.temp1 = telemetry.temp1;
+  record.temp2 = telemetry.temp2;
+  record.deflection = telemetry.deflection;
+  record.deflection2 = telemetry.deflection2;
+  record.pressure = telemetry.pressure;
+  record.picTemp = telemetry.picTemp;
+  memcpy(record.deviceID, telemetry.deviceID, SIZE_DEVICE_ID);
+  record.crcValue = CRC8.Compute_CRC8((uint8_t *)&record, sizeof(record) - 1);
+}
+
+bool TelemetryRecordCodec::decodeLegacy(const LegacyTelemetryRecord &record, TelemetryData &telemetry){
+  if (CRC8.Compute_CRC8((uint8_t *)&record, sizeof(record)) != 0)
+  {
+    return false;
+  }
+  telemetry.temp1 = record.temp1;
+  telemetry.temp2 = record.temp2;
+  telemetry.deflection = record.deflection;
+  telemetry.deflection2 = record.deflection2;
+  telemetry.pressure = record.pressure;
+  telemetry.picTemp = record.picTemp;
+  telemetry.timestamp = {0};
+  telemetry.is_timeSynchronized = false;
+  telemetry.sequence = {0};
+  memcpy(telemetry.deviceID, record.deviceID, SIZE_DEVICE_ID);
+  telemetry.deviceID[SIZE_DEVICE_ID - 1] = '\0';
+  telemetry.crcValue = CRC8.Compute_CRC8((uint8_t *)&telemetry, sizeof(TelemetryData) - 1);
+  return true;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file TelemetryRecord.h
+ * @brief Packed and versioned on-EEPROM format of the telemetry data sets, which are saved by TempTelemetry
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Every EEPROM page of the compact format begins with a TelemetryPageHeader after the last telemetry address.
+ * The header holds the device ID, a base timestamp and the channel layout once, so every record only
+ * contains a delta timestamp, the enabled channels and a CRC value.
+ * Pages without a valid header are written in the legacy format (LegacyTelemetryRecord).
+ *
+ */
+
+#ifndef TelemetryRecord_h
+#define TelemetryRecord_h
+
+    #include <Arduino.h>
+    #include "ID.h"
+
+    class TelemetryData;
+
+    const uint8_t TELEM_PAGE_MAGIC = {0xA5};            //Marker of a page header in the compact format
+    const uint8_t TELEM_RECORD_VERSION = {1};           //Version of the compact format
+    const uint8_t TELEM_NUM_CHANNELS = {6};             //temp1, temp2, deflection, deflection2, pressure, picTemp
+    const uint8_t TELEM_ALL_CHANNELS = {0x3F};          //Mask with every channel enabled
+    const uint8_t TELEM_MAX_DECIMALS = {4};             //Max number of decimals of a fixed point channel
+    const int16_t TELEM_FIXED_POINT_INVALID = {INT16_MIN}; //Fixed point value for NaN or values out of range
+    const uint8_t TELEM_DEFAULT_TIME_STEP = {2};        //Resolution of the delta timestamp in s, 2s cover 36h, then a new page is begun
+    const uint16_t TELEM_DELTA_TIME_UNKNOWN = {UINT16_MAX}; //Delta timestamp of data without time or out of range
+    const uint8_t TELEM_TIME_UPTIME = {0x01};           //Time flag: baseTimestamp is the uptime in s, the clock was not synchronized
+    //Max size of a compact record: delta timestamp, every channel as float and the CRC
+    const uint8_t TELEM_MAX_RECORD_SIZE = {sizeof(uint16_t) + TELEM_NUM_CHANNELS * sizeof(float) + 1};
+
+    /**
+     * @brief Header at the beginning of every page of the compact format
+     *
+     */
+    struct __attribute__((packed)) TelemetryPageHeader
+    {
+        uint8_t magic = {0};
+        uint8_t version = {0};
+        uint8_t channelMask = {0};                  //Bit i set if channel i is saved
+        uint8_t fixedMask = {0};                    //Bit i set if channel i is saved as int16 fixed point, else as float
+        uint8_t decimals[TELEM_NUM_CHANNELS] = {0}; //Number of decimals of every fixed point channel
+        uint8_t timeStep = {0};                     //Resolution of the delta timestamp in s
+        uint8_t timeFlags = {0};                    //TELEM_TIME_UPTIME if baseTimestamp is not Unix time
+        uint32_t baseTimestamp = {0};               //Unix time in s of the first record of the page, 0 if unknown
+        uint32_t baseSequence = {0};                //Sequence number of the first record, record i has baseSequence + i
+        char deviceID[SIZE_DEVICE_ID] = {0};
+        uint8_t crc = {0};
+    };
+
+    /**
+     * @brief Layout of TelemetryData as it has been saved before the compact format (version 0)
+     *
+     */
+    struct __attribute__((packed)) LegacyTelemetryRecord
+    {
+        float temp1;
+        float temp2;
+        float deflection;
+        float deflection2;
+        float pressure;
+        float picTemp;
+        char deviceID[SIZE_DEVICE_ID];
+        uint8_t crcValue;
+    };
+
+    /**
+     * @brief Encoding and decoding of telemetry data sets from/to the on-EEPROM formats
+     *
+     */
+    class TelemetryRecordCodec
+    {
+    public:
+        /**
+         * @brief Initialize a page header of the compact format incl. CRC
+         *
+         * @param header[out] header which should be initialized
+         * @param deviceID ID of the device, which is saved once per page
+         * @param baseTimestamp Unix time in s, the delta timestamps of the page refer to, 0 if unknown
+         * @param is_timeSynchronized false if baseTimestamp is the uptime in s
+         * @param baseSequence sequence number of the first record of the page
+         * @param channelMask bit i set if channel i should be saved
+         * @param fixedMask bit i set if channel i should be saved as int16 fixed point
+         * @param decimals number of decimals of every fixed point channel
+         */
+        static void initHeader(TelemetryPageHeader &header, const char *deviceID, uint32_t baseTimestamp, bool is_timeSynchronized, uint32_t baseSequence,
+                               uint8_t channelMask, uint8_t fixedMask, const uint8_t (&decimals)[TELEM_NUM_CHANNELS]);
+
+        /**
+         * @return True if the header has the correct magic, version and CRC value
+         */
+        static bool isValidHeader(const TelemetryPageHeader &header);
+
+        /**
+         * @return Size of one record in Bytes for the given header
+         */
+        static uint8_t recordSize(const TelemetryPageHeader &header);
+
+        /**
+         * @brief Calculate the CRC value of the header after it has been changed
+         *
+         */
+        static void updateHeaderCRC(TelemetryPageHeader &header);
+
+        /**
+         * @brief Encode telemetry data into a compact record incl. CRC
+         *
+         * @param header header of the page the record is written to
+         * @param telemetry data which should be encoded, incl. its timestamp. The timestamp is only saved,
+         * if it has the same time base (Unix time or uptime) as the header
+         * @param record[out] buffer of at least recordSize(header) Bytes
+         */
+        static void encode(const TelemetryPageHeader &header, const TelemetryData &telemetry, uint8_t *record);
+
+        /**
+         * @return true if the timestamp has the same time base as the header, but is too far behind its base
+         * for a delta timestamp, so the data has to be saved in a new page
+         */
+        static bool isDeltaTimeOverflow(const TelemetryPageHeader &header, const TelemetryData &telemetry);
+
+        /**
+         * @brief Decode a compact record. Channels which are not saved are set to 0.0,
+         * invalid fixed point values to NaN. The crcValue of the telemetry is calculated again.
+         *
+         * @param header header of the page the record has been read from
+         * @param record record of recordSize(header) Bytes
+         * @param recordIndex position of the record in the page, which defines its sequence number
+         * @param telemetry[out] decoded data incl. timestamp, its time base and sequence number
+         * @return true if the CRC value of the record is correct,
+         * @return false if the record is currupted
+         */
+        static bool decode(const TelemetryPageHeader &header, const uint8_t *record, uint32_t recordIndex, TelemetryData &telemetry);
+
+        /**
+         * @brief Encode telemetry data into the legacy format incl. CRC
+         *
+         */
+        static void encodeLegacy(const TelemetryData &telemetry, LegacyTelemetryRecord &record);
+
+        /**
+         * @brief Decode a record of the legacy format (migration of existing pages).
+         * The legacy format has no timestamp and sequence number, so both are set to 0 and the time is not synchronized.
+         *
+         * @return true if the CRC value of the record is correct,
+         * @return false if the record is currupted
+         */
+        static bool decodeLegacy(const LegacyTelemetryRecord &record, TelemetryData &telemetry);
+
+    private:
+        static float &channel(TelemetryData &telemetry, uint8_t index);
+        static float channel(const TelemetryData &telemetry, uint8_t index);
+        static int16_t toFixedPoint(float value, uint8_t decimals);
+        static float fromFixedPoint(int16_t value, uint8_t decimals);
+    };
+
+#endif
@@ -17,7 +17,25 @@ TempTelemetry::TempTelemetry(TelemetryData &telem)
   currentReadAddress = {0};
   is_allExtracted = false;
   numSavedTelem = {0};
-  sizeTelem = sizeof(telem);
+  //New pages are written in the compact format with every channel as fixed point value
+  is_compactFormat = true;
+  nextSequence = {0};
+  reservedSequence = {0};
+  is_sequenceLoaded = false;
+  channelMask = TELEM_ALL_CHANNELS;
+  fixedMask = TELEM_ALL_CHANNELS;
+  for (uint8_t i = 0; i < TELEM_NUM_CHANNELS; i++)
+  {
+    channelDecimals[i] = TELEM_DEFAULT_DECIMALS[i];
+  }
+  cachedPage[0] = {0};
+  cachedPage[1] = {0};
+  is_cursorCached = false;
+  is_savedFlagSet = false;
+  pendingLastTelemAddressLocation = {0};
+  is_lastTelemAddressPending = false;
+  readPage[0] = {0};
+  readPage[1] = {0};
   //Begin SPI EEPROM communication, but only if it has not begun yet
   if (!EEPROM_SPI.isInitialized())
   {
@@ -29,6 +47,7 @@ TempTelemetry::TempTelemetry(TelemetryData &telem)
 
 TempTelemetry::~TempTelemetry()
 {
+  flushTelemetry();
   EEPROM_SPI.end();
   Serial3.println(F("TempTelemetry object destroyed"));
 }
@@ -152,10 +171,202 @@ bool TempTelemetry::writeTillCorrectCRC(const uint32_t address, const EEPROM_add
 }
 
 
+void TempTelemetry::invalidateCursorCache(){
+  is_cursorCached = false;
+  writeFormat.page = {0};
+  is_savedFlagSet = false;
+}
+
+bool TempTelemetry::commitLastTelemAddress(){
+  if (!is_lastTelemAddressPending)
+  {
+    return true;
+  }
+  is_lastTelemAddressPending = false;
+  //Minus last element, cause we do not need the last element as it is the CRC we calculate
+  uint8_t sizeForCRC = sizeof(EEPROM_address) - 1;
+
+  if(writeTillCorrectCRC(pendingLastTelemAddressLocation, pendingLastTelemAddress)){
+    return true;
+  }
+
+  EEPROM_address lastTelemAddress = {0};
+  lastTelemAddress.crc = CRC8.Compute_CRC8<EEPROM_address>(lastTelemAddress, sizeForCRC);
+  uint8_t currentPage[2] = {1, 0};
+  if (cachedPage[0] >= MAX_PAGE_NUMBER){
+    Serial3.println(F("[ERROR]: Failed to write new value for the last telemtry Address. Go to the beginning of the first page"));
+    currentPage[0] = {1};
+  }else{
+    Serial3.println(F("[ERROR]: Failed to write new value for the last telemtry Address. Go to the beginning of the next page"));
+    currentPage[0] = cachedPage[0] + 1;
+  }
+  currentPage[1] = CRC8.Compute_CRC8(currentPage[0], sizeof(currentPage[0]));
+  writeTillCorrectCRC(ADDRESS_PAGE_FLAG, currentPage);
+  //Calculate new Address for the last telemetry address
+  uint32_t ADDRESS_LAST_TELEM_ADDRESS_PAGEx = (currentPage[0] == 1) ? ADDRESS_LAST_TELEM_ADDRESS_01 : (uint32_t)PAGE_SIZE * (currentPage[0] - 1);
+  writeTillCorrectCRC(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, lastTelemAddress);
+  invalidateCursorCache();
+  return false;
+}
+
+void TempTelemetry::flushTelemetry(){
+  EEPROM_SPI.flushWriteBuffer();
+  commitLastTelemAddress();
+}
+
+uint32_t TempTelemetry::getPageDataAddress(uint8_t _page){
+  if (_page <= 1)
+  {
+    return ADDRESS_FIRST_TELEM_01;
+  }
+  //Plus size of last telem Address, as at the begining of every page, the first Bytes are reserved for the last telemetry address
+  return (uint32_t)PAGE_SIZE * (_page - 1) + sizeof(EEPROM_address);
+}
+
+uint32_t TempTelemetry::getPageEndAddress(uint8_t _page){
+  //The last page ends before the MQTT outbox and the configuration area
+  uint32_t pageEnd = (uint32_t)PAGE_SIZE * _page;
+  return (pageEnd > ADDRESS_TELEMETRY_END) ? ADDRESS_TELEMETRY_END : pageEnd;
+}
+
+uint32_t TempTelemetry::getNextSequence(){
+  if (!is_sequenceLoaded)
+  {
+    EEPROM_address reserved = {0};
+    EEPROM_SPI.getEEPROMData(ADDRESS_SEQUENCE_RESERVE, reserved);
+    if (CRC8.Compute_CRC8<EEPROM_address>(reserved, sizeof(reserved)) != 0)
+    {
+      Serial3.println(F("[WARNING]: No valid reserved sequence number on EEPROM. Start sequence numbers at 0"));
+      reserved.value = {0};
+    }
+    //Numbers which may have been used before the reboot are skipped, as they are not known anymore
+    nextSequence = reserved.value;
+    reservedSequence = reserved.value;
+    is_sequenceLoaded = true;
+    useSequence(nextSequence - 1);
+  }
+  return nextSequence;
+}
+
+void TempTelemetry::useSequence(uint32_t _sequence){
+  //The reservation on the EEPROM must be known, else it could be overwritten by a lower value
+  getNextSequence();
+  if (_sequence + 1 > nextSequence)
+  {
+    nextSequence = _sequence + 1;
+  }
+  if (nextSequence < reservedSequence)
+  {
+    return;
+  }
+  EEPROM_address reserved = {0};
+  reserved.value = nextSequence + SEQUENCE_RESERVE_BLOCK;
+  //Minus last element, cause we do not need the last element as it is the CRC we calculate
+  reserved.crc = CRC8.Compute_CRC8<EEPROM_address>(reserved, sizeof(reserved) - 1);
+  if (writeTillCorrectCRC(ADDRESS_SEQUENCE_RESERVE, reserved))
+  {
+    reservedSequence = reserved.value;
+  }else{
+    Serial3.println(F("[ERROR]: Failed to reserve sequence numbers on EEPROM"));
+  }
+}
+
+bool TempTelemetry::writePageHeader(){
+  uint8_t (&headerFrame)[sizeof(TelemetryPageHeader)] = *(uint8_t (*)[sizeof(TelemetryPageHeader)])&writeFormat.header;
+  return writeTillCorrectCRC(getPageDataAddress(writeFormat.page), headerFrame);
+}
+
+void TempTelemetry::loadPageFormat(uint8_t _page, TelemetryPageFormat &_format){
+  EEPROM_SPI.getEEPROMData(getPageDataAddress(_page), _format.header);
+  if (TelemetryRecordCodec::isValidHeader(_format.header))
+  {
+    _format.is_compact = true;
+    _format.recordSize = TelemetryRecordCodec::recordSize(_format.header);
+    _format.firstRecordAddress = getPageDataAddress(_page) + sizeof(TelemetryPageHeader);
+  }else{
+    //Pages without header have been written before the compact format
+    _format.is_compact = false;
+    _format.recordSize = sizeof(LegacyTelemetryRecord);
+    _format.firstRecordAddress = getPageDataAddress(_page);
+  }
+  _format.page = _page;
+  _format.is_uptimeOfThisBoot = false;
+}
+
+uint32_t TempTelemetry::beginPage(uint8_t _page, const TelemetryData &_telemetry){
+  uint32_t firstTelemAddress = getPageDataAddress(_page);
+  writeFormat.page = _page;
+  writeFormat.firstRecordAddress = firstTelemAddress;
+  if (!is_compactFormat)
+  {
+    writeFormat.is_compact = false;
+    writeFormat.recordSize = sizeof(LegacyTelemetryRecord);
+    return firstTelemAddress;
+  }
+
+  writeFormat.is_uptimeOfThisBoot = true;
+  TelemetryRecordCodec::initHeader(writeFormat.header, _telemetry.deviceID, _telemetry.timestamp, _telemetry.is_timeSynchronized,
+                                   getNextSequence(), channelMask, fixedMask, channelDecimals);
+  if (!writePageHeader())
+  {
+    Serial3.println(F("[WARNING]: Failed to write page header. Save telemetry in legacy format"));
+    writeFormat.is_compact = false;
+    writeFormat.recordSize = sizeof(LegacyTelemetryRecord);
+    return firstTelemAddress;
+  }
+  writeFormat.is_compact = true;
+  writeFormat.recordSize = TelemetryRecordCodec::recordSize(writeFormat.header);
+  writeFormat.firstRecordAddress = firstTelemAddress + sizeof(TelemetryPageHeader);
+  return writeFormat.firstRecordAddress;
+}
+
+bool TempTelemetry::decodeRecord(const TelemetryPageFormat &_format, const uint8_t *_record, uint32_t _address, TelemetryData &_savedTelemetry){
+  if (_format.is_compact)
+  {
+    uint32_t recordIndex = (_address - _format.firstRecordAddress) / _format.recordSize;
+    return TelemetryRecordCodec::decode(_format.header, _record, recordIndex, _savedTelemetry);
+  }
+  return TelemetryRecordCodec::decodeLegacy(*(const LegacyTelemetryRecord *)_record, _savedTelemetry);
+}
+
+void TempTelemetry::refreshReadFormat(){
+  //Only the time base of a page header is changed after the page has been begun
+  if (readFormat.is_compact && writeFormat.is_compact && writeFormat.page == readFormat.page)
+  {
+    readFormat.header.timeFlags = writeFormat.header.timeFlags;
+    readFormat.header.baseTimestamp = writeFormat.header.baseTimestamp;
+  }
+}
+
+bool TempTelemetry::readRecord(uint32_t _address, TelemetryData &_savedTelemetry){
+  uint8_t record[sizeof(LegacyTelemetryRecord)] = {0};
+  refreshReadFormat();
+  EEPROM_SPI.readExternEEPROM(_address, record, readFormat.recordSize);
+  return decodeRecord(readFormat, record, _address, _savedTelemetry);
+}
+
+void TempTelemetry::setCompactFormat(uint8_t _channelMask, uint8_t _fixedMask, const uint8_t (&_decimals)[TELEM_NUM_CHANNELS]){
+  is_compactFormat = true;
+  channelMask = _channelMask & TELEM_ALL_CHANNELS;
+  fixedMask = _fixedMask & channelMask;
+  for (uint8_t i = 0; i < TELEM_NUM_CHANNELS; i++)
+  {
+    channelDecimals[i] = _decimals[i];
+  }
+}
+
+void TempTelemetry::setLegacyFormat(){
+  is_compactFormat = false;
+}
+
 void TempTelemetry::resetTelemAddresses(){
   //Set last telemetry Address value to the beginning = zero
   EEPROM_address lastTelemAddress = {0};
   Serial3.println(F("Reset telemtry Addresses"));
+  //Pending data and addresses are not valid anymore
+  EEPROM_SPI.flushWriteBuffer();
+  is_lastTelemAddressPending = false;
+  invalidateCursorCache();
   //Save new last telemtry address to the EEPROM
   writeTillCorrectCRC(ADDRESS_LAST_TELEM_ADDRESS_01, lastTelemAddress);
   //Set the current page to the first one
@@ -173,8 +384,6 @@ void TempTelemetry::saveTelemetry(TelemetryData &telemetry){
   //uint8_t sizeTelem = sizeof(telemetry);
   //Variable for the current page we are writing in
   uint8_t currentPage[2] = {1, 0};
-  //Boolean for firstPage
-  bool isFirstPage = false;
   //Size of currentPage
   uint8_t sizeCurrentPage = sizeof(currentPage);
   //Variable for the next free Address for writing telemetry data
@@ -186,24 +395,36 @@ void TempTelemetry::saveTelemetry(TelemetryData &telemetry){
   //Variable for calculated crc value
   uint8_t calculatedChecksum = {0};
   
+  //The data of the caller is not changed except its sequence number, so a reused object is timestamped again
+  TelemetryData savedTelemetry = telemetry;
+  //The timestamp of the caller is only taken, if it is marked as Unix time. Else the clock is taken,
+  //or the uptime till the clock is synchronized
+  if (!telemetry.is_timeSynchronized || telemetry.timestamp == 0){
+    savedTelemetry.is_timeSynchronized = TelemetryClock.isSynchronized();
+    savedTelemetry.timestamp = savedTelemetry.is_timeSynchronized ? TelemetryClock.now() : TelemetryClock.uptime();
+  }
   
   //calculatedChecksum = Compute_CRC8(telemFrame, sizeTelem-1);//-1
-  calculatedChecksum = CRC8.Compute_CRC8<TelemetryData>(telemetry, sizeTelem-1);
+  calculatedChecksum = CRC8.Compute_CRC8<TelemetryData>(savedTelemetry, sizeof(TelemetryData)-1);
   Serial3.print(F("CalculatedChecksum of telemFrame: "));
   //Serial3.println(calculatedChecksum);
 
-  telemetry.crcValue = calculatedChecksum;
+  savedTelemetry.crcValue = calculatedChecksum;
   
-  Serial3.println(telemetry.crcValue);
+  Serial3.println(savedTelemetry.crcValue);
 
   //Check in which page we are currently in
-  EEPROM_SPI.getEEPROMData(ADDRESS_PAGE_FLAG, currentPage);
+  if (is_cursorCached){
+    currentPage[0] = cachedPage[0];
+    currentPage[1] = cachedPage[1];
+  }else{
+    EEPROM_SPI.getEEPROMData(ADDRESS_PAGE_FLAG, currentPage);
+  }
   calculatedChecksum = CRC8.Compute_CRC8(currentPage, sizeCurrentPage);
   // Serial3.print(F("currentPage: "));
   // Serial3.println(currentPage[0]);
   // Serial3.print(F("with CRC value: "));
   // Serial3.println(currentPage[1]);
-  uint32_t lastAddressOfPage = (uint32_t)PAGE_SIZE * currentPage[0] - sizeTelem;
   //Address of last Telemetry Address which is at the beginning of each page
   uint32_t ADDRESS_LAST_TELEM_ADDRESS_PAGEx = {ADDRESS_LAST_TELEM_ADDRESS_01};//(uint32_t)PAGE_SIZE * (currentPage[0] - 1);
 
@@ -214,12 +435,14 @@ void TempTelemetry::saveTelemetry(TelemetryData &telemetry){
     currentFreEAddress = {0};
     currentFreEAddress.crc = CRC8.Compute_CRC8<uint32_t>(currentFreEAddress.value, sizeof(currentFreEAddress.value));
     currentPage[0] = {1};
-    isFirstPage = true;
 
   }else if (currentPage[0] == 1){
-    isFirstPage = true;
     //Get the last telemetry EEPROM Address in current page, where the last data was written
-    EEPROM_SPI.getEEPROMData(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, currentFreEAddress);
+    if (is_cursorCached){
+      currentFreEAddress = cachedLastTelemAddress;
+    }else{
+      EEPROM_SPI.getEEPROMData(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, currentFreEAddress);
+    }
     // Serial3.print(F("Last telemetry address is: "));
     // Serial3.println(currentFreEAddress.value);
     // Serial3.print(F("with crc: "));
@@ -227,7 +450,11 @@ void TempTelemetry::saveTelemetry(TelemetryData &telemetry){
   } else{
     //Get the last telemetry EEPROM Address in current page, where the last data was written
     ADDRESS_LAST_TELEM_ADDRESS_PAGEx = (uint32_t)PAGE_SIZE * (currentPage[0] - 1);
-    EEPROM_SPI.getEEPROMData(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, currentFreEAddress);
+    if (is_cursorCached){
+      currentFreEAddress = cachedLastTelemAddress;
+    }else{
+      EEPROM_SPI.getEEPROMData(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, currentFreEAddress);
+    }
     // Serial3.print(F("Last telemetry address is: "));
     // Serial3.println(currentFreEAddress.value);
     // Serial3.print(F("with crc: "));
@@ -237,32 +464,35 @@ void TempTelemetry::saveTelemetry(TelemetryData &telemetry){
   //Check if value of the last telemtry EEPROM Address in current page is currupted
   calculatedChecksum = CRC8.Compute_CRC8<EEPROM_address>(currentFreEAddress, sizeTelemAddress);
 
+  //Get the record format of the current page, as it defines the size of one telemetry data set
+  if (!is_cursorCached || writeFormat.page != currentPage[0]){
+    loadPageFormat(currentPage[0], writeFormat);
+  }
+  uint32_t lastAddressOfPage = getPageEndAddress(currentPage[0]) - writeFormat.recordSize;
+  //The delta timestamp of a record covers 36h with the default time step, later data begins a new page with a new base time.
+  //The uptime of an earlier boot is no base, so it is not compared
+  bool is_timeOutOfPage = writeFormat.is_compact
+                          && (writeFormat.is_uptimeOfThisBoot || !(writeFormat.header.timeFlags & TELEM_TIME_UPTIME))
+                          && TelemetryRecordCodec::isDeltaTimeOverflow(writeFormat.header, savedTelemetry);
+
   //Check if something went wrong or the current free Address is currupted
   if (currentFreEAddress.value >= MAX_25CSM04_ADDRESS || calculatedChecksum != 0){
     Serial3.println(F("ERROR: Currupted last telemtry address. Start new at first page at the begining"));
     //Set everything to the beginning of the first page
     resetTelemAddresses();
-    currentFreEAddress.value = ADDRESS_FIRST_TELEM_01;
     currentPage[0] = {1};
-    isFirstPage = true;
     //Set new Address for the last telemetry address
     ADDRESS_LAST_TELEM_ADDRESS_PAGEx = ADDRESS_LAST_TELEM_ADDRESS_01;
+    currentFreEAddress.value = beginPage(currentPage[0], savedTelemetry);
     
 
   }else if (currentFreEAddress.value == 0){   //Check if we are at the beginning of the EEPROM page
-    if (isFirstPage)
-    {
-      currentFreEAddress.value = ADDRESS_FIRST_TELEM_01;
-      // Serial3.println(F("We are at the beginning of the first page"));
-    }else{
-      //Set the address for the current free address at the beginning of each page
-      //Plus size of last telem Address, as at the begining of every page, the first Bytes are reserved for the last telemetry address
-      currentFreEAddress.value = ADDRESS_LAST_TELEM_ADDRESS_PAGEx + sizeTelemAddress; 
-      // Serial3.print(F("We are at the beginning of page "));
-      // Serial3.println(currentPage[0]);
-    }
+    //Set the address for the current free address at the beginning of each page, behind the page header
+    currentFreEAddress.value = beginPage(currentPage[0], savedTelemetry);
     
-  }else if (currentFreEAddress.value >= lastAddressOfPage){ //Check if we are at the end of current page
+  }else if (currentFreEAddress.value >= lastAddressOfPage || is_timeOutOfPage){ //Check if we are at the end of current page or its time range
+    //Everything of the old page has to be on the EEPROM, before we switch to the next page
+    flushTelemetry();
     // Serial3.print(F("Reached end of page "));
     // Serial3.println(currentPage[0]);
     
@@ -270,11 +500,8 @@ void TempTelemetry::saveTelemetry(TelemetryData &telemetry){
       // Serial3.println(F("Go to the first page at the beginning"));
       currentPage[0] = {1};
       currentPage[1] = CRC8.Compute_CRC8(currentPage[0], sizeof(currentPage[0]));
-      isFirstPage = true;
       //Set new Address for the last telemetry address
       ADDRESS_LAST_TELEM_ADDRESS_PAGEx = ADDRESS_LAST_TELEM_ADDRESS_01;
-      //Set new Address for the next free telemetry address
-      currentFreEAddress.value = ADDRESS_FIRST_TELEM_01;
       
     }else{  //else increase the page number
       // Serial3.println(F("Go to the next page"));
@@ -282,16 +509,20 @@ void TempTelemetry::saveTelemetry(TelemetryData &telemetry){
       currentPage[1] = CRC8.Compute_CRC8(currentPage[0], sizeof(currentPage[0]));
       //Calculate new Address for the last telemetry address
       ADDRESS_LAST_TELEM_ADDRESS_PAGEx = (uint32_t)PAGE_SIZE * (currentPage[0] - 1);
-      //Plus size of last telem Address, as at the begining of every page, the first Bytes are reserved for the last telemetry address
-      currentFreEAddress.value = ADDRESS_LAST_TELEM_ADDRESS_PAGEx + sizeTelemAddress;
       
     } 
+    //The last telemetry address of the new page may be left over from an earlier cycle, so set it to the beginning
+    EEPROM_address emptyTelemAddress = {0};
+    emptyTelemAddress.crc = CRC8.Compute_CRC8<EEPROM_address>(emptyTelemAddress, sizeTelemAddress - 1);
+    writeTillCorrectCRC(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, emptyTelemAddress);
     //Check if the writing process was not currupted
     writeTillCorrectCRC(ADDRESS_PAGE_FLAG, currentPage);
+    //Set new Address for the next free telemetry address, behind the header of the new page
+    currentFreEAddress.value = beginPage(currentPage[0], savedTelemetry);
   }else{
     //Increase address on EEPROM by the size of the previously written data to get the actual current next free address
     // Serial3.println(F("Increase current free EEPROM Address by size of telemetry frame"));
-    currentFreEAddress.value += sizeTelem;  
+    currentFreEAddress.value += writeFormat.recordSize;  
   }
   
   
@@ -302,8 +533,43 @@ void TempTelemetry::saveTelemetry(TelemetryData &telemetry){
   // Serial3.print("with crc value: ");
   // Serial3.println(currentPage[1]);
     
-  //Put data frame to the current free EEPROM address
-  EEPROM_SPI.putEEPROMData(currentFreEAddress.value, telemetry); /*telemetry*/
+  //Encode the data frame in the format of the current page
+  uint8_t record[sizeof(LegacyTelemetryRecord)] = {0};
+  if (writeFormat.is_compact){
+    TelemetryPageHeader &header = writeFormat.header;
+    bool is_uptimePage = header.timeFlags & TELEM_TIME_UPTIME;
+    if (header.baseTimestamp == 0 && savedTelemetry.timestamp != 0){
+      //The page has been started without time, so take the first known time as base of the page
+      header.baseTimestamp = savedTelemetry.timestamp;
+      header.timeFlags = savedTelemetry.is_timeSynchronized ? 0 : TELEM_TIME_UPTIME;
+      writeFormat.is_uptimeOfThisBoot = true;
+      TelemetryRecordCodec::updateHeaderCRC(header);
+      writePageHeader();
+    }else if (is_uptimePage && writeFormat.is_uptimeOfThisBoot && TelemetryClock.isSynchronized()){
+      //The clock has been synchronized since the page was begun, so the records of the page get Unix time
+      header.baseTimestamp = TelemetryClock.uptimeToEpoch(header.baseTimestamp);
+      header.timeFlags = {0};
+      TelemetryRecordCodec::updateHeaderCRC(header);
+      writePageHeader();
+    }else if (is_uptimePage && !writeFormat.is_uptimeOfThisBoot && !savedTelemetry.is_timeSynchronized){
+      //The uptime of an earlier boot is no base for the uptime of this boot, so the time is unknown
+      savedTelemetry.timestamp = {0};
+    }
+    //The sequence number is defined by the position of the record in the page
+    savedTelemetry.sequence = writeFormat.header.baseSequence + (currentFreEAddress.value - writeFormat.firstRecordAddress) / writeFormat.recordSize;
+    useSequence(savedTelemetry.sequence);
+    TelemetryRecordCodec::encode(writeFormat.header, savedTelemetry, record);
+  }else{
+    //The legacy format has no sequence number, but the caller gets one anyway
+    savedTelemetry.sequence = getNextSequence();
+    useSequence(savedTelemetry.sequence);
+    TelemetryRecordCodec::encodeLegacy(savedTelemetry, *(LegacyTelemetryRecord *)record);
+  }
+  //The sequence number is part of the telemetry, so the CRC value of the caller has to be calculated again
+  telemetry.sequence = savedTelemetry.sequence;
+  telemetry.crcValue = CRC8.Compute_CRC8<TelemetryData>(telemetry, sizeof(TelemetryData)-1);
+  //Put data frame to the write buffer at the current free EEPROM address, it is written as soon as a page is full
+  bool flushed = EEPROM_SPI.writeBufferedEEPROM(currentFreEAddress.value, record, writeFormat.recordSize);
   //Update last telemetry address  
   lastTelemAddress.value = currentFreEAddress.value;
   
@@ -311,64 +577,47 @@ void TempTelemetry::saveTelemetry(TelemetryData &telemetry){
   uint8_t sizeForCRC = sizeTelemAddress - 1;
 
   lastTelemAddress.crc = CRC8.Compute_CRC8<uint32_t>(currentFreEAddress.value, sizeForCRC);
-  
-  // Serial3.print("put Address of last Telemetry: ");
-  // Serial3.println(lastTelemAddress.value,BIN);
-  // Serial3.println(lastTelemAddress.crc,BIN);
-  // Serial3.println(lastTelemAddress.value);
-  // Serial3.println(lastTelemAddress.crc);
-  // Serial3.println();
 
   //Flag for new saved telemetry data
-  uint8_t savedNewTelem[2] = {1, 0};
-  /*Get first and update only if it is different!*/
-  savedNewTelem[1] = CRC8.Compute_CRC8(savedNewTelem[0], sizeof(savedNewTelem[0]));
-
-  uint8_t is_savedNewTelem[2] = {0};
-  EEPROM_SPI.getEEPROMData(ADDRESS_SAVED_TELEM_FLAG, is_savedNewTelem);
-  if (is_savedNewTelem[0] != savedNewTelem[0] || is_savedNewTelem[1] != savedNewTelem[1])
+  if (!is_savedFlagSet)
   {
-    Serial3.println(F("Update savedNewTelem with: "));
-    Serial3.println(savedNewTelem[0]);
-    Serial3.println(savedNewTelem[1]);
-    if(!writeTillCorrectCRC(ADDRESS_SAVED_TELEM_FLAG, savedNewTelem)){
-      Serial3.println(F("[WARNING]: Failed to set saved new telemetry flag! Data may be ignored if extracted"));
+    uint8_t savedNewTelem[2] = {1, 0};
+    /*Get first and update only if it is different!*/
+    savedNewTelem[1] = CRC8.Compute_CRC8(savedNewTelem[0], sizeof(savedNewTelem[0]));
+
+    uint8_t is_savedNewTelem[2] = {0};
+    EEPROM_SPI.getEEPROMData(ADDRESS_SAVED_TELEM_FLAG, is_savedNewTelem);
+    if (is_savedNewTelem[0] != savedNewTelem[0] || is_savedNewTelem[1] != savedNewTelem[1])
+    {
+      Serial3.println(F("Update savedNewTelem with: "));
+      Serial3.println(savedNewTelem[0]);
+      Serial3.println(savedNewTelem[1]);
+      if(!writeTillCorrectCRC(ADDRESS_SAVED_TELEM_FLAG, savedNewTelem)){
+        Serial3.println(F("[WARNING]: Failed to set saved new telemetry flag! Data may be ignored if extracted"));
+      }
     }
+    is_savedFlagSet = true;
   }
 
   /*Update the current page and the last telemtry address*/
-  if(currentPage[0] == MAX_PAGE_NUMBER){
-    //Put the last telemetry EEPROM Address in current page, where the last data was written
-    //EEPROM_SPI.putEEPROMData(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, lastTelemAddress);
-    if(!writeTillCorrectCRC(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, lastTelemAddress)){
-      Serial3.println(F("[ERROR]: Failed to write new value for the last telemtry Address. Go to the beginning of the first page"));
-      currentPage[0] = {1};
-      currentPage[1] = CRC8.Compute_CRC8(currentPage[0], sizeof(currentPage[0]));
-      isFirstPage = true;
-      writeTillCorrectCRC(ADDRESS_PAGE_FLAG, currentPage);
-      // lastTelemAddress[0] = {0};
-      // lastTelemAddress[1] = Compute_CRC8(lastTelemAddress, sizeForCRC);
-      lastTelemAddress.value = {0};
-      lastTelemAddress.crc = CRC8.Compute_CRC8<EEPROM_address>(lastTelemAddress, sizeForCRC);
-      writeTillCorrectCRC(ADDRESS_LAST_TELEM_ADDRESS_01, lastTelemAddress);
-    }
-
-  }else{
-    //Put the last telemetry EEPROM Address in current page, where the last data was written
-    if(!writeTillCorrectCRC(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, lastTelemAddress)){
-      Serial3.println(F("[ERROR]: Failed to write new value for the last telemtry Address. Go to the beginning of the next page"));
-      currentPage[0]++;
-      currentPage[1] = CRC8.Compute_CRC8(currentPage[0], sizeof(currentPage[0]));
-      writeTillCorrectCRC(ADDRESS_PAGE_FLAG, currentPage);
-
-      lastTelemAddress.value = {0};
-      lastTelemAddress.crc = CRC8.Compute_CRC8<EEPROM_address>(lastTelemAddress, sizeForCRC);
-      //Calculate new Address for the last telemetry address
-      ADDRESS_LAST_TELEM_ADDRESS_PAGEx = (uint32_t)PAGE_SIZE * (currentPage[0] - 1);
-      writeTillCorrectCRC(ADDRESS_LAST_TELEM_ADDRESS_PAGEx, lastTelemAddress);
-    } 
+  //The last telemetry address may only point to data, which is completely written to the EEPROM
+  if (flushed && EEPROM_SPI.hasPendingWrites()){
+    //Only the end of the current telemetry is still in the write buffer, so the previous one is completely written
+    commitLastTelemAddress();
+  }
+  pendingLastTelemAddress = lastTelemAddress;
+  pendingLastTelemAddressLocation = ADDRESS_LAST_TELEM_ADDRESS_PAGEx;
+  is_lastTelemAddressPending = true;
+  //Remember the write cursor for the next call
+  cachedPage[0] = currentPage[0];
+  cachedPage[1] = currentPage[1];
+  cachedLastTelemAddress = lastTelemAddress;
+  is_cursorCached = true;
+
+  if (flushed && !EEPROM_SPI.hasPendingWrites()){
+    //The current telemetry is completely written
+    commitLastTelemAddress();
   }
-  
 }
 
 
@@ -379,13 +628,16 @@ void TempTelemetry::printTelemetry(TelemetryData &_telemetry){
   Serial3.println(_telemetry.deflection);
   Serial3.println(_telemetry.pressure);
   Serial3.println(_telemetry.picTemp);
-  //Serial3.println(_telemetry.timestamp);
+  Serial3.println(_telemetry.timestamp);
+  Serial3.println(_telemetry.sequence);
   Serial3.println(_telemetry.deviceID);
   Serial3.println(_telemetry.crcValue);
 }
 
 bool TempTelemetry::checkForNewSavedTelem(){
   //Serial3.println(F("Begin ckeckForSavedTelem"));
+  //Buffered telemetry data has to be on the EEPROM before it can be extracted
+  flushTelemetry();
   uint8_t calculatedChecksum = {0};
   uint8_t savedNewTelem[2] = {0};
   EEPROM_SPI.getEEPROMData(ADDRESS_SAVED_TELEM_FLAG, savedNewTelem);
@@ -431,13 +683,11 @@ uint32_t TempTelemetry::calcNumSavedTelem(uint32_t _firstTelemAddress, uint32_t
     // Serial3.print(F("res befor division: "));
     // Serial3.println(res);
     //Plus one, as we begin to count from address 0
-    return res / sizeTelem + 1;
+    return res / readFormat.recordSize + 1;
   }
 }
 
 bool TempTelemetry::extractAllTelemetry(uint8_t (&_currentPage)[2], EEPROM_address &_lastTelemAddress, TelemetryData &_savedTelemetry){
-  //Variable for CRC value
-  uint8_t calculatedChecksum = {0};
   //Size of telemetry data
   //uint8_t sizeTelem = sizeof(_savedTelemetry);
 
@@ -463,7 +713,7 @@ bool TempTelemetry::extractAllTelemetry(uint8_t (&_currentPage)[2], EEPROM_addre
     is_allExtracted = false;
     //Read telemtry data ///until last address///
     //while (currentReadAddress != lastTelemAddress.value){
-      EEPROM_SPI.getEEPROMData(currentReadAddress, _savedTelemetry);
+      bool is_correct = readRecord(currentReadAddress, _savedTelemetry);
       // Serial3.print("result read on address ");
       // Serial3.print(currentReadAddress);
       // Serial3.println(" : ");
@@ -473,7 +723,7 @@ bool TempTelemetry::extractAllTelemetry(uint8_t (&_currentPage)[2], EEPROM_addre
       // Serial3.println(calculatedChecksum);
 
       //Update currentReadAddress by size of saved telemetry data
-      currentReadAddress += sizeTelem;
+      currentReadAddress += readFormat.recordSize;
     
       //Catch overflow of EEPROM address pointer
       if (currentReadAddress >= (MAX_25CSM04_ADDRESS)){
@@ -481,8 +731,7 @@ bool TempTelemetry::extractAllTelemetry(uint8_t (&_currentPage)[2], EEPROM_addre
       } 
 
       //Check if the saved telemtrey data was currupted
-      calculatedChecksum = CRC8.Compute_CRC8<TelemetryData>(_savedTelemetry, sizeTelem);
-      if (calculatedChecksum!=0){
+      if (!is_correct){
         Serial3.println(F("[ERROR]: Currupted telemetry data on EEPROM. Data is ignored"));
         return false;
       }else{
@@ -497,19 +746,15 @@ bool TempTelemetry::extractAllTelemetry(uint8_t (&_currentPage)[2], EEPROM_addre
 
 bool TempTelemetry::extractOnlyTelemetry(uint32_t _lastTelemAddress, TelemetryData &_savedTelemetry){
   Serial3.println(F("Call extractOnlyTelemetry()"));
-  uint8_t calculatedChecksum = {0};
   //Size of telemetry data
-  EEPROM_SPI.getEEPROMData(_lastTelemAddress, _savedTelemetry);
+  bool is_correct = readRecord(_lastTelemAddress, _savedTelemetry);
   // Serial3.print("result read on address ");
   // Serial3.print(_lastTelemAddress.value);
   // Serial3.println(" : ");
   // printTelemetry(_savedTelemetry);
 
   //Check if the saved telemtrey data was currupted
-  calculatedChecksum = CRC8.Compute_CRC8<TelemetryData>(_savedTelemetry, sizeTelem);
-  // Serial3.print(F("CalculatedChecksum of saved TelemtryData: "));
-  // Serial3.println(calculatedChecksum);
-  if (calculatedChecksum!=0){
+  if (!is_correct){
     Serial3.println(F("[ERROR]: Currupted telemetry data on EEPROM. Data is ignored"));
     return false;
   }else{
@@ -518,13 +763,80 @@ bool TempTelemetry::extractOnlyTelemetry(uint32_t _lastTelemAddress, TelemetryDa
   }
 }
 
+uint32_t TempTelemetry::getNumRemainingTelem(){
+  if (is_allExtracted || readLastTelemAddress.value == 0 || readLastTelemAddress.value < currentReadAddress)
+  {
+    return 0;
+  }
+  return (readLastTelemAddress.value - currentReadAddress) / readFormat.recordSize + 1;
+}
+
+uint16_t TempTelemetry::extractTelemetryBatch(TelemetryData *_savedTelemetry, uint16_t _maxCount, uint16_t &_numCurrupted){
+  _numCurrupted = {0};
+  uint32_t numRemaining = getNumRemainingTelem();
+  if (numRemaining == 0 || _maxCount == 0)
+  {
+    return 0;
+  }
+
+  //Limit the batch, so the size in Bytes fits into one read sequence
+  uint16_t maxBatchCount = UINT16_MAX / sizeof(TelemetryData);
+  uint16_t count = (numRemaining < _maxCount) ? numRemaining : _maxCount;
+  if (count > maxBatchCount)
+  {
+    count = maxBatchCount;
+  }
+
+  //The records are stored back to back, so they can be streamed in one SPI transaction.
+  //They are never bigger than TelemetryData, so they are read to the end of the caller buffer and decoded
+  //to the front. Decoding record i only overwrites memory of records which have already been decoded.
+  refreshReadFormat();
+  size_t recordSize = readFormat.recordSize;
+  uint8_t *buffer = (uint8_t *)_savedTelemetry;
+  uint16_t recordsOffset = count * (sizeof(TelemetryData) - recordSize);
+  uint32_t batchAddress = currentReadAddress;
+  EEPROM_SPI.readExternEEPROM(currentReadAddress, &buffer[recordsOffset], count * recordSize);
+  currentReadAddress += (uint32_t)count * recordSize;
+
+  //Check the CRC of every record in the buffer and keep only the valid ones
+  uint8_t record[sizeof(LegacyTelemetryRecord)] = {0};
+  uint16_t numValid = {0};
+  for (uint16_t i = 0; i < count; i++)
+  {
+    memcpy(record, &buffer[recordsOffset + i * recordSize], recordSize);
+    if (!decodeRecord(readFormat, record, batchAddress + (uint32_t)i * recordSize, _savedTelemetry[numValid]))
+    {
+      _numCurrupted++;
+      continue;
+    }
+    numValid++;
+  }
+
+  if (_numCurrupted > 0)
+  {
+    Serial3.print(F("[ERROR]: Currupted telemetry data on EEPROM. Ignored data sets: "));
+    Serial3.println(_numCurrupted);
+  }
+
+  //Everything has been extracted, so update the page value and the address of last telemetry address
+  if (count == numRemaining)
+  {
+    updateTelemAddresses(readPage, readLastTelemAddress);
+    is_allExtracted = true;
+  }
+  return numValid;
+}
+
 bool TempTelemetry::allTelemExtracted(void){
   return is_allExtracted;
 }
 
 bool TempTelemetry::initTelemAddresses(uint8_t (&_currentPage)[2], EEPROM_address &_lastTelemAddress){
   currentReadAddress = 0;
+  readLastTelemAddress.value = {0};
   Serial3.println(F("Call initTelemAddress()"));
+  //Buffered telemetry data has to be on the EEPROM before it can be extracted
+  flushTelemetry();
   //Size of currentPage
   uint8_t sizeCurrentPage = sizeof(_currentPage);
   //Variable for the first telemetry Address 
@@ -565,6 +877,11 @@ bool TempTelemetry::initTelemAddresses(uint8_t (&_currentPage)[2], EEPROM_addres
     firstTelemAddress = ADDRESS_LAST_TELEM_ADDRESS_PAGEx + sizeTelemAddress;
     ADDRESS_CURRENT_LAST_TELEM_ADDRESS = ADDRESS_LAST_TELEM_ADDRESS_PAGEx;
   }
+  //Records of the compact format begin behind the page header, pages without header are read in the legacy format
+  loadPageFormat(_currentPage[0], readFormat);
+  if (readFormat.is_compact){
+    firstTelemAddress += sizeof(TelemetryPageHeader);
+  }
   // Serial3.print("firstTelemAddress: ");
   // Serial3.println(firstTelemAddress);
 
@@ -580,7 +897,7 @@ bool TempTelemetry::initTelemAddresses(uint8_t (&_currentPage)[2], EEPROM_addres
   calculatedChecksum = CRC8.Compute_CRC8<EEPROM_address>(_lastTelemAddress, sizeof(_lastTelemAddress));
 
   //Value of maximum possible Telemetry Address in a page
-  const uint32_t maxValueTelemAddress = (uint32_t)PAGE_SIZE*_currentPage[0];
+  const uint32_t maxValueTelemAddress = getPageEndAddress(_currentPage[0]);
   // Serial3.print("maxValueTelemAddress: ");
   // Serial3.println(maxValueTelemAddress);
 
@@ -594,6 +911,11 @@ bool TempTelemetry::initTelemAddresses(uint8_t (&_currentPage)[2], EEPROM_addres
   }else{
     //Calculate the number nof saved telemetry data
     numSavedTelem = calcNumSavedTelem(firstTelemAddress, _lastTelemAddress.value);
+    //Remember the read range for extractTelemetryBatch
+    readPage[0] = _currentPage[0];
+    readPage[1] = _currentPage[1];
+    readLastTelemAddress = _lastTelemAddress;
+    is_allExtracted = false;
     return true;
   }
    
@@ -602,6 +924,9 @@ bool TempTelemetry::initTelemAddresses(uint8_t (&_currentPage)[2], EEPROM_addres
 void TempTelemetry::updateTelemAddresses(uint8_t (_currentPage)[2], EEPROM_address _lastTelemAddress){
   uint8_t myCurrentPage[2] = {_currentPage[0], _currentPage[1]};
   Serial3.println(F("Call updateTelemAddress()"));
+  //Every saved telemetry data has been extracted, so the write cursor is read from the EEPROM again
+  is_lastTelemAddressPending = false;
+  invalidateCursorCache();
   uint8_t sizeTelemAddress = sizeof(_lastTelemAddress);
   uint32_t _AddressCurrentLastTelemAddress = {0};
   uint8_t savedNewTelem[2] = {0};
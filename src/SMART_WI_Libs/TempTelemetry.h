@@ -15,6 +15,29 @@
     #include "EEPROM_SPI.h"
     #include "CRC8.h"
     #include "ID.h"
+    #include "TelemetryRecord.h"
+    #include "TelemetryClock.h"
+
+    const uint16_t SEQUENCE_RESERVE_BLOCK = {1024};     //Number of sequence numbers which are reserved with one EEPROM write
+
+    //Default number of decimals of the fixed point channels temp1, temp2, deflection, deflection2, pressure, picTemp.
+    //Chosen from the range of the channels, as int16 fixed point values are limited to +-32767 / 10^decimals:
+    //temperatures up to +-3276.7°C, deflections up to +-327.67mm, pressure up to +-32767hPa, PIC temperature up to +-327.67°C
+    const uint8_t TELEM_DEFAULT_DECIMALS[TELEM_NUM_CHANNELS] = {1, 1, 2, 2, 0, 2};
+
+    /**
+     * @brief Record format of one page
+     * 
+     */
+    struct TelemetryPageFormat
+    {
+        TelemetryPageHeader header;
+        bool is_compact = {false};
+        uint8_t page = {0};                                     //Page of the format, 0 if none is loaded
+        size_t recordSize = {sizeof(LegacyTelemetryRecord)};    //Size of one record in this page
+        uint32_t firstRecordAddress = {ADDRESS_FIRST_TELEM_01};
+        bool is_uptimeOfThisBoot = {false};                     //Page begun in this boot, so an uptime base can be converted
+    };
 
     /**
      * @brief a struct for storing the sensor data for telemetry
@@ -42,7 +65,9 @@
         float deflection2 = {0.0};
         float pressure = {0.0};
         float picTemp = {0.0};
-        //uint32_t timestamp = {0};
+        uint32_t timestamp = {0};   //Unix time in s (UTC), 0 if unknown. Only saved by saveTelemetry if is_timeSynchronized is set
+        uint32_t sequence = {0};    //Monotonic sequence number over reboots, set by saveTelemetry
+        bool is_timeSynchronized = {false}; //false if timestamp is the uptime in s, as the clock was not synchronized
         char deviceID[SIZE_DEVICE_ID] = {0};
         uint8_t crcValue = {0};
 
@@ -95,7 +120,136 @@
             uint32_t currentReadAddress;
             volatile bool is_allExtracted;
             uint32_t numSavedTelem;
-            size_t sizeTelem;
+
+            //Cached write cursor, so saveTelemetry does not have to read the page flag and the last telemetry address from the EEPROM
+            uint8_t cachedPage[2];
+            EEPROM_address cachedLastTelemAddress;
+            bool is_cursorCached;
+            bool is_savedFlagSet;
+
+            //Last telemetry address, which is not yet written to the EEPROM, as its data is still in the write buffer
+            EEPROM_address pendingLastTelemAddress;
+            uint32_t pendingLastTelemAddressLocation;
+            bool is_lastTelemAddressPending;
+
+            //Read cursor of the batch reader, set by initTelemAddresses. It has its own record format,
+            //as saveTelemetry may begin the next page while the read page is extracted
+            uint8_t readPage[2];
+            EEPROM_address readLastTelemAddress;
+            TelemetryPageFormat readFormat;
+
+            //Record format for new pages
+            bool is_compactFormat;
+            uint8_t channelMask;
+            uint8_t fixedMask;
+            uint8_t channelDecimals[TELEM_NUM_CHANNELS];
+
+            //Record format of the page saveTelemetry writes to
+            TelemetryPageFormat writeFormat;
+
+            //Next sequence number and the reserved sequence numbers on the EEPROM
+            uint32_t nextSequence;
+            uint32_t reservedSequence;
+            bool is_sequenceLoaded;
+
+            /**
+             * @brief Get the next free sequence number. At the first call after a reboot, the reserved sequence numbers
+             * are read from the EEPROM and a new block is reserved, so sequence numbers stay monotonic over reboots
+             * 
+             * @return uint32_t 
+             */
+            uint32_t getNextSequence();
+
+            /**
+             * @brief Mark a sequence number as used. If the reserved block is used up, the next block of
+             * SEQUENCE_RESERVE_BLOCK numbers is reserved on the EEPROM
+             * 
+             * @param _sequence sequence number of the saved telemetry
+             */
+            void useSequence(uint32_t _sequence);
+
+            /**
+             * @brief Write the current page header to the EEPROM
+             * 
+             * @return true if writing was successfull,
+             * @return false if not
+             */
+            bool writePageHeader();
+
+            /**
+             * @brief Get the address of the first Byte after the last telemetry address of a page
+             * 
+             * @param _page page number, beginning with 1
+             * @return uint32_t 
+             */
+            uint32_t getPageDataAddress(uint8_t _page);
+
+            /**
+             * @brief Get the address behind the last Byte for telemetry data of a page.
+             * The last page ends before the configuration area
+             * 
+             * @param _page page number, beginning with 1
+             * @return uint32_t 
+             */
+            uint32_t getPageEndAddress(uint8_t _page);
+
+
+            /**
+             * @brief Read the page header and set the record format of the page.
+             * Pages without a valid header are read in the legacy format
+             * 
+             * @param _page page number, beginning with 1
+             * @param _format[out] record format of the page
+             */
+            void loadPageFormat(uint8_t _page, TelemetryPageFormat &_format);
+
+            /**
+             * @brief Begin a new page. In the compact format the page header is written.
+             * 
+             * @param _page page number, beginning with 1
+             * @param _telemetry first telemetry of the page, its device ID is saved in the header
+             * @return uint32_t address of the first record of the page
+             */
+            uint32_t beginPage(uint8_t _page, const TelemetryData &_telemetry);
+
+            /**
+             * @brief Decode one record of a page
+             * 
+             * @param _format record format of the page
+             * @param _record record which has been read from _address
+             * @param _address address of the record, which defines its sequence number in the compact format
+             * @return true if the record is correct,
+             * @return false if it is currupted
+             */
+            bool decodeRecord(const TelemetryPageFormat &_format, const uint8_t *_record, uint32_t _address, TelemetryData &_savedTelemetry);
+
+            /**
+             * @brief Take over the time base, which saveTelemetry may have set after the read page has been loaded
+             * 
+             */
+            void refreshReadFormat();
+
+            /**
+             * @brief Read and decode one record of the read page
+             * 
+             * @return true if the record is correct,
+             * @return false if it is currupted
+             */
+            bool readRecord(uint32_t _address, TelemetryData &_savedTelemetry);
+
+            /**
+             * @brief Write the pending last telemetry address to the EEPROM
+             * 
+             * @return true if writing was successfull,
+             * @return false if not and the addresses had to be moved to the beginning of the next page
+             */
+            bool commitLastTelemAddress();
+
+            /**
+             * @brief Invalidate the cached write cursor, so it is read from the EEPROM again
+             * 
+             */
+            void invalidateCursorCache();
         
         public:
             TempTelemetry(TelemetryData &telem);
@@ -151,12 +305,40 @@
             uint32_t calcNumSavedTelem(uint32_t _firstTelemAddress, uint32_t _lastTelemAddress);
 
             /**
-             * @brief Save telemetry data to the external EEPROM
+             * @brief Save telemetry data to the external EEPROM. Its timestamp is only saved, if the caller set it
+             * together with is_timeSynchronized as Unix time. Else TelemetryClock.now() is saved, or the uptime
+             * if the clock is not synchronized yet. The timestamp of the caller is not changed, only its sequence number
+             * is set to the next one. Timestamps and sequence numbers are only saved in the compact format.
              * 
              * @param telemetry which should be written
              */
             void saveTelemetry(TelemetryData &telemetry);
 
+            /**
+             * @brief Save new pages in the compact format. The device ID and a base timestamp are saved once per page,
+             * every record contains a delta timestamp and the channels of _channelMask. 
+             * Pages which are already in use keep their format.
+             * 
+             * @param _channelMask bit i set if channel i (temp1, temp2, deflection, deflection2, pressure, picTemp) should be saved
+             * @param _fixedMask bit i set if channel i should be saved as int16 fixed point value, else as float
+             * @param _decimals number of decimals of every fixed point channel, max TELEM_MAX_DECIMALS
+             */
+            void setCompactFormat(uint8_t _channelMask, uint8_t _fixedMask, const uint8_t (&_decimals)[TELEM_NUM_CHANNELS]);
+
+            /**
+             * @brief Save new pages in the legacy format, where every record contains the whole TelemetryData
+             * 
+             */
+            void setLegacyFormat();
+
+            /**
+             * @brief Write every buffered telemetry data and the corresponding last telemetry address to the EEPROM.
+             * saveTelemetry gathers consecutive telemetry data into full EEPROM pages, so call this before
+             * going to sleep or powering down.
+             * 
+             */
+            void flushTelemetry();
+
             /**
              * @brief Extract telemetry data from external EEPROM
              * 
@@ -178,6 +360,26 @@
             */
             bool extractOnlyTelemetry(uint32_t _lastTelemAddress, TelemetryData &_savedTelemetry);
 
+            /**
+             * @brief Extract up to _maxCount telemetry data sets from the external EEPROM with one SPI transaction.
+             * initTelemAddresses has to be called once before. The read cursor is kept in RAM, so following calls
+             * continue where the last one stopped. Currupted sets are dropped, so the buffer only contains valid data.
+             * If the last saved set has been extracted, the page value and the last telemetry address are updated.
+             * 
+             * @param _savedTelemetry[out] array the telemetry data is copied to
+             * @param _maxCount number of elements in _savedTelemetry
+             * @param _numCurrupted[out] number of sets which have been dropped because of a wrong CRC
+             * @return uint16_t number of valid telemetry data sets in _savedTelemetry
+             */
+            uint16_t extractTelemetryBatch(TelemetryData *_savedTelemetry, uint16_t _maxCount, uint16_t &_numCurrupted);
+
+            /**
+             * @brief Get the number of saved telemetry sets, which have not yet been extracted by extractTelemetryBatch
+             * 
+             * @return uint32_t 
+             */
+            uint32_t getNumRemainingTelem();
+
             /**
              * @brief Checks if every saved telemtry set(s) have been extracted from EEPROM
              * 
@@ -0,0 +1,275 @@
+/**
+ * @file TransmitScheduler.cpp
+ * @brief TransmitScheduler member function definitions
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#if defined (DXCORE)
+
+#include "TransmitScheduler.h"
+
+TransmitScheduler::TransmitScheduler(ConnectionManager* connection, SequansModem* modem, MQTTClient* client, MQTTBatch* batch,
+    TempTelemetry* telemetry, TelemetryFormatter formatter)
+{
+    _connection = connection;
+    _modem = modem;
+    _client = client;
+    _batch = batch;
+    _telemetry = telemetry;
+    _formatter = formatter;
+}
+
+void TransmitScheduler::begin(uint32_t interval, TransmitPowerSave mode){
+    interval_s = interval;
+    powerSave = mode;
+    is_powerSaveConfigured = false;
+    is_powerSaveRequested = false;
+    is_enabled = true;
+    //The first window synchronizes the clock and requests the power saving mode
+    is_requested = true;
+    state = TRANSMIT_SLEEPING;
+}
+
+void TransmitScheduler::requestWindow(){
+    is_requested = true;
+}
+
+bool TransmitScheduler::windowDue(){
+    if (nextWindowEpoch != 0 && TelemetryClock.isSynchronized())
+    {
+        return TelemetryClock.now() >= nextWindowEpoch;
+    }
+    return millis() - lastWindow >= interval_s * 1000UL;
+}
+
+void TransmitScheduler::scheduleNextWindow(){
+    lastWindow = windowStart;
+    if (TelemetryClock.isSynchronized())
+    {
+        //Aligned to the interval, so the windows do not drift with the duration of the connection
+        nextWindowEpoch = (TelemetryClock.now() / interval_s + 1) * interval_s;
+    }else{
+        nextWindowEpoch = {0};
+    }
+}
+
+void TransmitScheduler::startWindow(){
+    is_requested = false;
+    windowStart = millis();
+    _connection->begin();
+    state = TRANSMIT_CONNECTING;
+}
+
+void TransmitScheduler::endWindow(){
+    //Samples which are not yet published are kept by the outbox
+    _batch->flush();
+    _connection->end();
+    if (powerSave == TRANSMIT_POWER_OFF || !is_powerSaveConfigured)
+    {
+        _modem->end();
+    }
+    //In PSM or eDRX the modem stays registered and sleeps by itself after the active time
+    scheduleNextWindow();
+    state = TRANSMIT_SLEEPING;
+}
+
+void TransmitScheduler::configurePowerSave(){
+    if (powerSave == TRANSMIT_POWER_OFF)
+    {
+        is_powerSaveConfigured = true;
+        return;
+    }
+    uint32_t periodicTau_s = {0};
+    uint32_t activeTime_s = {0};
+    if (powerSave == TRANSMIT_POWER_PSM)
+    {
+        //A tracking area update between two windows would wake up the modem in vain
+        if (_modem->setPowerSaveMode(true, interval_s * 2, TRANSMIT_PSM_ACTIVE_TIME_S)
+            && _modem->getPowerSaveTimers(periodicTau_s, activeTime_s))
+        {
+            //The network may grant other timers than requested. A shorter TAU wakes the modem between the windows,
+            //a longer active time keeps it awake after them
+            if (periodicTau_s >= interval_s * 2 && activeTime_s <= TRANSMIT_PSM_ACTIVE_TIME_S)
+            {
+                is_powerSaveConfigured = true;
+                return;
+            }
+            Serial3.print(F("[WARNING]: PSM granted with other timers, TAU s: "));
+            Serial3.print(periodicTau_s);
+            Serial3.print(F(", active time s: "));
+            Serial3.println(activeTime_s);
+        }
+    }else if (_modem->setEDRX(true) && _modem->isEDRXGranted())
+    {
+        is_powerSaveConfigured = true;
+        return;
+    }
+    //The network evaluates the request with the next attach, so only the second refusal counts
+    if (!is_powerSaveRequested)
+    {
+        is_powerSaveRequested = true;
+        Serial3.println(F("[WARNING]: Power saving mode requested, modem is switched off till it is granted"));
+        return;
+    }
+    Serial3.println(F("[WARNING]: Power saving mode not granted by the network, modem is switched off between windows"));
+    powerSave = TRANSMIT_POWER_OFF;
+    is_powerSaveConfigured = true;
+}
+
+void TransmitScheduler::synchronizeClock(){
+    int year, month, day, hour, minute, second;
+    float timezone;
+    if (_modem->getNetworkTime(&year, &month, &day, &hour, &minute, &second, &timezone))
+    {
+        TelemetryClock.setNetworkTime(year, month, day, hour, minute, second, timezone);
+    }
+}
+
+bool TransmitScheduler::sendSavedTelemetry(){
+    TelemetryData telemetry[TRANSMIT_EXTRACT_BATCH];
+    uint16_t numCorrupted = {0};
+    uint16_t count = _telemetry->extractTelemetryBatch(telemetry, TRANSMIT_EXTRACT_BATCH, numCorrupted);
+    char json[TRANSMIT_SAMPLE_SIZE];
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (_formatter(telemetry[i], json, sizeof(json)) == 0)
+        {
+            Serial3.println(F("[ERROR]: Telemetry does not fit into the JSON buffer"));
+            continue;
+        }
+        _batch->add(json);
+    }
+    return _telemetry->getNumRemainingTelem() == 0;
+}
+
+TransmitState TransmitScheduler::process(){
+    if (!is_enabled)
+    {
+        return state;
+    }
+    switch (state)
+    {
+    case TRANSMIT_SLEEPING:
+        if (is_requested || windowDue())
+        {
+            startWindow();
+        }
+        break;
+
+    case TRANSMIT_CONNECTING:
+        if (_connection->process() == CONNECTION_CONNECTED)
+        {
+            if (!is_powerSaveConfigured)
+            {
+                configurePowerSave();
+            }
+            synchronizeClock();
+            if (_telemetry->checkForNewSavedTelem() && _telemetry->initTelemAddresses(currentPage, lastTelemAddress))
+            {
+                state = TRANSMIT_SENDING;
+            }else{
+                state = TRANSMIT_DRAINING;
+            }
+        }else if (millis() - windowStart >= TRANSMIT_WINDOW_TIMEOUT_MS)
+        {
+            Serial3.println(F("[WARNING]: No connection in the transmit window, telemetry is sent in the next one"));
+            endWindow();
+        }
+        break;
+
+    case TRANSMIT_SENDING:
+        //Not bound to the window timeout, as extracted telemetry is only kept by the batch and the outbox
+        if (sendSavedTelemetry())
+        {
+            _batch->flush();
+            state = TRANSMIT_DRAINING;
+        }
+        break;
+
+    case TRANSMIT_DRAINING:
+        _connection->process();
+        if (_client->getOutboxCount() == 0 || !_connection->isConnected()
+            || millis() - windowStart >= TRANSMIT_WINDOW_TIMEOUT_MS)
+        {
+            endWindow();
+        }else if (_client->drainOutbox(1) == 0)
+        {
+            //Broker did not acknowledge, the message is retried in the next window
+            endWindow();
+        }
+        break;
+    }
+    return state;
+}
+
+uint32_t TransmitScheduler::getSecondsToNextWindow(){
+    if (state != TRANSMIT_SLEEPING || is_requested || windowDue())
+    {
+        return 0;
+    }
+    if (nextWindowEpoch != 0 && TelemetryClock.isSynchronized())
+    {
+        return nextWindowEpoch - TelemetryClock.now();
+    }
+    return (interval_s * 1000UL - (millis() - lastWindow)) / 1000;
+}
+
+TransmitState TransmitScheduler::getState(){
+    return state;
+}
+
+TransmitPowerSave TransmitScheduler::getPowerSave(){
+    return powerSave;
+}
+
+/**
+ * @brief Appends ,"key":value to a JSON object, null if the value is NaN or out of range
+ *
+ * @return false if the buffer is too small
+ */
+static bool appendJsonFloat(char *json, size_t size, size_t &length, const char *key, float value){
+    char number[16] = "null";
+    //dtostrf writes every digit, so the range is limited to the size of the buffer
+    if (!isnan(value) && fabs(value) < 1e9)
+    {
+        dtostrf(value, 1, 2, number);
+    }
+    int written = snprintf(&json[length], size - length, ",\"%s\":%s", key, number);
+    if (written < 0 || (size_t)written >= size - length)
+    {
+        return false;
+    }
+    length += written;
+    return true;
+}
+
+size_t TransmitScheduler::formatTelemetryJson(const TelemetryData &telemetry, char *json, size_t size){
+    //Timestamps of an unsynchronized clock are the uptime, so they are not sent as Unix time
+    bool is_uptime = !telemetry.is_timeSynchronized && telemetry.timestamp != 0;
+    int written = snprintf(json, size, is_uptime ? "{\"seq\":%lu,\"uptime\":%lu" : "{\"seq\":%lu,\"ts\":%lu",
+        (unsigned long)telemetry.sequence, (unsigned long)telemetry.timestamp);
+    if (written < 0 || (size_t)written >= size)
+    {
+        return 0;
+    }
+    size_t length = written;
+    if (!appendJsonFloat(json, size, length, "temp1", telemetry.temp1)
+        || !appendJsonFloat(json, size, length, "temp2", telemetry.temp2)
+        || !appendJsonFloat(json, size, length, "deflection", telemetry.deflection)
+        || !appendJsonFloat(json, size, length, "deflection2", telemetry.deflection2)
+        || !appendJsonFloat(json, size, length, "pressure", telemetry.pressure)
+        || !appendJsonFloat(json, size, length, "picTemp", telemetry.picTemp)
+        || length + 2 > size)
+    {
+        return 0;
+    }
+    json[length++] = '}';
+    json[length] = '\0';
+    return length;
+}
+
+#endif
@@ -0,0 +1,192 @@
+/**
+ * @file TransmitScheduler.h
+ * @brief Transmits the telemetry saved on the external EEPROM in aligned windows over the cellular connection
+ * and lets the modem sleep in between
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * Sampling keeps saving telemetry with TempTelemetry::saveTelemetry. The modem is only woken up at the beginning
+ * of a transmit window, which is aligned to a multiple of the transmit interval of the TelemetryClock, or earlier
+ * if requestWindow() is called. In the window the saved sets are extracted, published as MQTTBatch
+ * messages and the outbox of the MQTTClient is drained. Afterwards the MQTT session is closed and the modem
+ * enters PSM or eDRX, if the network granted it, else the modem is switched off till the next window.
+ *
+ * Example:
+ *      TransmitScheduler scheduler(&connection, &modem, &client, &batch, &tempTelemetry);
+ *      scheduler.begin(900, TRANSMIT_POWER_PSM);
+ *      loop(){
+ *          tempTelemetry.saveTelemetry(telemetry);
+ *          scheduler.process();
+ *      }
+ *
+ */
+#if defined (DXCORE)
+#ifndef TransmitScheduler_h
+#define TransmitScheduler_h
+
+#include <Arduino.h>
+#include "ConnectionManager.h"
+#include "SequansModem.h"
+#include "MQTTClient.h"
+#include "TempTelemetry.h"
+#include "TelemetryClock.h"
+
+const uint32_t TRANSMIT_INTERVAL_DEFAULT_S = {900};      //Default time between two transmit windows
+const uint32_t TRANSMIT_WINDOW_TIMEOUT_MS = {300000};    //Max time the modem is awake in one window
+const uint8_t TRANSMIT_EXTRACT_BATCH = {4};              //Telemetry sets extracted from the EEPROM per call of process()
+const uint32_t TRANSMIT_PSM_ACTIVE_TIME_S = {10};        //Time the modem stays reachable after a window before it sleeps, multiple of 2s
+const uint8_t TRANSMIT_SAMPLE_SIZE = {160};              //Max length of one telemetry set as JSON
+
+/**
+ * @brief How the modem saves power between two windows
+ *
+ */
+enum TransmitPowerSave {
+  TRANSMIT_POWER_OFF,   //Modem switched off, it has to register again in every window
+  TRANSMIT_POWER_PSM,   //Power saving mode, the modem stays registered but is not reachable
+  TRANSMIT_POWER_EDRX,  //Extended discontinuous reception, the modem stays reachable with a long paging cycle
+};
+
+enum TransmitState {
+  TRANSMIT_SLEEPING,    //Waiting for the next window
+  TRANSMIT_CONNECTING,  //Window started, waiting for the MQTT session
+  TRANSMIT_SENDING,     //Extracting the saved telemetry and publishing it
+  TRANSMIT_DRAINING,    //Publishing the messages of the outbox
+};
+
+/**
+ * @brief Formats one telemetry set as JSON object for MQTTBatch::add
+ *
+ * @return Length of the JSON object, 0 if it did not fit into the buffer
+ */
+typedef size_t (*TelemetryFormatter)(const TelemetryData &telemetry, char *json, size_t size);
+
+class TransmitScheduler
+{
+private:
+    ConnectionManager* _connection;
+    SequansModem* _modem;
+    MQTTClient* _client;
+    MQTTBatch* _batch;
+    TempTelemetry* _telemetry;
+    TelemetryFormatter _formatter;
+    TransmitState state = {TRANSMIT_SLEEPING};
+    TransmitPowerSave powerSave = {TRANSMIT_POWER_PSM};
+    uint32_t interval_s = {TRANSMIT_INTERVAL_DEFAULT_S};
+    uint32_t nextWindowEpoch = {0};     //Begin of the next window in TelemetryClock time, 0 if the clock is not synchronized
+    unsigned long lastWindow = {0};     //millis() of the begin of the last window, used without synchronized clock
+    unsigned long windowStart = {0};
+    uint8_t currentPage[2] = {0};       //Read position of the telemetry on the EEPROM
+    EEPROM_address lastTelemAddress;
+    bool is_powerSaveConfigured = {false};   //PSM or eDRX granted, or given up
+    bool is_powerSaveRequested = {false};
+    bool is_requested = {false};
+    bool is_enabled = {false};
+
+    /**
+     * @return true if the next window is due
+     */
+    bool windowDue();
+
+    /**
+     * @brief Calculates the begin of the next window from the current time
+     *
+     */
+    void scheduleNextWindow();
+
+    /**
+     * @brief Wakes up the modem and starts connecting
+     *
+     */
+    void startWindow();
+
+    /**
+     * @brief Closes the MQTT session, lets the modem sleep and schedules the next window
+     *
+     */
+    void endWindow();
+
+    /**
+     * @brief Requests PSM or eDRX and falls back to switching off the modem, if the network did not grant it
+     * or granted PSM timers, which are shorter (TAU) or longer (active time) than requested
+     *
+     */
+    void configurePowerSave();
+
+    /**
+     * @brief Synchronizes the TelemetryClock with the network time of the modem
+     *
+     */
+    void synchronizeClock();
+
+    /**
+     * @brief Extracts up to TRANSMIT_EXTRACT_BATCH telemetry sets and adds them to the batch
+     *
+     * @return true if every saved set has been extracted
+     */
+    bool sendSavedTelemetry();
+
+public:
+    /**
+     * @brief Construct a new TransmitScheduler object
+     *
+     * @param connection connection manager of the modem and the client, it is started and stopped by the scheduler
+     * @param modem
+     * @param client MQTT client with the outbox
+     * @param batch batch with the telemetry topic, its maxSamples should be 0, so it is only published when full
+     * @param telemetry telemetry on the external EEPROM
+     * @param formatter formats one telemetry set as JSON object
+     */
+    TransmitScheduler(ConnectionManager* connection, SequansModem* modem, MQTTClient* client, MQTTBatch* batch,
+        TempTelemetry* telemetry, TelemetryFormatter formatter = formatTelemetryJson);
+
+    /**
+     * @brief Starts the scheduler, the first window begins with the next call of process()
+     *
+     * @param interval time between two windows in s
+     * @param mode how the modem saves power between two windows
+     */
+    void begin(uint32_t interval = TRANSMIT_INTERVAL_DEFAULT_S, TransmitPowerSave mode = TRANSMIT_POWER_PSM);
+
+    /**
+     * @brief Executes the next step of the current window or starts a window, if it is due.
+     * Has to be called cyclically in the main loop, blocks at most as long as ConnectionManager::process()
+     * or the publishing of one message
+     *
+     * @return TransmitState after this call
+     */
+    TransmitState process();
+
+    /**
+     * @brief Starts a window with the next call of process(), e.g. for an alarm
+     *
+     */
+    void requestWindow();
+
+    /**
+     * @return Time till the next window in s, 0 if it is due or running
+     */
+    uint32_t getSecondsToNextWindow();
+
+    /**
+     * @return Current state
+     */
+    TransmitState getState();
+
+    /**
+     * @return Power save mode which is used, TRANSMIT_POWER_OFF if the network did not grant the requested one
+     */
+    TransmitPowerSave getPowerSave();
+
+    /**
+     * @brief Default formatter, e.g. {"seq":12,"ts":1700000000,"temp1":21.50,...}. Values which are NaN are null.
+     * Timestamps of an unsynchronized clock are sent as "uptime" in s instead of "ts".
+     *
+     */
+    static size_t formatTelemetryJson(const TelemetryData &telemetry, char *json, size_t size);
+};
+
+#endif
+#endif
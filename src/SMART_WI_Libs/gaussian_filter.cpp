@@ -1,5 +1,6 @@
 #include "gaussian_filter.h"
 #include "SerialMon.h"
+#include "gaussian_kernel_cache.h"
 
 /*Source file wich contains the functions for gaussian filtering
 Created by Csaba Freiberger 03.2023*/
@@ -80,6 +81,12 @@ void GaussianFilter::calcGaussianKernel(float sigma, uint8_t _kernel_width) {
     {
         kernel[x] = kernel_values[x - kernel_radius - 1];
     }
+
+    //kernel_values and kernel_q15 share their memory, so the Q15 kernel is converted again
+    if (is_fixedPoint)
+    {
+        is_fixedPoint = updateFixedPointKernel();
+    }
 }
 
 bool GaussianFilter::getGaussianKernel(float sigma, uint8_t _kernel_width) {
@@ -96,6 +103,19 @@ bool GaussianFilter::getGaussianKernel(float sigma, uint8_t _kernel_width) {
     }
 }
 
+bool GaussianFilter::getCachedKernel(float sigma, uint8_t _kernel_width) {
+    if (!GaussianKernels.getKernel(sigma, _kernel_width, kernel, kernel_width))
+    {
+        return false;
+    }
+    kernel_radius = (kernel_width - 1) / 2;
+    if (is_fixedPoint)
+    {
+        is_fixedPoint = updateFixedPointKernel();
+    }
+    return true;
+}
+
 void GaussianFilter::convolve1D(float _input[MAX_SENSOR_ARRAY_SIZE], float _kernel[MAX_KERNEL_SIZE], uint8_t input_width, uint8_t _kernel_width)//(input, sigma)
 {
     /*Extend input_new array, with values in a way so the output have the size of the original input*/
@@ -159,3 +179,353 @@ bool GaussianFilter::calcGausianFilter1D(float _input[MAX_SENSOR_ARRAY_SIZE], fl
     
 }
 
+
+bool GaussianFilter::updateFixedPointKernel() {
+    //The sum of the taps has to be <= 1, so the 32 bit sum of the products can not overflow
+    float sum = 0.0F;
+    for (uint8_t k = {0}; k < kernel_width; k++)
+    {
+        if (kernel[k] < 0.0F || kernel[k] >= 1.0F)
+        {
+            SerialMon.println("The kernel can not be represented in Q15! Use a normalized kernel (getCachedKernel)");
+            return false;
+        }
+        sum += kernel[k];
+    }
+    if (sum > 1.001F)
+    {
+        SerialMon.println("The kernel can not be represented in Q15! Use a normalized kernel (getCachedKernel)");
+        return false;
+    }
+    for (uint8_t k = {0}; k < kernel_width; k++)
+    {
+        int32_t value = (int32_t)(kernel[k] * Q15_ONE + 0.5F);
+        kernel_q15[k] = (value > INT16_MAX) ? INT16_MAX : value;
+    }
+    return true;
+}
+
+bool GaussianFilter::setFixedPoint(bool _is_fixedPoint) {
+    if (!_is_fixedPoint)
+    {
+        is_fixedPoint = false;
+        return true;
+    }
+    is_fixedPoint = updateFixedPointKernel();
+    return is_fixedPoint;
+}
+
+bool GaussianFilter::isFixedPoint() {
+    return is_fixedPoint;
+}
+
+void GaussianFilter::convolve1DFixedPoint(const int16_t _input[MAX_SENSOR_ARRAY_SIZE], int16_t _output[MAX_SENSOR_ARRAY_SIZE], uint8_t input_width) {
+    uint8_t radius = kernel_width / 2;
+    uint8_t input_new_width = input_width + 2 * radius;
+
+    //Extend the input with mirrored values at the beginning and at the end like convolve1D
+    for (uint8_t i = {0}; i < input_width; i++)
+    {
+        input_new_q15[radius + i] = _input[i];
+    }
+    for (uint8_t i = {0}; i < radius; i++)
+    {
+        input_new_q15[radius - i - 1] = _input[i];
+        input_new_q15[input_new_width - radius + i] = _input[input_width - i - 1];
+    }
+
+    for (uint8_t j = {0}; j < input_width; j++)
+    {
+        //16 x 16 bit products in a 32 bit sum, it can not overflow as the sum of the kernel is <= 1
+        int32_t res = {0};
+        const int16_t *in = &input_new_q15[j];
+        for (uint8_t k = {0}; k < kernel_width; k++)
+        {
+            res += (int32_t)in[k] * kernel_q15[k];
+        }
+        //Round from Q15 and saturate to 16 bit
+        res = (res + (Q15_ONE >> 1)) >> 15;
+        if (res > INT16_MAX)
+        {
+            res = INT16_MAX;
+        }
+        else if (res < INT16_MIN)
+        {
+            res = INT16_MIN;
+        }
+        _output[j] = res;
+    }
+}
+
+bool GaussianFilter::calcGausianFilter1D(const int16_t _input[MAX_SENSOR_ARRAY_SIZE], int16_t _output[MAX_SENSOR_ARRAY_SIZE], uint8_t input_width) {
+    if (input_width > MAX_SENSOR_ARRAY_SIZE || input_width <= kernel_width / 2)
+    {
+        SerialMon.print("input size is to big or smaller than the kernel radius! Tha max size is: ");
+        SerialMon.println(MAX_SENSOR_ARRAY_SIZE);
+        return false;
+    }
+    if (is_fixedPoint)
+    {
+        convolve1DFixedPoint(_input, _output, input_width);
+        return true;
+    }
+
+    float input[MAX_SENSOR_ARRAY_SIZE];
+    for (uint8_t i = {0}; i < input_width; i++)
+    {
+        input[i] = _input[i];
+    }
+    kernel_radius = kernel_width / 2;
+    this->convolve1D(input, kernel, input_width, kernel_width);
+    for (uint8_t i = {0}; i < input_width; i++)
+    {
+        float value = output[i] < 0.0F ? output[i] - 0.5F : output[i] + 0.5F;
+        _output[i] = constrain(value, (float)INT16_MIN, (float)INT16_MAX);
+    }
+    return true;
+}
+
+GaussianStreamFilter::GaussianStreamFilter()
+{
+    for (uint8_t i = 0; i < MAX_KERNEL_SIZE; i++)
+    {
+        kernel[i] = 0.0F;
+    }
+    for (uint8_t i = 0; i < 2 * MAX_KERNEL_SIZE; i++)
+    {
+        stream_window[i] = 0.0F;
+    }
+}
+
+bool GaussianStreamFilter::getCachedKernel(float sigma, uint8_t _kernel_width) {
+    if (!GaussianKernels.getKernel(sigma, _kernel_width, kernel, kernel_width))
+    {
+        return false;
+    }
+    beginStream();
+    return true;
+}
+
+bool GaussianStreamFilter::setKernel(const float _kernel[MAX_KERNEL_SIZE], uint8_t _kernel_width) {
+    if (_kernel_width > MAX_KERNEL_SIZE || _kernel_width % 2 == 0)
+    {
+        SerialMon.print("The kernel size has to be odd and the max size is: ");
+        SerialMon.println(MAX_KERNEL_SIZE);
+        return false;
+    }
+    for (uint8_t i = {0}; i < _kernel_width; i++)
+    {
+        kernel[i] = _kernel[i];
+    }
+    kernel_width = _kernel_width;
+    beginStream();
+    return true;
+}
+
+void GaussianStreamFilter::beginStream() {
+    stream_width = kernel_width;
+    stream_head = {0};
+    stream_count = {0};
+    stream_next_output = {0};
+    for (uint8_t i = {0}; i < 2 * MAX_KERNEL_SIZE; i++)
+    {
+        stream_window[i] = 0.0F;
+    }
+}
+
+void GaussianStreamFilter::reset() {
+    beginStream();
+}
+
+float GaussianStreamFilter::getStreamSample(int32_t index, uint32_t input_width) {
+    //Mirror the samples at the beginning and at the end of the stream like convolve1D
+    if (index < 0)
+    {
+        index = -index - 1;
+    }
+    else if ((uint32_t)index >= input_width)
+    {
+        index = 2 * (int32_t)input_width - 1 - index;
+    }
+    //Streams shorter than the kernel radius can not be mirrored completely
+    int32_t oldest = (int32_t)stream_count - stream_width;
+    if (index < oldest)
+    {
+        index = oldest;
+    }
+    if (index < 0)
+    {
+        index = {0};
+    }
+    if ((uint32_t)index >= stream_count)
+    {
+        index = stream_count - 1;
+    }
+    return stream_window[index % stream_width];
+}
+
+float GaussianStreamFilter::convolveStreamEdge(uint32_t center, uint32_t input_width) {
+    uint8_t radius = stream_width / 2;
+    float res = 0.0F;
+    for (uint8_t k = {0}; k < stream_width; k++)
+    {
+        res += getStreamSample((int32_t)center - radius + k, input_width) * kernel[k];
+    }
+    return res;
+}
+
+bool GaussianStreamFilter::filterSample(float _sample, float &_filtered) {
+    //Invalid samples are ignored like in the other streaming filters
+    if (stream_width == 0 || isnan(_sample))
+    {
+        return false;
+    }
+    //Save the sample twice, so the last stream_width samples are at stream_window[stream_head..stream_head+stream_width-1]
+    stream_window[stream_head] = _sample;
+    stream_window[stream_head + stream_width] = _sample;
+    stream_head++;
+    if (stream_head >= stream_width)
+    {
+        stream_head = {0};
+    }
+    stream_count++;
+
+    uint8_t radius = stream_width / 2;
+    if (stream_count <= radius)
+    {
+        return false;
+    }
+
+    if (stream_count < stream_width)
+    {
+        //Beginning of the stream, the missing samples are mirrored
+        _filtered = convolveStreamEdge(stream_next_output, UINT32_MAX);
+    }
+    else
+    {
+        //The kernel is symmetric, so the samples with the same distance to the center are added before the multiplication
+        const float *first = &stream_window[stream_head];
+        const float *last = first + stream_width - 1;
+        float res = kernel[radius] * first[radius];
+        for (uint8_t k = {0}; k < radius; k++)
+        {
+            res += kernel[k] * (*first++ + *last--);
+        }
+        _filtered = res;
+    }
+    stream_next_output++;
+    return true;
+}
+
+bool GaussianStreamFilter::flushStream(float &_filtered) {
+    if (stream_width == 0 || stream_next_output >= stream_count)
+    {
+        return false;
+    }
+    //End of the stream, the following samples are mirrored
+    _filtered = convolveStreamEdge(stream_next_output, stream_count);
+    stream_next_output++;
+    return true;
+}
+
+MultiChannelGaussianFilter::MultiChannelGaussianFilter()
+{
+    for (uint8_t i = 0; i < MAX_KERNEL_SIZE; i++)
+    {
+        kernel[i] = 0.0F;
+    }
+    for (uint8_t i = 0; i < MAX_SENSOR_NEW_ARRAY_SIZE; i++)
+    {
+        input_new[i] = 0.0F;
+    }
+    for (uint8_t i = 0; i < MAX_SENSOR_ARRAY_SIZE; i++)
+    {
+        output[i] = 0.0F;
+    }
+}
+
+bool MultiChannelGaussianFilter::getCachedKernel(float sigma, uint8_t _kernel_width) {
+    return GaussianKernels.getKernel(sigma, _kernel_width, kernel, kernel_width);
+}
+
+bool MultiChannelGaussianFilter::setKernel(const float _kernel[MAX_KERNEL_SIZE], uint8_t _kernel_width) {
+    if (_kernel_width > MAX_KERNEL_SIZE || _kernel_width % 2 == 0)
+    {
+        SerialMon.print("The kernel size has to be odd and the max size is: ");
+        SerialMon.println(MAX_KERNEL_SIZE);
+        return false;
+    }
+    for (uint8_t i = {0}; i < _kernel_width; i++)
+    {
+        kernel[i] = _kernel[i];
+    }
+    kernel_width = _kernel_width;
+    return true;
+}
+
+void MultiChannelGaussianFilter::convolveChannel(float *_data, uint8_t input_width, uint8_t _stride) {
+    uint8_t kernel_radius = kernel_width / 2;
+    uint8_t input_new_width = input_width + 2 * kernel_radius;
+
+    //Copy the channel into the middle of input_new and mirror it at the beginning and at the end
+    for (uint8_t i = {0}; i < input_width; i++)
+    {
+        input_new[kernel_radius + i] = _data[i * _stride];
+    }
+    for (uint8_t i = {0}; i < kernel_radius; i++)
+    {
+        input_new[kernel_radius - i - 1] = input_new[kernel_radius + i];
+        input_new[input_new_width - kernel_radius + i] = input_new[input_new_width - kernel_radius - i - 1];
+    }
+
+    //The loop over the samples is the inner one, so it works on contiguous arrays and can be vectorized.
+    //The kernel is symmetric, so the samples with the same distance to the center are added before the multiplication
+    const float * __restrict in = input_new;
+    float * __restrict out = output;
+    const float center = kernel[kernel_radius];
+    for (uint8_t j = {0}; j < input_width; j++)
+    {
+        out[j] = center * in[j + kernel_radius];
+    }
+    for (uint8_t k = {0}; k < kernel_radius; k++)
+    {
+        const float weight = kernel[k];
+        const float * __restrict left = in + k;
+        const float * __restrict right = in + kernel_width - 1 - k;
+        for (uint8_t j = {0}; j < input_width; j++)
+        {
+            out[j] += weight * (left[j] + right[j]);
+        }
+    }
+
+    for (uint8_t i = {0}; i < input_width; i++)
+    {
+        _data[i * _stride] = output[i];
+    }
+}
+
+bool MultiChannelGaussianFilter::filterChannels(float _data[][MAX_SENSOR_ARRAY_SIZE], uint8_t num_channels, uint8_t input_width) {
+    if (input_width > MAX_SENSOR_ARRAY_SIZE || num_channels > MAX_FILTER_CHANNELS || kernel_width == 0)
+    {
+        SerialMon.println("Input size or number of channels is to big, or no kernel is set!");
+        return false;
+    }
+    for (uint8_t c = {0}; c < num_channels; c++)
+    {
+        convolveChannel(_data[c], input_width, 1);
+    }
+    return true;
+}
+
+bool MultiChannelGaussianFilter::filterInterleaved(float *_data, uint8_t num_channels, uint8_t input_width) {
+    if (input_width > MAX_SENSOR_ARRAY_SIZE || num_channels > MAX_FILTER_CHANNELS || kernel_width == 0)
+    {
+        SerialMon.println("Input size or number of channels is to big, or no kernel is set!");
+        return false;
+    }
+    for (uint8_t c = {0}; c < num_channels; c++)
+    {
+        convolveChannel(&_data[c], input_width, num_channels);
+    }
+    return true;
+}
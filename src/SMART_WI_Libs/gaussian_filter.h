@@ -7,6 +7,7 @@
 Created by Csaba Freiberger 03.2023*/
 
 #include "Arduino.h"
+#include "streaming_filter.h"
 //#include <cmath>
 
 //using namespace std;
@@ -15,15 +16,32 @@ Created by Csaba Freiberger 03.2023*/
 const uint8_t MAX_SENSOR_ARRAY_SIZE = {80};
 const uint8_t MAX_KERNEL_SIZE = {39};
 const uint8_t MAX_SENSOR_NEW_ARRAY_SIZE = MAX_SENSOR_ARRAY_SIZE + MAX_KERNEL_SIZE;
+const uint8_t MAX_FILTER_CHANNELS = {6};
+const int32_t Q15_ONE = {32768};       //1.0 in Q15 fixed point
 
 class GaussianFilter
 {
 private:
     /*Define global variables*/
-    //Initialise kernel array
-     float kernel_values[MAX_KERNEL_SIZE];
-     float input_new[MAX_SENSOR_NEW_ARRAY_SIZE];
+    //Initialise kernel array. The values are only needed while calcGaussianKernel is running,
+    //so the kernel of the fixed point path (Q15) shares their memory
+     union
+     {
+        float kernel_values[MAX_KERNEL_SIZE];
+        int16_t kernel_q15[MAX_KERNEL_SIZE];
+     };
+     //The fixed point path uses the same memory for the mirrored input as the float path
+     union
+     {
+        float input_new[MAX_SENSOR_NEW_ARRAY_SIZE];
+        int16_t input_new_q15[MAX_SENSOR_NEW_ARRAY_SIZE];
+     };
      uint8_t kernel_radius = 0;
+     //Fixed point path, selected per instance with setFixedPoint
+     bool is_fixedPoint = false;
+
+     bool updateFixedPointKernel();
+     void convolve1DFixedPoint(const int16_t _input[MAX_SENSOR_ARRAY_SIZE], int16_t _output[MAX_SENSOR_ARRAY_SIZE], uint8_t input_width);
 public:
     //Initialise output array
     float kernel[MAX_KERNEL_SIZE];
@@ -36,9 +54,76 @@ public:
     //static void setKernel(double _kernel[MAX_KERNEL_SIZE], uint32_t _kernel_width);
     void calcGaussianKernel(float sigma = 1.0F, uint8_t _kernel_width = MAX_KERNEL_SIZE);
     bool getGaussianKernel(float sigma = 1.0F, uint8_t _kernel_width = MAX_KERNEL_SIZE);
+    //Take over a normalized kernel from GaussianKernels, without calculating it again if it has been used before
+    bool getCachedKernel(float sigma = 1.0F, uint8_t _kernel_width = MAX_KERNEL_SIZE);
     void convolve1D(float _input[MAX_SENSOR_ARRAY_SIZE], float _kernel[MAX_KERNEL_SIZE], uint8_t input_width = MAX_SENSOR_ARRAY_SIZE, uint8_t _kernel_width = MAX_KERNEL_SIZE);
     bool calcGausianFilter1D(float _input[MAX_SENSOR_ARRAY_SIZE], float _kernel[MAX_KERNEL_SIZE], uint8_t input_width = MAX_SENSOR_ARRAY_SIZE, uint8_t _kernel_width = MAX_KERNEL_SIZE);
+
+    /*Fixed point path for integer sensor values (e.g. the 12 bit RS485 values), as the AVR has no FPU.
+    The kernel is converted to Q15 and the products are summed up in 32 bit, the result is rounded and saturated to 16 bit.*/
+    //Select the fixed point path for this instance. Returns false if the current kernel can not be represented in Q15 (tap >= 1 or sum > 1)
+    bool setFixedPoint(bool _is_fixedPoint);
+    bool isFixedPoint();
+    //Filter integer values with the current kernel, in fixed point or in float depending on setFixedPoint
+    bool calcGausianFilter1D(const int16_t _input[MAX_SENSOR_ARRAY_SIZE], int16_t _output[MAX_SENSOR_ARRAY_SIZE], uint8_t input_width = MAX_SENSOR_ARRAY_SIZE);
 };
 
+/*Streaming gaussian filter: one filtered output per new sample with O(kernel_width) cost instead of a batch convolution.
+It is a class of its own, so the window (about 0.5 KB) is only allocated if streaming is used.
+The output of a sample is delayed by the kernel radius, the edges are mirrored like in GaussianFilter::convolve1D,
+so the outputs are the same as of a batch over all samples of the stream.*/
+class GaussianStreamFilter : public StreamingFilter
+{
+private:
+    float kernel[MAX_KERNEL_SIZE];
+    uint8_t kernel_width = {0};
+    //The last kernel_width samples are stored twice, so the window is always contiguous
+    float stream_window[2 * MAX_KERNEL_SIZE];
+    uint8_t stream_head = 0;          //Position of the oldest sample in the window
+    uint8_t stream_width = 0;         //Kernel width of the running stream
+    uint32_t stream_count = 0;        //Number of samples since beginStream
+    uint32_t stream_next_output = 0;  //Index of the next sample, which gets a filtered output
+
+    float getStreamSample(int32_t index, uint32_t input_width);
+    float convolveStreamEdge(uint32_t center, uint32_t input_width);
+public:
+    GaussianStreamFilter();
 
+    //Take over a normalized kernel from GaussianKernels and start a new stream
+    bool getCachedKernel(float sigma = 1.0F, uint8_t _kernel_width = MAX_KERNEL_SIZE);
+    //Take over a kernel of odd size, e.g. GaussianFilter::kernel, and start a new stream
+    bool setKernel(const float _kernel[MAX_KERNEL_SIZE], uint8_t _kernel_width);
+    //Start a new stream with the current kernel
+    void beginStream();
+    //Add a new sample. Returns true if a filtered output is available, which belongs to the sample kernel radius before
+    bool filterSample(float _sample, float &_filtered) override;
+    //Start a new stream with the current kernel, like beginStream
+    void reset() override;
+    //Get the outputs of the last kernel radius samples at the end of the stream. Returns false if there is no output left
+    bool flushStream(float &_filtered);
+};
 
+/*Gaussian filter for several channels, which share one kernel and one scratch buffer.
+Instead of one GaussianFilter per channel (about 1.5 KB each), all channels are filtered in place
+with about 0.95 KB in total. The channels are given as struct of arrays (data[channel][sample])
+or interleaved (data[sample][channel]).*/
+class MultiChannelGaussianFilter
+{
+private:
+    float kernel[MAX_KERNEL_SIZE];
+    uint8_t kernel_width = {0};
+    float input_new[MAX_SENSOR_NEW_ARRAY_SIZE];    //Mirrored input of the channel, which is filtered at the moment
+    float output[MAX_SENSOR_ARRAY_SIZE];           //Output of the channel, which is filtered at the moment
+
+    void convolveChannel(float *_data, uint8_t input_width, uint8_t _stride);
+public:
+    MultiChannelGaussianFilter();
+
+    //Take over a normalized kernel from GaussianKernels for all channels
+    bool getCachedKernel(float sigma = 1.0F, uint8_t _kernel_width = MAX_KERNEL_SIZE);
+    //Take over a kernel of odd size, e.g. GaussianFilter::kernel
+    bool setKernel(const float _kernel[MAX_KERNEL_SIZE], uint8_t _kernel_width);
+    //Filter every channel in place, the edges are mirrored like in GaussianFilter::convolve1D
+    bool filterChannels(float _data[][MAX_SENSOR_ARRAY_SIZE], uint8_t num_channels, uint8_t input_width = MAX_SENSOR_ARRAY_SIZE);
+    bool filterInterleaved(float *_data, uint8_t num_channels, uint8_t input_width = MAX_SENSOR_ARRAY_SIZE);
+};
@@ -0,0 +1,94 @@
+#include "gaussian_kernel_cache.h"
+#include "SerialMon.h"
+
+/*Source file which contains the gaussian kernel cache
+Created 10.2026*/
+
+//Common configurations of the kits, the width covers +-3 sigma
+static constexpr GaussianKernelHalf PRESET_KERNELS[NUM_PRESET_KERNELS] PROGMEM = {
+    makeGaussianKernel(1.0F, 7),
+    makeGaussianKernel(2.0F, 13),
+    makeGaussianKernel(3.0F, 19),
+    makeGaussianKernel(6.0F, 37)
+};
+
+GaussianKernelCache &GaussianKernels = GaussianKernelCache::instance();
+
+GaussianKernelCache::GaussianKernelCache()
+{
+    for (uint8_t i = 0; i < MAX_CACHED_KERNELS; i++)
+    {
+        cached_kernels[i].sigma = 0.0F;
+        cached_kernels[i].width = {0};
+        last_use[i] = {0};
+    }
+}
+
+void GaussianKernelCache::expandKernel(const GaussianKernelHalf &_half, float (&_kernel)[MAX_KERNEL_SIZE])
+{
+    uint8_t radius = _half.width / 2;
+    for (uint8_t x = {0}; x <= radius; x++)
+    {
+        _kernel[radius - x] = _half.values[x];
+        _kernel[radius + x] = _half.values[x];
+    }
+}
+
+int8_t GaussianKernelCache::findPreset(float sigma, uint8_t _kernel_width)
+{
+    for (uint8_t i = 0; i < NUM_PRESET_KERNELS; i++)
+    {
+        if (pgm_read_float(&PRESET_KERNELS[i].sigma) == sigma && pgm_read_byte(&PRESET_KERNELS[i].width) == _kernel_width)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool GaussianKernelCache::getKernel(float sigma, uint8_t _kernel_width, float (&_kernel)[MAX_KERNEL_SIZE], uint8_t &_width_out)
+{
+    //Kernel size has to be odd like in GaussianFilter::calcGaussianKernel
+    if (_kernel_width % 2 == 0)
+    {
+        _kernel_width++;
+    }
+    if (_kernel_width > MAX_KERNEL_SIZE || sigma <= 0.0F)
+    {
+        SerialMon.print("The kernel size is too big or sigma is not positive! The max size is: ");
+        SerialMon.println(MAX_KERNEL_SIZE);
+        return false;
+    }
+    _width_out = _kernel_width;
+
+    //Kernels of the presets are read from flash
+    int8_t preset = findPreset(sigma, _kernel_width);
+    if (preset >= 0)
+    {
+        GaussianKernelHalf half;
+        memcpy_P(&half, &PRESET_KERNELS[preset], sizeof(half));
+        expandKernel(half, _kernel);
+        return true;
+    }
+
+    //Other kernels are calculated once and kept in RAM, the kernel used longest ago is replaced
+    use_counter++;
+    uint8_t oldest = {0};
+    for (uint8_t i = 0; i < MAX_CACHED_KERNELS; i++)
+    {
+        if (cached_kernels[i].width == _kernel_width && cached_kernels[i].sigma == sigma)
+        {
+            last_use[i] = use_counter;
+            expandKernel(cached_kernels[i], _kernel);
+            return true;
+        }
+        if ((uint8_t)(use_counter - last_use[i]) > (uint8_t)(use_counter - last_use[oldest]))
+        {
+            oldest = i;
+        }
+    }
+    cached_kernels[oldest] = makeGaussianKernel(sigma, _kernel_width);
+    last_use[oldest] = use_counter;
+    expandKernel(cached_kernels[oldest], _kernel);
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+/*Header for the gaussian kernel cache, which holds normalized kernels for several (sigma, width) pairs,
+so filters can switch between smoothing levels without calculating the kernel again.
+Kernels of the preset configurations are calculated at compile time and stored in flash,
+other configurations are calculated once and kept in RAM.
+Created 10.2026*/
+
+#include "Arduino.h"
+#include "gaussian_filter.h"
+
+/*Define constants*/
+const uint8_t MAX_KERNEL_RADIUS = (MAX_KERNEL_SIZE - 1) / 2;
+const uint8_t MAX_CACHED_KERNELS = {3};     //Number of kernels in RAM, which are not one of the presets
+const uint8_t NUM_PRESET_KERNELS = {4};
+
+//Normalized gaussian kernel. As the kernel is symmetric, only the center and the right half is saved
+struct GaussianKernelHalf
+{
+    float sigma;
+    uint8_t width;
+    float values[MAX_KERNEL_RADIUS + 1];    //values[0] is the center, values[i] the value in distance i
+};
+
+//Exponential function for x <= 0, which can be evaluated at compile time
+constexpr float kernelExp(float x)
+{
+    //Scale x into the range where the series converges fast, then square the result back
+    uint8_t n = {0};
+    while (x < -0.5F)
+    {
+        x /= 2.0F;
+        n++;
+    }
+    float sum = 1.0F;
+    float term = 1.0F;
+    for (uint8_t i = {1}; i < 10; i++)
+    {
+        term *= x / i;
+        sum += term;
+    }
+    for (; n > 0; n--)
+    {
+        sum *= sum;
+    }
+    return sum;
+}
+
+//Calculate a normalized gaussian kernel, at compile time for constant arguments. _width has to be odd
+constexpr GaussianKernelHalf makeGaussianKernel(float _sigma, uint8_t _width)
+{
+    GaussianKernelHalf kernel = {_sigma, _width, {0.0F}};
+    uint8_t radius = _width / 2;
+    float sum = {0.0F};
+    for (uint8_t x = {0}; x <= radius; x++)
+    {
+        kernel.values[x] = kernelExp(-0.5F * x * x / (_sigma * _sigma));
+        sum += (x == 0) ? kernel.values[x] : 2.0F * kernel.values[x];
+    }
+    for (uint8_t x = {0}; x <= radius; x++)
+    {
+        kernel.values[x] /= sum;
+    }
+    return kernel;
+}
+
+class GaussianKernelCache
+{
+private:
+    GaussianKernelHalf cached_kernels[MAX_CACHED_KERNELS];
+    uint8_t last_use[MAX_CACHED_KERNELS];  //Use counter of the last access of every cached kernel, for replacing the oldest one
+    uint8_t use_counter = {0};
+
+    //Hide constructor in order to enforce a single instance of the class
+    GaussianKernelCache();
+    static void expandKernel(const GaussianKernelHalf &_half, float (&_kernel)[MAX_KERNEL_SIZE]);
+    //Index of the preset in flash with this configuration, -1 if there is none
+    static int8_t findPreset(float sigma, uint8_t _kernel_width);
+public:
+    //Singleton instance
+    static GaussianKernelCache& instance(void){
+        static GaussianKernelCache instance;
+        return instance;
+    }
+
+    //Get the normalized kernel of size _kernel_width (increased by 1 if even) for sigma. Returns false if the kernel is too big
+    bool getKernel(float sigma, uint8_t _kernel_width, float (&_kernel)[MAX_KERNEL_SIZE], uint8_t &_width_out);
+};
+
+extern GaussianKernelCache &GaussianKernels;
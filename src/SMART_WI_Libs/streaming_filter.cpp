@@ -0,0 +1,156 @@
+#include "streaming_filter.h"
+
+/*Source file which contains the streaming filters
+Created 10.2026*/
+
+EMAFilter::EMAFilter(float _alpha)
+{
+    alpha = constrain(_alpha, 0.001F, 1.0F);
+}
+
+bool EMAFilter::filterSample(float _sample, float &_filtered)
+{
+    if (isnan(_sample))
+    {
+        return false;
+    }
+    if (!is_initialized)
+    {
+        //Start with the first sample, so there is no settling time from 0
+        value = _sample;
+        is_initialized = true;
+    }
+    else
+    {
+        value += alpha * (_sample - value);
+    }
+    _filtered = value;
+    return true;
+}
+
+void EMAFilter::reset()
+{
+    is_initialized = false;
+}
+
+MedianFilter::MedianFilter(uint8_t _window)
+{
+    window = constrain(_window | 1, 1, MAX_MEDIAN_WINDOW);
+    for (uint8_t i = 0; i < MAX_MEDIAN_WINDOW; i++)
+    {
+        history[i] = 0.0F;
+        sorted[i] = 0.0F;
+    }
+}
+
+bool MedianFilter::filterSample(float _sample, float &_filtered)
+{
+    if (isnan(_sample))
+    {
+        return false;
+    }
+    uint8_t pos = {0};
+    if (count == window)
+    {
+        //Remove the oldest sample from the sorted window
+        float oldest = history[head];
+        while (pos < count - 1 && sorted[pos] != oldest)
+        {
+            pos++;
+        }
+        for (; pos < count - 1; pos++)
+        {
+            sorted[pos] = sorted[pos + 1];
+        }
+        count--;
+    }
+    history[head] = _sample;
+    head = (head + 1) % window;
+
+    //Insert the new sample at its sorted position
+    pos = count;
+    while (pos > 0 && sorted[pos - 1] > _sample)
+    {
+        sorted[pos] = sorted[pos - 1];
+        pos--;
+    }
+    sorted[pos] = _sample;
+    count++;
+
+    //Until the window is full, the median of the samples so far is used
+    _filtered = sorted[(count - 1) / 2];
+    return true;
+}
+
+void MedianFilter::reset()
+{
+    count = {0};
+    head = {0};
+}
+
+KalmanFilter1D::KalmanFilter1D(float _processNoise, float _measurementNoise)
+{
+    processNoise = _processNoise;
+    measurementNoise = (_measurementNoise > 0.0F) ? _measurementNoise : 1.0F;
+}
+
+bool KalmanFilter1D::filterSample(float _sample, float &_filtered)
+{
+    if (isnan(_sample))
+    {
+        return false;
+    }
+    if (!is_initialized)
+    {
+        estimate = _sample;
+        errorVariance = measurementNoise;
+        is_initialized = true;
+    }
+    else
+    {
+        //Predict: the value may have changed by the process noise
+        errorVariance += processNoise;
+        //Update with the new measurement
+        float gain = errorVariance / (errorVariance + measurementNoise);
+        estimate += gain * (_sample - estimate);
+        errorVariance *= (1.0F - gain);
+    }
+    _filtered = estimate;
+    return true;
+}
+
+void KalmanFilter1D::reset()
+{
+    is_initialized = false;
+}
+
+SpikeRejectionFilter::SpikeRejectionFilter(float _maxJump, uint8_t _maxRejects)
+{
+    maxJump = fabs(_maxJump);
+    maxRejects = _maxRejects;
+}
+
+bool SpikeRejectionFilter::filterSample(float _sample, float &_filtered)
+{
+    if (isnan(_sample))
+    {
+        return false;
+    }
+    if (is_initialized && fabs(_sample - lastValue) > maxJump && rejects < maxRejects)
+    {
+        rejects++;
+        _filtered = lastValue;
+        return true;
+    }
+    rejects = {0};
+    lastValue = _sample;
+    is_initialized = true;
+    _filtered = _sample;
+    return true;
+}
+
+void SpikeRejectionFilter::reset()
+{
+    is_initialized = false;
+    rejects = {0};
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+/*Header for streaming filters, which smooth one sample after the other with O(1) effort per sample
+(respectively O(window) for a small window). They share the interface StreamingFilter,
+so every filter incl. GaussianStreamFilter can stand in for another one.
+Invalid samples (NaN) are ignored and do not change the state of a filter.
+Created 10.2026*/
+
+#include "Arduino.h"
+
+/*Define constants*/
+const uint8_t MAX_MEDIAN_WINDOW = {9};
+
+class StreamingFilter
+{
+public:
+    virtual ~StreamingFilter(){};
+    //Add a new sample. Returns true if a filtered output is available
+    virtual bool filterSample(float _sample, float &_filtered) = 0;
+    //Forget every sample, the next sample starts a new stream
+    virtual void reset() = 0;
+};
+
+//Exponential moving average: output = alpha * sample + (1 - alpha) * last output
+class EMAFilter : public StreamingFilter
+{
+private:
+    float alpha;
+    float value = 0.0F;
+    bool is_initialized = false;
+public:
+    //alpha in (0, 1], the higher the faster the filter follows the samples
+    EMAFilter(float _alpha = 0.2F);
+    bool filterSample(float _sample, float &_filtered) override;
+    void reset() override;
+};
+
+//Running median of the last samples. The window is kept sorted, so a new sample costs O(window) shifts
+class MedianFilter : public StreamingFilter
+{
+private:
+    float history[MAX_MEDIAN_WINDOW];   //Samples in the order they have been added
+    float sorted[MAX_MEDIAN_WINDOW];    //The same samples sorted ascending
+    uint8_t window;
+    uint8_t count = {0};
+    uint8_t head = {0};                 //Position of the oldest sample in history
+public:
+    //Odd window size up to MAX_MEDIAN_WINDOW
+    MedianFilter(uint8_t _window = 5);
+    bool filterSample(float _sample, float &_filtered) override;
+    void reset() override;
+};
+
+//1-D Kalman filter for a constant value with random walk
+class KalmanFilter1D : public StreamingFilter
+{
+private:
+    float processNoise;         //Variance of the change of the value between two samples
+    float measurementNoise;     //Variance of the sensor noise
+    float estimate = 0.0F;
+    float errorVariance = 0.0F;
+    bool is_initialized = false;
+public:
+    KalmanFilter1D(float _processNoise = 0.01F, float _measurementNoise = 1.0F);
+    bool filterSample(float _sample, float &_filtered) override;
+    void reset() override;
+};
+
+//Spike rejection: a sample jumping more than maxJump from the last accepted one is replaced by the last accepted one.
+//After maxRejects rejected samples in a row the jump is taken over, as it is a real step of the value
+class SpikeRejectionFilter : public StreamingFilter
+{
+private:
+    float maxJump;
+    uint8_t maxRejects;
+    uint8_t rejects = {0};
+    float lastValue = 0.0F;
+    bool is_initialized = false;
+public:
+    SpikeRejectionFilter(float _maxJump, uint8_t _maxRejects = 2);
+    bool filterSample(float _sample, float &_filtered) override;
+    void reset() override;
+};
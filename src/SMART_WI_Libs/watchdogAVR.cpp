@@ -6,6 +6,7 @@
 
 WatchdogAVRClass::WatchdogAVRClass(){
     _maxTimePeriod = 0;
+    _kickCondition = nullptr;
 }
 
 WatchdogAVRClass Watchdog = WatchdogAVRClass::instance();
@@ -59,6 +60,11 @@ void WatchdogAVRClass::enable(int maxTimePeriod){
 }
 
 void WatchdogAVRClass::reset(){
+    //Resets in blocking code must not keep a task alive, which overran its deadline
+    if (_kickCondition != nullptr && !_kickCondition())
+    {
+        return;
+    }
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE){
         wdt_reset();
     }
@@ -70,4 +76,8 @@ void WatchdogAVRClass::disable(){
     wdt_disable();
 }
 
+void WatchdogAVRClass::setKickCondition(bool (*condition)(void)){
+    _kickCondition = condition;
+}
+
 #endif
\ No newline at end of file
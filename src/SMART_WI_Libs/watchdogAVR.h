@@ -9,6 +9,7 @@ class WatchdogAVRClass
 {
 private:
     int _maxTimePeriod;
+    bool (*_kickCondition)(void);
     WatchdogAVRClass();
     // ~WatchdogAVRClass();
 public:
@@ -20,6 +21,8 @@ public:
     void enable(int maxTimePeriod);
     void reset();
     void disable();
+    //reset() only kicks the watchdog if the condition returns true, nullptr kicks unconditionally
+    void setKickCondition(bool (*condition)(void));
 };
 
 extern WatchdogAVRClass Watchdog;
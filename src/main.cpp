@@ -19,6 +19,7 @@
 #include "SMART_WI_Libs/LoraWAN/ChirpStackReceiver/ChirpStackReceiver.h"
 #include "SMART_WI_Libs/KitConfig.h"
 #include "SMART_WI_Libs/SerialMon.h"
+#include "SMART_WI_Libs/streaming_filter.h"
 
 // ========================================
 // Globale Objekte
@@ -31,6 +32,12 @@ unsigned long lastDataCheck = 0;
 unsigned long lastDisplayTime = 0;
 const unsigned long DISPLAY_INTERVAL = 5000;  // Zeige Daten alle 5 Sekunden
 
+// Optionale Glättung der Alarmwerte je Kanal, nullptr = Alarm auf dem Rohwert.
+// Ein Filter ändert die Alarmsemantik (Ausreißer werden verworfen, Schwellen verzögert erreicht),
+// z.B. tempAlertFilter = &tempSpikeFilter; mit SpikeRejectionFilter tempSpikeFilter(10.0F);
+StreamingFilter* tempAlertFilter = nullptr;
+StreamingFilter* pressureAlertFilter = nullptr;
+
 // ========================================
 // Hilfsfunktionen
 // ========================================
@@ -104,16 +111,31 @@ void displaySensorData(const SensorData& data) {
     SerialMon.println(F("==================\n"));
 }
 
+/**
+ * @brief Wert für die Alarmprüfung, optional durch den Filter des Kanals geglättet
+ * 
+ * @return false wenn der Wert ungültig ist oder der Filter noch keinen Wert liefert
+ */
+bool getAlertValue(StreamingFilter* filter, float &value) {
+    if (isnan(value)) {
+        return false;
+    }
+    if (filter == nullptr) {
+        return true;
+    }
+    return filter->filterSample(value, value);
+}
+
 void checkForAlerts(const SensorData& data) {
     // Beispiel: Temperatur-Alarm
     float temp = data.getTemperature(0);
-    if (!isnan(temp) && temp > 30.0) {
+    if (getAlertValue(tempAlertFilter, temp) && temp > 30.0) {
         SerialMon.println(F("⚠️ WARNUNG: Temperatur über 30°C!"));
     }
     
     // Beispiel: Druck-Alarm
     float pressure = data.getPressure(0);
-    if (!isnan(pressure) && pressure < 950.0) {
+    if (getAlertValue(pressureAlertFilter, pressure) && pressure < 950.0) {
         SerialMon.println(F("⚠️ WARNUNG: Niedriger Druck!"));
     }
 }